@@ -0,0 +1,166 @@
+﻿#include "AccountNameResolver.h"
+#include <QMutexLocker>
+#include <vector>
+
+#ifdef Q_OS_WIN
+#include <sddl.h>
+#else
+#include <pwd.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+AccountNameResolver& AccountNameResolver::instance()
+{
+    static AccountNameResolver resolver;
+    return resolver;
+}
+
+AccountNameResolver::AccountNameResolver()
+{
+    _pool.setMaxThreadCount(MAX_LOOKUP_THREADS);
+}
+
+AccountNameResolver::~AccountNameResolver()
+{
+    _pool.clear();
+    _pool.waitForDone();
+}
+
+QString AccountNameResolver::accountName(const QByteArray& accountId)
+{
+    QMutexLocker locker(&_mutex);
+    auto it = _entries.find(accountId);
+    if (it != _entries.end())
+    {
+        if (it->state == lsFailed && it->failedAge.hasExpired(FAILED_RETRY_INTERVAL_MS))
+        {
+            it->state = lsPending;
+            startLookup(accountId);
+        }
+        return it->name;
+    }
+
+    Entry entry;
+    entry.name = fallbackName(accountId);
+    _entries.insert(accountId, entry);
+    startLookup(accountId);
+    return entry.name;
+}
+
+void AccountNameResolver::startLookup(const QByteArray& accountId)
+{
+    _pool.start([this, accountId]()
+        {
+        QString name;
+        bool found = lookup(accountId, name);
+
+        QMutexLocker locker(&_mutex);
+        Entry& entry = _entries[accountId];
+        if (found)
+        {
+            entry.name = name;
+            entry.state = lsResolved;
+        }
+        else
+        {
+            // Запасное имя остаётся, повтор - не раньше чем через FAILED_RETRY_INTERVAL_MS
+            entry.state = lsFailed;
+            entry.failedAge.start();
+        }
+    });
+}
+
+#ifdef Q_OS_WIN
+
+QByteArray AccountNameResolver::accountId(PSID sid)
+{
+    if (!sid || !IsValidSid(sid))
+    {
+        return QByteArray();
+    }
+    return QByteArray(static_cast<const char*>(sid), static_cast<qsizetype>(GetLengthSid(sid)));
+}
+
+bool AccountNameResolver::lookup(const QByteArray& accountId, QString& name)
+{
+    PSID sid = const_cast<char*>(accountId.constData());
+    wchar_t nameBuffer[256];
+    wchar_t domainBuffer[256];
+    DWORD nameLength = 256;
+    DWORD domainLength = 256;
+    SID_NAME_USE sidUse;
+    if (LookupAccountSidW(nullptr, sid, nameBuffer, &nameLength, domainBuffer, &domainLength, &sidUse))
+    {
+        name = QString::fromWCharArray(nameBuffer, nameLength);
+        return true;
+    }
+    if (GetLastError() != ERROR_INSUFFICIENT_BUFFER)
+    {
+        return false;
+    }
+
+    // Длины уже содержат нужный размер вместе с завершающим нулём
+    std::vector<wchar_t> longName(nameLength);
+    std::vector<wchar_t> longDomain(domainLength);
+    if (LookupAccountSidW(nullptr, sid, longName.data(), &nameLength, longDomain.data(), &domainLength, &sidUse))
+    {
+        name = QString::fromWCharArray(longName.data(), nameLength);
+        return true;
+    }
+    return false;
+}
+
+QString AccountNameResolver::fallbackName(const QByteArray& accountId)
+{
+    QString name;
+    LPWSTR sidString = nullptr;
+    if (ConvertSidToStringSidW(const_cast<char*>(accountId.constData()), &sidString))
+    {
+        name = QString::fromWCharArray(sidString);
+        LocalFree(sidString);
+    }
+    return name;
+}
+
+#else
+
+QByteArray AccountNameResolver::accountId(quint32 uid)
+{
+    return QByteArray(reinterpret_cast<const char*>(&uid), sizeof(uid));
+}
+
+static quint32 uidFromAccountId(const QByteArray& accountId)
+{
+    quint32 uid = 0;
+    memcpy(&uid, accountId.constData(), qMin<size_t>(sizeof(uid), static_cast<size_t>(accountId.size())));
+    return uid;
+}
+
+bool AccountNameResolver::lookup(const QByteArray& accountId, QString& name)
+{
+    long bufferSize = sysconf(_SC_GETPW_R_SIZE_MAX);
+    std::vector<char> buffer(bufferSize > 0 ? static_cast<size_t>(bufferSize) : 16384);
+    passwd entry;
+    passwd* result = nullptr;
+    int error;
+    // ERANGE - запись не поместилась в буфер
+    while ((error = getpwuid_r(uidFromAccountId(accountId), &entry, buffer.data(), buffer.size(), &result)) == ERANGE)
+    {
+        buffer.resize(buffer.size() * 2);
+    }
+    if (error != 0 || !result)
+    {
+        return false;
+    }
+    name = QString::fromLocal8Bit(result->pw_name);
+    return true;
+}
+
+QString AccountNameResolver::fallbackName(const QByteArray& accountId)
+{
+    return QString::number(uidFromAccountId(accountId));
+}
+
+#endif
@@ -0,0 +1,55 @@
+﻿#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QHash>
+#include <QMutex>
+#include <QThreadPool>
+#include <QElapsedTimer>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#endif
+
+// Имена учётных записей по SID (Windows) или uid (Linux). Поиск может обращаться к контроллеру домена или NSS
+// и занимать секунды, поэтому он идёт в своём пуле потоков, по одному разу на учётную запись. Пока он не
+// завершился или если имени нет, возвращается запасное имя: строковый SID или номер uid
+class AccountNameResolver
+{
+public:
+    // Через столько неудавшийся поиск повторяется
+    static constexpr qint64 FAILED_RETRY_INTERVAL_MS = 10 * 60 * 1000;
+    static constexpr int MAX_LOOKUP_THREADS = 2;
+
+    static AccountNameResolver& instance();
+
+    // Никогда не ждёт поиска, можно вызывать из любого потока
+    QString accountName(const QByteArray& accountId);
+
+#ifdef Q_OS_WIN
+    static QByteArray accountId(PSID sid);
+#else
+    static QByteArray accountId(quint32 uid);
+#endif
+
+private:
+    AccountNameResolver();
+    ~AccountNameResolver();
+
+    enum LookupState { lsPending, lsResolved, lsFailed };
+
+    struct Entry
+    {
+        QString name;
+        LookupState state = lsPending;
+        QElapsedTimer failedAge;
+    };
+
+    void startLookup(const QByteArray& accountId);
+    static bool lookup(const QByteArray& accountId, QString& name);
+    static QString fallbackName(const QByteArray& accountId);
+
+    QMutex _mutex;
+    QHash<QByteArray, Entry> _entries;
+    QThreadPool _pool;
+};
@@ -0,0 +1,174 @@
+﻿#include "AdlGPUBackend.h"
+#include <QSet>
+
+static void* __stdcall ADL_Main_Memory_Alloc(int iSize)
+{
+    return malloc(iSize);
+}
+
+static void ADL_Main_Memory_Free(void* lpBuffer)
+{
+    free(lpBuffer);
+}
+
+AdlGPUBackend::AdlGPUBackend()
+{
+    if (!initialize() && _library)
+    {
+        FreeLibrary(_library);
+        _library = nullptr;
+    }
+}
+
+AdlGPUBackend::~AdlGPUBackend()
+{
+    if (_context)
+    {
+        ADL2_Main_Control_Destroy(_context);
+    }
+    if (_library)
+    {
+        FreeLibrary(_library);
+    }
+}
+
+bool AdlGPUBackend::initialize()
+{
+    _library = LoadLibrary(L"atiadlxx.dll");
+    if (_library == nullptr)
+    {
+        return false;
+    }
+
+    ADL2_Main_Control_Create = (ADL2_MAIN_CONTROL_CREATE)GetProcAddress(_library, "ADL2_Main_Control_Create");
+    ADL2_Main_Control_Destroy = (ADL2_MAIN_CONTROL_DESTROY)GetProcAddress(_library, "ADL2_Main_Control_Destroy");
+    ADL2_Adapter_NumberOfAdapters_Get = (ADL2_ADAPTER_NUMBEROFADAPTERS_GET)GetProcAddress(_library, "ADL2_Adapter_NumberOfAdapters_Get");
+    ADL2_Adapter_Active_Get = (ADL2_ADAPTER_ACTIVE_GET)GetProcAddress(_library, "ADL2_Adapter_Active_Get");
+    ADL2_Display_Modes_Get = (ADL2_DISPLAY_MODES_GET)GetProcAddress(_library, "ADL2_Display_Modes_Get");
+    ADL2_Adapter_AdapterInfo_Get = (ADL2_ADAPTER_ADAPTERINFO_GET)GetProcAddress(_library, "ADL2_Adapter_AdapterInfoX2_Get");
+    ADL2_New_QueryPMLogDataGet = (ADL2_NEW_QUERYPMLOGDATA_GET)GetProcAddress(_library, "ADL2_New_QueryPMLogData_Get");
+    ADL2_Adapter_MemoryInfo_Get = (ADL2_ADAPTER_MEMORYINFO_GET)GetProcAddress(_library, "ADL2_Adapter_MemoryInfo2_Get");
+    ADL2_Adapter_VRAMUsage_Get = (ADL2_ADAPTER_VRAMUSAGE_GET)GetProcAddress(_library, "ADL2_Adapter_DedicatedVRAMUsage_Get");
+
+    // Старые драйверы экспортируют не все функции
+    if (!ADL2_Main_Control_Create || !ADL2_Main_Control_Destroy || !ADL2_Adapter_NumberOfAdapters_Get || !ADL2_Adapter_Active_Get
+        || !ADL2_Display_Modes_Get || !ADL2_Adapter_AdapterInfo_Get || !ADL2_New_QueryPMLogDataGet
+        || !ADL2_Adapter_MemoryInfo_Get || !ADL2_Adapter_VRAMUsage_Get)
+    {
+        return false;
+    }
+
+    if (ADL_OK != ADL2_Main_Control_Create(ADL_Main_Memory_Alloc, 1, &_context))
+    {
+        _context = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+QList<GPUInfo> AdlGPUBackend::enumerateDevices()
+{
+    QList<GPUInfo> devices;
+    _adapters.clear();
+
+    int numberAdapters = 0;
+    if (!_context || ADL_OK != ADL2_Adapter_NumberOfAdapters_Get(_context, &numberAdapters) || numberAdapters <= 0)
+    {
+        return devices;
+    }
+
+    // Статическая информация обо всех адаптерах одним массивом (для получения имени)
+    AdapterInfo* adapterInfo = nullptr;
+    if (ADL_OK != ADL2_Adapter_AdapterInfo_Get(_context, &adapterInfo) || !adapterInfo)
+    {
+        return devices;
+    }
+
+    // Одна видеокарта видна как несколько адаптеров ADL, по одному на выход
+    QSet<int> seenBuses;
+    for (int i = 0; i < numberAdapters; i++)
+    {
+        int active = 0;
+        if (ADL_OK != ADL2_Adapter_Active_Get(_context, i, &active) || !active)
+        {
+            continue;
+        }
+
+        // Комбинация параметров вывода видеоадаптера на данный дисплей. Проверяется для того, чтобы исключить виртуальные адаптеры и не выводить информацию о них
+        int numModes = 0;
+        ADLMode* adlMode = nullptr;
+        int result = ADL2_Display_Modes_Get(_context, i, -1, &numModes, &adlMode);
+        ADL_Main_Memory_Free(adlMode);
+        if (ADL_OK != result || numModes == 0)
+        {
+            continue;
+        }
+
+        if (seenBuses.contains(adapterInfo[i].iBusNumber))
+        {
+            continue;
+        }
+        seenBuses.insert(adapterInfo[i].iBusNumber);
+
+        GPUInfo gpu;
+        gpu.vendor = "AMD";
+        gpu.name = adapterInfo[i].strAdapterName;
+
+        // Возвращает структуру, хранящую объем памяти видеоадаптера
+        ADLMemoryInfo2 memoryInfo = {};
+        if (ADL_OK == ADL2_Adapter_MemoryInfo_Get(_context, i, &memoryInfo))
+        {
+            gpu.totalMemoryBytes = memoryInfo.iMemorySize;
+        }
+
+        _adapters.push_back(i);
+        devices.append(gpu);
+    }
+
+    ADL_Main_Memory_Free(adapterInfo);
+    return devices;
+}
+
+bool AdlGPUBackend::sampleDevice(int device, GPUInfo& info)
+{
+    if (device < 0 || device >= static_cast<int>(_adapters.size()))
+    {
+        return false;
+    }
+    int adapter = _adapters[device];
+
+    // Получение информации от датчиков производительности (динамические параметры)
+    if (ADL_OK != ADL2_New_QueryPMLogDataGet(_context, adapter, &_pmLog))
+    {
+        return false;
+    }
+    if (_pmLog.sensors[ADL_PMLOG_GFX_CURRENT].supported)
+    {
+        info.usage = _pmLog.sensors[ADL_PMLOG_GFX_CURRENT].value;
+    }
+    if (_pmLog.sensors[ADL_PMLOG_TEMPERATURE_GFX].supported)
+    {
+        info.temperatureCelsius = _pmLog.sensors[ADL_PMLOG_TEMPERATURE_GFX].value;
+    }
+    if (_pmLog.sensors[ADL_PMLOG_GFX_POWER].supported)
+    {
+        info.powerUsage = _pmLog.sensors[ADL_PMLOG_GFX_POWER].value;
+    }
+
+    // Занятая видеопамять в МБ
+    int vramUsage = 0;
+    if (ADL_OK == ADL2_Adapter_VRAMUsage_Get(_context, adapter, &vramUsage))
+    {
+        info.usedMemoryBytes = static_cast<quint64>(vramUsage) * 1024 * 1024;
+    }
+
+    return true;
+}
+
+void AdlGPUBackend::sampleProcesses(int firstDevice, QMap<quint32, ProcessGPUInfo>& processes)
+{
+    // ADL не отдаёт загрузку по процессам
+    Q_UNUSED(firstDevice);
+    Q_UNUSED(processes);
+}
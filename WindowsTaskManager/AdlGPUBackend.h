@@ -0,0 +1,49 @@
+﻿#pragma once
+
+#include "IGPUBackend.h"
+#include <vector>
+#include <windows.h>
+#include <adl_sdk.h>
+
+typedef int (*ADL2_MAIN_CONTROL_CREATE)(ADL_MAIN_MALLOC_CALLBACK, int, ADL_CONTEXT_HANDLE*);
+typedef int (*ADL2_MAIN_CONTROL_DESTROY)(ADL_CONTEXT_HANDLE);
+typedef int (*ADL2_ADAPTER_NUMBEROFADAPTERS_GET)(ADL_CONTEXT_HANDLE, int*);
+typedef int (*ADL2_ADAPTER_ACTIVE_GET)(ADL_CONTEXT_HANDLE, int, int*);
+typedef int (*ADL2_DISPLAY_MODES_GET)(ADL_CONTEXT_HANDLE, int iAdapterIndex, int iDisplayIndex, int* lpNumModes, ADLMode** lppModes);
+typedef int (*ADL2_ADAPTER_ADAPTERINFO_GET)(ADL_CONTEXT_HANDLE context, AdapterInfo** lppInfo);
+typedef int (*ADL2_NEW_QUERYPMLOGDATA_GET)(ADL_CONTEXT_HANDLE context, int iAdapterIndex, ADLPMLogDataOutput* lpDataOutput);
+typedef int (*ADL2_ADAPTER_MEMORYINFO_GET)(ADL_CONTEXT_HANDLE, int, ADLMemoryInfo2*);
+typedef int (*ADL2_ADAPTER_VRAMUSAGE_GET)(ADL_CONTEXT_HANDLE, int, int*);
+
+// Видеокарты AMD через ADL (atiadlxx.dll загружается динамически). Контекст ADL создаётся один раз,
+// буфер датчиков переиспользуется между тактами, все выделенные ADL массивы освобождаются сразу
+class AdlGPUBackend : public IGPUBackend
+{
+public:
+    AdlGPUBackend();
+    ~AdlGPUBackend() override;
+
+    QList<GPUInfo> enumerateDevices() override;
+    bool sampleDevice(int device, GPUInfo& info) override;
+    void sampleProcesses(int firstDevice, QMap<quint32, ProcessGPUInfo>& processes) override;
+
+private:
+    HMODULE _library = nullptr;
+    ADL_CONTEXT_HANDLE _context = nullptr;
+
+    ADL2_MAIN_CONTROL_CREATE            ADL2_Main_Control_Create = nullptr;
+    ADL2_MAIN_CONTROL_DESTROY           ADL2_Main_Control_Destroy = nullptr;
+    ADL2_ADAPTER_NUMBEROFADAPTERS_GET   ADL2_Adapter_NumberOfAdapters_Get = nullptr;
+    ADL2_ADAPTER_ACTIVE_GET             ADL2_Adapter_Active_Get = nullptr;
+    ADL2_DISPLAY_MODES_GET              ADL2_Display_Modes_Get = nullptr;
+    ADL2_ADAPTER_ADAPTERINFO_GET        ADL2_Adapter_AdapterInfo_Get = nullptr;
+    ADL2_NEW_QUERYPMLOGDATA_GET         ADL2_New_QueryPMLogDataGet = nullptr;
+    ADL2_ADAPTER_MEMORYINFO_GET         ADL2_Adapter_MemoryInfo_Get = nullptr;
+    ADL2_ADAPTER_VRAMUSAGE_GET          ADL2_Adapter_VRAMUsage_Get = nullptr;
+
+    // Индексы адаптеров ADL по номерам устройств
+    std::vector<int> _adapters;
+    ADLPMLogDataOutput _pmLog = {};
+
+    bool initialize();
+};
@@ -0,0 +1,128 @@
+﻿#include "ChartHistory.h"
+#include <QtCharts/QLineSeries>
+#include <algorithm>
+
+ChartHistory::ChartHistory(int capacity)
+    : _values(std::max(capacity, 1), 0.0)
+{
+}
+
+void ChartHistory::append(double value)
+{
+    _values[_head] = value;
+    _head = (_head + 1) % static_cast<int>(_values.size());
+    _size = std::min(_size + 1, static_cast<int>(_values.size()));
+    _totalCount++;
+}
+
+void ChartHistory::clear()
+{
+    _head = 0;
+    _size = 0;
+}
+
+void ChartHistory::startAt(quint64 firstIndex)
+{
+    if (_size == 0)
+    {
+        _totalCount = firstIndex;
+    }
+}
+
+int ChartHistory::size() const
+{
+    return _size;
+}
+
+int ChartHistory::capacity() const
+{
+    return static_cast<int>(_values.size());
+}
+
+quint64 ChartHistory::totalCount() const
+{
+    return _totalCount;
+}
+
+double ChartHistory::at(int index) const
+{
+    int capacity = static_cast<int>(_values.size());
+    int first = (_head - _size + capacity) % capacity;
+    return _values[(first + index) % capacity];
+}
+
+QList<QPointF> ChartHistory::decimated(int windowSize, int columns) const
+{
+    QList<QPointF> points;
+    decimate(windowSize, columns, points);
+    return points;
+}
+
+void ChartHistory::decimate(int windowSize, int columns, QList<QPointF>& points) const
+{
+    // clear() сохраняет ёмкость необщего списка
+    points.clear();
+
+    int count = std::min(windowSize, _size);
+    if (count == 0)
+    {
+        return;
+    }
+
+    int offset = _size - count;
+    double firstX = static_cast<double>(_totalCount - count);
+
+    // Пока точек не больше, чем по 2 на колонку, прореживание ничего не даёт
+    if (columns <= 0 || count <= columns * 2)
+    {
+        points.reserve(count);
+        for (int i = 0; i < count; i++)
+        {
+            points.append(QPointF(firstX + i, at(offset + i)));
+        }
+        return;
+    }
+
+    // M4: для каждой колонки сохраняем первую, минимальную, максимальную и последнюю точки.
+    // Так линия на экране получается такой же, как при отрисовке всех точек
+    points.reserve(columns * 4);
+    for (int column = 0; column < columns; column++)
+    {
+        int begin = static_cast<int>(static_cast<qint64>(count) * column / columns);
+        int end = static_cast<int>(static_cast<qint64>(count) * (column + 1) / columns);
+        if (begin >= end)
+        {
+            continue;
+        }
+
+        int minIndex = begin, maxIndex = begin;
+        for (int i = begin + 1; i < end; i++)
+        {
+            double value = at(offset + i);
+            if (value < at(offset + minIndex))
+            {
+                minIndex = i;
+            }
+            if (value > at(offset + maxIndex))
+            {
+                maxIndex = i;
+            }
+        }
+
+        int indices[4] = { begin, std::min(minIndex, maxIndex), std::max(minIndex, maxIndex), end - 1 };
+        int last = -1;
+        for (int index : indices)
+        {
+            if (index != last)
+            {
+                points.append(QPointF(firstX + index, at(offset + index)));
+                last = index;
+            }
+        }
+    }
+}
+
+void ChartHistory::renderTo(QLineSeries* series, int windowSize, int columns) const
+{
+    series->replace(decimated(windowSize, columns));
+}
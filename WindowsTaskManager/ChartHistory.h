@@ -0,0 +1,39 @@
+﻿#pragma once
+
+#include <QList>
+#include <QPointF>
+#include <vector>
+
+class QLineSeries;
+
+// Кольцевой буфер значений графика. Память выделяется один раз, добавление точки - O(1)
+class ChartHistory
+{
+public:
+    explicit ChartHistory(int capacity = 3600);
+
+    void append(double value);
+    void clear();
+    // Нумерация точек пустой истории начнётся с firstIndex: так серия, появившаяся позже, идёт по той же оси X
+    void startAt(quint64 firstIndex);
+
+    int size() const;
+    int capacity() const;
+    // Абсолютный номер следующей точки, используется как координата X
+    quint64 totalCount() const;
+    double at(int index) const;
+
+    // Последние windowSize точек, прореженные по алгоритму M4 (first/min/max/last на колонку пикселей)
+    QList<QPointF> decimated(int windowSize, int columns) const;
+    // То же в буфер вызывающего: при отрисовке каждый кадр память не выделяется заново
+    void decimate(int windowSize, int columns, QList<QPointF>& points) const;
+
+    // Заменяет точки серии одним вызовом replace(), без сдвига вектора точек
+    void renderTo(QLineSeries* series, int windowSize, int columns) const;
+
+private:
+    std::vector<double> _values;
+    int _head = 0;
+    int _size = 0;
+    quint64 _totalCount = 0;
+};
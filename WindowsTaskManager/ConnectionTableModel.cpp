@@ -0,0 +1,227 @@
+﻿#include "ConnectionTableModel.h"
+#include <algorithm>
+
+const int COLUMNS_COUNT = 5;
+
+enum ConnectionTableColumns { ctcProtocol, ctcLocal, ctcRemote, ctcState, ctcPID };
+
+// IPv6 в сокращённой записи (RFC 5952): самая длинная серия нулевых групп заменяется на "::"
+static QString formatAddress(const std::array<quint8, 16>& address, bool isIPv6)
+{
+    bool isMappedIPv4 = isIPv6 && std::all_of(address.begin(), address.begin() + 10, [](quint8 b) { return b == 0; })
+        && address[10] == 0xFF && address[11] == 0xFF;
+    if (!isIPv6 || isMappedIPv4)
+    {
+        int offset = isMappedIPv4 ? 12 : 0;
+        return QString("%1.%2.%3.%4").arg(address[offset]).arg(address[offset + 1]).arg(address[offset + 2]).arg(address[offset + 3]);
+    }
+
+    quint16 groups[8];
+    for (int i = 0; i < 8; i++)
+    {
+        groups[i] = static_cast<quint16>((address[i * 2] << 8) | address[i * 2 + 1]);
+    }
+
+    int bestStart = -1, bestLength = 0;
+    for (int i = 0; i < 8;)
+    {
+        int length = 0;
+        while (i + length < 8 && groups[i + length] == 0)
+        {
+            length++;
+        }
+        if (length > bestLength && length > 1)
+        {
+            bestStart = i;
+            bestLength = length;
+        }
+        i += length > 0 ? length : 1;
+    }
+
+    QString text;
+    for (int i = 0; i < 8; i++)
+    {
+        if (i == bestStart)
+        {
+            text += "::";
+            i += bestLength - 1;
+            continue;
+        }
+        if (!text.isEmpty() && !text.endsWith(':'))
+        {
+            text += ':';
+        }
+        text += QString::number(groups[i], 16);
+    }
+    return text;
+}
+
+static QString formatEndpoint(const std::array<quint8, 16>& address, quint16 port, bool isIPv6)
+{
+    QString host = formatAddress(address, isIPv6);
+    return host.contains(':') ? QString("[%1]:%2").arg(host).arg(port) : QString("%1:%2").arg(host).arg(port);
+}
+
+ConnectionTableModel::ConnectionTableModel(QObject* parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+int ConnectionTableModel::rowCount(const QModelIndex& parent) const
+{
+    return _connections.size();
+}
+
+int ConnectionTableModel::columnCount(const QModelIndex& parent) const
+{
+    return COLUMNS_COUNT; // Протокол, Локальный адрес, Удалённый адрес, Состояние, PID
+}
+
+QVariant ConnectionTableModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= _connections.size())
+    {
+        return QVariant();
+    }
+
+    const auto& connection = _connections[index.row()];
+
+    if (role == Qt::DisplayRole)
+    {
+        switch (index.column())
+        {
+        case ctcProtocol: return QString(ConnectionProtocolString[connection.protocol]) + (connection.isIPv6 ? "v6" : "");
+        case ctcLocal: return formatEndpoint(connection.localAddress, connection.localPort, connection.isIPv6);
+        case ctcRemote: return connection.protocol == cpUdp ? QString() : formatEndpoint(connection.remoteAddress, connection.remotePort, connection.isIPv6);
+        case ctcState: return ConnectionStateString[connection.state];
+        case ctcPID: return connection.pid;
+        default: return QVariant();
+        }
+    }
+    // Для сортировки: адреса - по байтам и порту, состояния - в порядке жизненного цикла
+    if (role == Qt::UserRole)
+    {
+        switch (index.column())
+        {
+        case ctcProtocol: return connection.protocol * 2 + (connection.isIPv6 ? 1 : 0);
+        case ctcLocal: return QByteArray(reinterpret_cast<const char*>(connection.localAddress.data()), 16) + QByteArray::number(connection.localPort).rightJustified(5, '0');
+        case ctcRemote: return QByteArray(reinterpret_cast<const char*>(connection.remoteAddress.data()), 16) + QByteArray::number(connection.remotePort).rightJustified(5, '0');
+        case ctcState: return static_cast<int>(connection.state);
+        case ctcPID: return connection.pid;
+        default: return QVariant();
+        }
+    }
+
+    return QVariant();
+}
+
+QVariant ConnectionTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role == Qt::DisplayRole && orientation == Qt::Horizontal)
+    {
+        switch (section)
+        {
+        case ctcProtocol: return "Protocol";
+        case ctcLocal: return "Local address";
+        case ctcRemote: return "Remote address";
+        case ctcState: return "State";
+        case ctcPID: return "PID";
+        default: return QVariant();
+        }
+    }
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+int ConnectionTableModel::stateCount(ConnectionState state) const
+{
+    return _stateCounts[state];
+}
+
+void ConnectionTableModel::reindexFrom(int row)
+{
+    for (int i = row; i < _connections.size(); i++)
+    {
+        _rows[_connections[i].key] = i;
+    }
+}
+
+void ConnectionTableModel::applyChanges(const ConnectionChanges& changes)
+{
+    // Закрытые: строки удаляются диапазонами подряд идущих индексов от конца к началу
+    if (!changes.closed.isEmpty())
+    {
+        QList<int> removedRows;
+        removedRows.reserve(changes.closed.size());
+        for (quint64 key : changes.closed)
+        {
+            auto it = _rows.find(key);
+            if (it == _rows.end())
+            {
+                continue;
+            }
+            removedRows.append(it.value());
+            _stateCounts[_connections[it.value()].state]--;
+            _rows.erase(it);
+        }
+        std::sort(removedRows.begin(), removedRows.end(), std::greater<int>());
+
+        for (int i = 0; i < removedRows.size();)
+        {
+            int last = removedRows[i];
+            int first = last;
+            while (i + 1 < removedRows.size() && removedRows[i + 1] == first - 1)
+            {
+                first--;
+                i++;
+            }
+            i++;
+
+            beginRemoveRows(QModelIndex(), first, last);
+            _connections.remove(first, last - first + 1);
+            endRemoveRows();
+        }
+
+        // Номера строк сдвинулись только после самой первой удалённой
+        if (!removedRows.isEmpty())
+        {
+            reindexFrom(removedRows.last());
+        }
+    }
+
+    for (const auto& connection : changes.changed)
+    {
+        int row = _rows.value(connection.key, -1);
+        if (row < 0)
+        {
+            continue;
+        }
+        _stateCounts[_connections[row].state]--;
+        _stateCounts[connection.state]++;
+        _connections[row] = connection;
+        emit dataChanged(index(row, 0), index(row, COLUMNS_COUNT - 1));
+    }
+
+    QList<ConnectionInfo> opened;
+    opened.reserve(changes.opened.size());
+    for (const auto& connection : changes.opened)
+    {
+        if (_rows.contains(connection.key))
+        {
+            continue;
+        }
+        opened.append(connection);
+    }
+
+    if (!opened.isEmpty())
+    {
+        int firstRow = _connections.size();
+        beginInsertRows(QModelIndex(), firstRow, firstRow + opened.size() - 1);
+        for (const auto& connection : opened)
+        {
+            _rows.insert(connection.key, _connections.size());
+            _connections.append(connection);
+            _stateCounts[connection.state]++;
+        }
+        endInsertRows();
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QList>
+#include <array>
+#include "DataStructs.h"
+
+// Таблица соединений, обновляемая разницей между тактами (ConnectionChanges) без сброса модели
+class ConnectionTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit ConnectionTableModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    void applyChanges(const ConnectionChanges& changes);
+
+    // Число TCP-соединений в состоянии; для csNone - число UDP-сокетов
+    int stateCount(ConnectionState state) const;
+
+private:
+    QList<ConnectionInfo> _connections;
+    QHash<quint64, int> _rows;
+    std::array<int, CONNECTION_STATES_COUNT> _stateCounts{};
+
+    void reindexFrom(int row);
+};
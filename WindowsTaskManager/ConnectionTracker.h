@@ -0,0 +1,103 @@
+﻿#pragma once
+
+#include <QHash>
+#include <QByteArrayView>
+#include "DataStructs.h"
+
+// Сравнение таблиц соединений между тактами. Соединение определяется хэшем протокола, адресов и портов;
+// за такт накапливаются только открытые, закрытые и сменившие состояние или владельца соединения,
+// поэтому на хосте с сотнями тысяч соединений в представление уходит лишь разница
+class ConnectionTracker
+{
+public:
+    static quint64 connectionKey(const ConnectionInfo& connection)
+    {
+        return qHashMulti(0, connection.protocol, connection.isIPv6,
+            QByteArrayView(connection.localAddress.data(), connection.localAddress.size()), connection.localPort,
+            QByteArrayView(connection.remoteAddress.data(), connection.remoteAddress.size()), connection.remotePort);
+    }
+
+    void beginSample()
+    {
+        _generation++;
+        _skippedFamilies = 0;
+        _changes = ConnectionChanges();
+    }
+
+    // Таблица протокола и семейства адресов не прочитана в этом такте: её соединения в endSample() не закрываются,
+    // иначе одна неудачная выборка давала бы закрытие и повторное открытие всех сокетов
+    void skipFamily(ConnectionProtocol protocol, bool isIPv6)
+    {
+        _skippedFamilies |= familyBit(protocol, isIPv6);
+    }
+
+    // Заполняет connection.key и сравнивает соединение с прошлым тактом
+    void update(ConnectionInfo& connection)
+    {
+        connection.key = connectionKey(connection);
+
+        auto it = _connections.find(connection.key);
+        if (it == _connections.end())
+        {
+            _connections.insert(connection.key, Entry{ connection.state, connection.pid, _generation, familyBit(connection.protocol, connection.isIPv6) });
+            _changes.opened.append(connection);
+            return;
+        }
+
+        // Одна и та же пара адресов может встретиться в таблице дважды (например, сокет в TIME_WAIT и новый)
+        if (it->generation == _generation)
+        {
+            return;
+        }
+        it->generation = _generation;
+
+        if (it->state != connection.state || it->pid != connection.pid)
+        {
+            it->state = connection.state;
+            it->pid = connection.pid;
+            _changes.changed.append(connection);
+        }
+    }
+
+    // Соединения, не встретившиеся в такте, считаются закрытыми, кроме соединений непрочитанных таблиц
+    ConnectionChanges endSample()
+    {
+        for (auto it = _connections.begin(); it != _connections.end();)
+        {
+            if (it->generation != _generation && (_skippedFamilies & it->family) == 0)
+            {
+                _changes.closed.append(it.key());
+                it = _connections.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        return std::move(_changes);
+    }
+
+    int size() const
+    {
+        return static_cast<int>(_connections.size());
+    }
+
+private:
+    struct Entry
+    {
+        ConnectionState state = csNone;
+        quint32 pid = 0;
+        quint64 generation = 0;
+        quint8 family = 0;
+    };
+
+    static quint8 familyBit(ConnectionProtocol protocol, bool isIPv6)
+    {
+        return static_cast<quint8>(1 << (protocol * 2 + (isIPv6 ? 1 : 0)));
+    }
+
+    QHash<quint64, Entry> _connections;
+    quint64 _generation = 0;
+    quint8 _skippedFamilies = 0;
+    ConnectionChanges _changes;
+};
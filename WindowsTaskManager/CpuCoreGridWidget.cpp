@@ -0,0 +1,172 @@
+﻿#include "CpuCoreGridWidget.h"
+#include "SelfProfiler.h"
+#include <QPainter>
+#include <QResizeEvent>
+#include <cmath>
+#include <algorithm>
+
+const int CELL_SPACING = 4;
+const int CELL_LABEL_HEIGHT = 14;
+const int MIN_CELL_HEIGHT_FOR_LABELS = 40;
+
+CpuCoreGridWidget::CpuCoreGridWidget(QWidget* parent)
+    : QWidget(parent), _refreshTimer(this)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setMinimumHeight(120);
+
+    _refreshTimer.setInterval(REFRESH_INTERVAL_MS);
+    connect(&_refreshTimer, &QTimer::timeout, this, QOverload<>::of(&QWidget::update));
+
+    _linePen = QPen(QColor(17, 125, 187), 1.0);
+    _textPen = QPen(QColor(80, 80, 80));
+}
+
+void CpuCoreGridWidget::setHistories(const std::vector<ChartHistory>* histories)
+{
+    _histories = histories;
+    _layoutCoreCount = -1;
+    update();
+}
+
+void CpuCoreGridWidget::setSampleWindow(int samples)
+{
+    _sampleWindow = std::max(samples, 2);
+    update();
+}
+
+void CpuCoreGridWidget::refresh()
+{
+    if (isVisible())
+    {
+        update();
+    }
+}
+
+void CpuCoreGridWidget::resizeEvent(QResizeEvent* event)
+{
+    QWidget::resizeEvent(event);
+    _layoutCoreCount = -1;
+}
+
+void CpuCoreGridWidget::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+    _refreshTimer.start();
+}
+
+void CpuCoreGridWidget::hideEvent(QHideEvent* event)
+{
+    QWidget::hideEvent(event);
+    _refreshTimer.stop();
+}
+
+void CpuCoreGridWidget::rebuildLayout()
+{
+    int coreCount = _histories ? static_cast<int>(_histories->size()) : 0;
+    _layoutCoreCount = coreCount;
+    _layoutSize = size();
+    _plotRects.clear();
+
+    qreal dpr = devicePixelRatioF();
+    _background = QPixmap(size() * dpr);
+    _background.setDevicePixelRatio(dpr);
+    _background.fill(Qt::white);
+
+    if (coreCount == 0 || width() <= 0 || height() <= 0)
+    {
+        return;
+    }
+
+    // Подбираем число колонок так, чтобы ячейки были примерно вдвое шире своей высоты
+    double aspect = static_cast<double>(width()) / height();
+    int columns = std::clamp(static_cast<int>(std::lround(std::sqrt(coreCount * aspect / 2.0))), 1, coreCount);
+    int rows = (coreCount + columns - 1) / columns;
+
+    qreal cellWidth = static_cast<qreal>(width() - CELL_SPACING * (columns + 1)) / columns;
+    qreal cellHeight = static_cast<qreal>(height() - CELL_SPACING * (rows + 1)) / rows;
+    _showValues = cellHeight >= MIN_CELL_HEIGHT_FOR_LABELS;
+
+    QPainter painter(&_background);
+    QPen framePen(QColor(17, 125, 187, 120));
+    QPen gridPen(QColor(220, 230, 240));
+    QFont labelFont = font();
+    labelFont.setPixelSize(10);
+    painter.setFont(labelFont);
+
+    for (int i = 0; i < coreCount; i++)
+    {
+        int row = i / columns;
+        int column = i % columns;
+        QRectF cell(CELL_SPACING + column * (cellWidth + CELL_SPACING),
+            CELL_SPACING + row * (cellHeight + CELL_SPACING),
+            cellWidth, cellHeight);
+
+        QRectF plot = cell;
+        if (_showValues)
+        {
+            painter.setPen(_textPen);
+            painter.drawText(QRectF(cell.left() + 2, cell.top(), cell.width() - 4, CELL_LABEL_HEIGHT),
+                Qt::AlignLeft | Qt::AlignVCenter, QString("Ядро %1").arg(i + 1));
+            plot.setTop(cell.top() + CELL_LABEL_HEIGHT);
+        }
+
+        painter.fillRect(plot, QColor(241, 246, 250));
+        painter.setPen(gridPen);
+        painter.drawLine(QPointF(plot.left(), plot.center().y()), QPointF(plot.right(), plot.center().y()));
+        painter.setPen(framePen);
+        painter.drawRect(plot);
+
+        _plotRects.append(plot);
+    }
+}
+
+void CpuCoreGridWidget::paintEvent(QPaintEvent* event)
+{
+    Q_UNUSED(event);
+    SELF_PROFILE_SCOPE("paint.cpuCoreGrid");
+
+    int coreCount = _histories ? static_cast<int>(_histories->size()) : 0;
+    if (coreCount != _layoutCoreCount || size() != _layoutSize)
+    {
+        rebuildLayout();
+    }
+
+    QPainter painter(this);
+    painter.drawPixmap(0, 0, _background);
+    QFont labelFont = font();
+    labelFont.setPixelSize(10);
+    painter.setFont(labelFont);
+
+    for (int i = 0; i < _plotRects.size(); i++)
+    {
+        const ChartHistory& history = (*_histories)[i];
+        const QRectF& plot = _plotRects[i];
+
+        // Окно совпадает с окном больших графиков, длинное прореживается до нескольких точек на пиксель ширины ячейки
+        history.decimate(_sampleWindow, static_cast<int>(plot.width()), _points);
+        if (_points.size() < 2)
+        {
+            continue;
+        }
+
+        qreal lastX = static_cast<qreal>(history.totalCount() - 1);
+        qreal stepX = plot.width() / (_sampleWindow - 1);
+        _polyline.resize(_points.size());
+        for (int j = 0; j < _points.size(); j++)
+        {
+            double value = std::clamp(_points[j].y(), 0.0, 100.0);
+            _polyline[j] = QPointF(plot.right() - stepX * (lastX - _points[j].x()), plot.bottom() - plot.height() * value / 100.0);
+        }
+
+        painter.setPen(_linePen);
+        painter.drawPolyline(_polyline);
+
+        if (_showValues)
+        {
+            painter.setPen(_textPen);
+            painter.drawText(QRectF(plot.left(), plot.top() - CELL_LABEL_HEIGHT, plot.width() - 2, CELL_LABEL_HEIGHT),
+                Qt::AlignRight | Qt::AlignVCenter, QString::number(history.at(history.size() - 1), 'f', 0) + "%");
+        }
+    }
+}
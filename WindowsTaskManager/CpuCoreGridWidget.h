@@ -0,0 +1,52 @@
+﻿#pragma once
+
+#include <QWidget>
+#include <QPixmap>
+#include <QPolygonF>
+#include <QPen>
+#include <QTimer>
+#include <vector>
+#include "ChartHistory.h"
+
+// Сетка мини-графиков загрузки логических процессоров.
+// История хранится снаружи, виджет только рисует её за один проход QPainter поверх закэшированного фона
+class CpuCoreGridWidget : public QWidget
+{
+public:
+    explicit CpuCoreGridWidget(QWidget* parent = nullptr);
+
+    // Виджет не владеет историей, вектор должен жить дольше виджета
+    void setHistories(const std::vector<ChartHistory>* histories);
+    void setSampleWindow(int samples);
+    // Вызывается после добавления новых точек в историю
+    void refresh();
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
+private:
+    void rebuildLayout();
+
+    const std::vector<ChartHistory>* _histories = nullptr;
+    int _sampleWindow = 60;
+
+    // Кэш раскладки и фона, перестраивается только при изменении размера или числа ядер
+    int _layoutCoreCount = -1;
+    QSize _layoutSize;
+    QList<QRectF> _plotRects;
+    QPixmap _background;
+    bool _showValues = false;
+
+    // Перерисовка 4 раза в секунду, пока сетка видна; скрытая сетка таймер не держит
+    static constexpr int REFRESH_INTERVAL_MS = 250;
+    QTimer _refreshTimer;
+
+    // Буферы точек переиспользуются между ядрами и кадрами
+    QList<QPointF> _points;
+    QPolygonF _polyline;
+    QPen _linePen;
+    QPen _textPen;
+};
@@ -3,6 +3,8 @@
 #include<qstring.h>
 #include<qlist.h>
 #include <QDateTime>
+#include <QStringList>
+#include <array>
 
 struct SystemInfo 
 {
@@ -23,6 +25,36 @@ struct SystemInfo
 	QList<double> cpuCoreUsage;
 };
 
+// Использование одной видеокарты процессом: средние по новым выборкам драйвера за такт, в процентах
+struct ProcessGPUDeviceUsage
+{
+	int device = 0; // номер видеокарты в порядке IGPUMonitor::getGPUInfo()
+	double smUtilization = 0.0;
+	double memoryUtilization = 0.0;
+	double encoderUtilization = 0.0;
+	double decoderUtilization = 0.0;
+	quint64 memoryBytes = 0;
+};
+
+// Дополнительные сведения о процессе, которые собираются только по запросу (маска в ProcessInfo::detailFields)
+enum ProcessDetailField : quint32
+{
+	pdfPath = 1 << 0,
+	pdfCommandLine = 1 << 1,
+	pdfUserName = 1 << 2,
+	pdfThreadCount = 1 << 3,
+	pdfHandleCount = 1 << 4,
+	pdfPriority = 1 << 5
+};
+
+inline constexpr quint32 PROCESS_DETAIL_ALL_FIELDS = pdfPath | pdfCommandLine | pdfUserName | pdfThreadCount | pdfHandleCount | pdfPriority;
+// Не меняются за время жизни процесса, поэтому кэшируются по PID и времени запуска
+inline constexpr quint32 PROCESS_DETAIL_STATIC_FIELDS = pdfPath | pdfCommandLine | pdfUserName;
+
+// Классы приоритета по возрастанию, чтобы по значению можно было сортировать
+enum ProcessPriority { ppIdle, ppBelowNormal, ppNormal, ppAboveNormal, ppHigh, ppRealtime, ppUnknown };
+inline const char* ProcessPriorityString[] { "Низкий", "Ниже среднего", "Обычный", "Выше среднего", "Высокий", "Реального времени", "Не определен" };
+
 struct ProcessInfo 
 {
 	quint32 pid = 0;
@@ -36,6 +68,21 @@ struct ProcessInfo
 	quint64 diskWriteBytes = 0;
 
 	quint64 gpuUsage = 0;
+	quint64 gpuMemoryBytes = 0;
+	QList<ProcessGPUDeviceUsage> gpuDevices;
+
+	double networkReceiveBytesPerSec = 0.0;
+	double networkSendBytesPerSec = 0.0;
+
+	// Время запуска приходит вместе с процессорным временем, остальные поля - только перечисленные в detailFields
+	QDateTime startTime;
+	quint32 detailFields = 0;
+	QString path;
+	QString commandLine;
+	QString userName;
+	quint32 threadCount = 0;
+	quint32 handleCount = 0;
+	ProcessPriority priority = ppUnknown;
 };
 
 struct ProcessDetails 
@@ -54,7 +101,10 @@ struct ProcessDetails
 	quint32 handleCount = 0;
 
 	QString userName;
+	QByteArray accountId;	// SID владельца (Windows) или uid (Linux), ключ AccountNameResolver
 	QString priorityClass;
+	ProcessPriority priority = ppUnknown;
+	QString commandLine;
 };
 
 struct DiskInfo 
@@ -64,9 +114,23 @@ struct DiskInfo
 	quint64 freeBytes = 0;
 };
 
+// Физическое устройство: скорости и задержки за последний интервал опроса
+struct PhysicalDiskInfo
+{
+	QString name;
+	double readBytesPerSec = 0.0;
+	double writeBytesPerSec = 0.0;
+	double readOpsPerSec = 0.0;
+	double writeOpsPerSec = 0.0;
+	double averageServiceTimeMs = 0.0;	// среднее время выполнения запроса, включая ожидание в очереди
+	double queueLength = 0.0;			// средняя длина очереди запросов
+	double busyPercent = 0.0;			// доля времени, когда у устройства были незавершённые запросы
+};
+
 struct DisksInfo
 {
 	QList<DiskInfo> disks;
+	QList<PhysicalDiskInfo> physicalDisks;
 	double readBytesPerSec = 0.0;
 	double writeBytesPerSec = 0.0;
 	double ioBytesPerSec = 0.0;
@@ -75,16 +139,33 @@ struct DisksInfo
 struct ProcessDiskInfo 
 {
 	quint32 pid = 0;
-	quint64 bytesRead = 0;
+	quint64 bytesRead = 0;			// накопленные значения
 	quint64 bytesWritten = 0;
 	quint64 readOperations = 0;
 	quint64 writeOperations = 0;
+	double readBytesPerSec = 0.0;	// скорость за последний такт
+	double writeBytesPerSec = 0.0;
+};
+
+// Тип сетевого адаптера, значения - биты маски фильтра адаптеров
+enum NetworkAdapterType : quint32
+{
+	natEthernet = 1 << 0,
+	natWireless = 1 << 1,
+	natVirtual = 1 << 2,		// программные адаптеры: мосты, агрегаты (bond/team), veth, Hyper-V, VPN
+	natTunnel = 1 << 3,
+	natLoopback = 1 << 4,
+	natOther = 1 << 5
 };
 
+inline constexpr quint32 DEFAULT_NETWORK_ADAPTER_FILTER = natEthernet | natWireless | natVirtual | natOther;
+
 struct NetworkInterfaceInfo 
 {
 	QString name; 
 	QString description;
+	NetworkAdapterType type = natOther;
+	bool isUp = false;
 	quint64 bytesReceived = 0;
 	quint64 bytesSent = 0;
 	quint64 packetsReceived = 0;
@@ -93,6 +174,60 @@ struct NetworkInterfaceInfo
 	double sendBytesPerSec = 0.0;
 };
 
+// Секунда частых замеров выбранного адаптера (байт/с): крайние значения по коротким интервалам и средняя за секунду
+struct NetworkBurstSample
+{
+	QString interfaceName;
+	quint32 durationMs = 0;
+	quint32 samplesCount = 0;
+	double receiveMinBytesPerSec = 0.0;
+	double receiveAvgBytesPerSec = 0.0;
+	double receiveMaxBytesPerSec = 0.0;
+	double sendMinBytesPerSec = 0.0;
+	double sendAvgBytesPerSec = 0.0;
+	double sendMaxBytesPerSec = 0.0;
+};
+
+// Сетевой трафик процесса: сумма по его TCP-соединениям
+struct ProcessNetworkInfo
+{
+	quint32 pid = 0;
+	quint32 connectionCount = 0;
+	quint64 bytesReceived = 0;		// накопленные значения по живым соединениям
+	quint64 bytesSent = 0;
+	double receiveBytesPerSec = 0.0;
+	double sendBytesPerSec = 0.0;
+};
+
+enum ConnectionProtocol : quint8 { cpTcp, cpUdp };
+inline const char* ConnectionProtocolString[] { "TCP", "UDP" };
+
+// Состояния TCP в порядке жизненного цикла соединения; у UDP состояния нет (csNone)
+enum ConnectionState : quint8 { csNone, csListen, csSynSent, csSynReceived, csEstablished, csFinWait1, csFinWait2, csCloseWait, csClosing, csLastAck, csTimeWait, csClosed };
+inline const char* ConnectionStateString[] { "", "LISTEN", "SYN_SENT", "SYN_RECEIVED", "ESTABLISHED", "FIN_WAIT_1", "FIN_WAIT_2", "CLOSE_WAIT", "CLOSING", "LAST_ACK", "TIME_WAIT", "CLOSED" };
+inline constexpr int CONNECTION_STATES_COUNT = 12;
+
+struct ConnectionInfo
+{
+	quint64 key = 0;						// хэш протокола, адресов и портов, по нему сравниваются такты
+	ConnectionProtocol protocol = cpTcp;
+	bool isIPv6 = false;
+	std::array<quint8, 16> localAddress{};	// сетевой порядок байтов, IPv4 занимает первые 4 байта
+	std::array<quint8, 16> remoteAddress{};
+	quint16 localPort = 0;
+	quint16 remotePort = 0;
+	ConnectionState state = csNone;
+	quint32 pid = 0;
+};
+
+// Изменения таблицы соединений с прошлого такта
+struct ConnectionChanges
+{
+	QList<ConnectionInfo> opened;
+	QList<ConnectionInfo> changed;			// сменилось состояние или процесс-владелец
+	QList<quint64> closed;
+};
+
 struct GPUInfo 
 {
 	QString vendor;
@@ -109,7 +244,10 @@ struct GPUInfo
 struct ProcessGPUInfo
 {
 	quint32 pid = 0;
+	// Загрузка самой нагруженной процессом видеокарты и видеопамять процесса на всех видеокартах
 	qint32 gpuUtilization = 0;
+	quint64 gpuMemoryBytes = 0;
+	QList<ProcessGPUDeviceUsage> devices;
 };
 
 struct FlatProcessNode {
@@ -120,9 +258,15 @@ struct FlatProcessNode {
 enum ServiceStatus { ssRunning, ssStopped, ssPaused, ssStartPending, ssStopPending, ssContinuePending, ssPausePending, ssUnknown };
 inline const char* ServiceStatusString[] { "Выполняется", "Остановлено", "Приостановлено", "Запускается", "Останавливается", "Возобновляется", "Приостанавливается", "Неизвестен" };
 
+enum ServiceStartType { sstBoot, sstSystem, sstAutomatic, sstAutomaticDelayed, sstManual, sstDisabled, sstUnknown };
+inline const char* ServiceStartTypeString[] { "Загрузка", "Система", "Автоматически", "Автоматически (отложенный запуск)", "Вручную", "Отключена", "Неизвестен" };
+
 struct ServiceInfo {
 	QString name;
 	quint32 processId = 0;
 	QString description;
 	ServiceStatus status;
+	ServiceStartType startType = sstUnknown;
+	QString binaryPath;
+	QStringList dependencies;	// службы, без которых эта не запускается
 };
\ No newline at end of file
@@ -1,35 +1,353 @@
 #include "DataUpdater.h"
 
+#include "GPUMonitor.h"
+#include "FakeGPUBackend.h"
+#ifdef Q_OS_WIN
 #include <WindowsSystemMonitor.h>
-#include <WindowsGPUMonitor.h>
-#include <WindowsNetworkMonitor.h>
+#include "WindowsProcessControl.h"
 #include <WindowsDiskMonitor.h>
+#include <WindowsNetworkMonitor.h>
+#include "WindowsConnectionMonitor.h"
+#include "NvmlGPUBackend.h"
+#include "AdlGPUBackend.h"
 #include <WindowsServiceMonitor.h>
+#else
+#include "LinuxSystemMonitor.h"
+#include "LinuxProcessControl.h"
+#include "LinuxDiskMonitor.h"
+#include "LinuxNetworkMonitor.h"
+#include "LinuxConnectionMonitor.h"
+#include "LinuxDrmGPUBackend.h"
+#include "LinuxServiceMonitor.h"
+#endif
 #include <QDebug>
+#include <QtMath>
+#include "SelfProfiler.h"
 
 DataUpdater::DataUpdater(quint32 updateIntervalMs)
+    : _timer(this), _updateIntervalMs(updateIntervalMs), _networkBurstTimer(this)
 {
+#ifdef Q_OS_WIN
     _diskMonitor = std::make_unique<WindowsDiskMonitor>();
     _networkMonitor = std::make_unique<WindowsNetworkMonitor>();
-    _gpuMonitor = std::make_unique<WindowsGPUMonitor>();
+    _connectionMonitor = std::make_unique<WindowsConnectionMonitor>();
+#else
+    _diskMonitor = std::make_unique<LinuxDiskMonitor>();
+    _networkMonitor = std::make_unique<LinuxNetworkMonitor>();
+    _connectionMonitor = std::make_unique<LinuxConnectionMonitor>();
+#endif
+
+    // WINTOP_FAKE_GPU=<число> подменяет видеокарты подставными, чтобы проверить путь GPU на машине без неё
+    auto gpuMonitor = std::make_unique<GPUMonitor>();
+    int fakeGPUCount = qEnvironmentVariableIntValue("WINTOP_FAKE_GPU");
+    if (fakeGPUCount > 0)
+    {
+        gpuMonitor->addBackend(std::make_unique<FakeGPUBackend>(fakeGPUCount));
+    }
+    else
+    {
+#ifdef Q_OS_WIN
+        gpuMonitor->addBackend(std::make_unique<NvmlGPUBackend>());
+        gpuMonitor->addBackend(std::make_unique<AdlGPUBackend>());
+#else
+        // WINTOP_GPU_FIXTURE_ROOT=<каталог> - снятая копия /proc и /sys вместо настоящих
+        gpuMonitor->addBackend(std::make_unique<LinuxDrmGPUBackend>(qEnvironmentVariable("WINTOP_GPU_FIXTURE_ROOT")));
+#endif
+    }
+    _gpuMonitor = std::move(gpuMonitor);
+#ifdef Q_OS_WIN
     _systemMonitor = std::make_unique<WindowsSystemMonitor>(_diskMonitor.get(), _networkMonitor.get(), _gpuMonitor.get());
+    _processControl = std::make_unique<WindowsProcessControl>();
+#else
+    _systemMonitor = std::make_unique<LinuxSystemMonitor>(_diskMonitor.get(), _networkMonitor.get(), _gpuMonitor.get());
+    _processControl = std::make_unique<LinuxProcessControl>();
+#endif
+    _processDetails = std::make_unique<ProcessDetailsCollector>(_processControl.get());
+#ifdef Q_OS_WIN
     _serviceMonitor = std::make_unique<WindowsServiceMonitor>();
+#else
+    // Дочерний объект переезжает в поток сбора данных вместе с DataUpdater, туда же приходят сигналы systemd
+    _serviceMonitor = std::make_unique<LinuxServiceMonitor>(this);
+#endif
     _timer.setInterval(updateIntervalMs);
+    _sampleTimer.start();
     connect(&_timer, &QTimer::timeout, this, &DataUpdater::update);
+
+    _networkBurstTimer.setInterval(NETWORK_BURST_INTERVAL_MS);
+    _networkBurstTimer.setTimerType(Qt::PreciseTimer);
+    _networkBurstClock.start();
+    connect(&_networkBurstTimer, &QTimer::timeout, this, &DataUpdater::sampleNetworkBurst);
 }
 
 void DataUpdater::update() 
 {
+    if (_backgroundMode)
+    {
+        updateNetworkBurstTimer(false);
+        updateBackground();
+        return;
+    }
+
+    SELF_PROFILE_SCOPE("collect.total");
+
+    _sampleTimer.restart();
+
     UpdateData data;
-    data.systemInfo = _systemMonitor->getSystemInfo();
-    data.processes = _systemMonitor->getProcesses();
-    data.services = _serviceMonitor->getServices();
-    data.disks = _diskMonitor->getDisksInfo();
-    data.gpus = _gpuMonitor->getGPUInfo();
-    data.networkInterfaces = _networkMonitor->getNetworkInfo();
+    data.dataClasses = subscribedClasses();
+    // Подписка меняется из потока GUI, а таймер запускается только здесь, поэтому он следует за ней с задержкой до такта
+    updateNetworkBurstTimer((data.dataClasses & dcNetworkBurst) && !_networkBurstInterface.isEmpty());
+    {
+        SELF_PROFILE_SCOPE("collect.systemInfo");
+        data.systemInfo = _systemMonitor->getSystemInfo();
+    }
+    if (data.dataClasses & dcCpuCores)
+    {
+        SELF_PROFILE_SCOPE("collect.cpuCores");
+        data.systemInfo.cpuCoreUsage = _systemMonitor->getCpuCoreUsage();
+    }
+    if (data.dataClasses & dcProcessList)
+    {
+        SELF_PROFILE_SCOPE("collect.processes");
+        data.processes = _systemMonitor->getProcesses((data.dataClasses & dcProcessIO) != 0, (data.dataClasses & dcGPU) != 0,
+            (data.dataClasses & dcProcessNetwork) != 0);
+    }
+    else
+    {
+        // Ввод-вывод и трафик процессов приходят только вместе со списком процессов
+        data.dataClasses &= ~static_cast<quint32>(dcProcessIO | dcProcessNetwork);
+    }
+    if ((data.dataClasses & dcProcessList) && _processDetailFields != 0)
+    {
+        SELF_PROFILE_SCOPE("collect.processDetails");
+        _processDetails->fill(data.processes, _processDetailFields);
+    }
+    if (data.dataClasses & dcServices)
+    {
+        SELF_PROFILE_SCOPE("collect.services");
+        data.services = _serviceMonitor->getServices();
+    }
+    {
+        SELF_PROFILE_SCOPE("collect.disks");
+        data.disks = _diskMonitor->getDisksInfo();
+    }
+    if (data.dataClasses & dcGPU)
+    {
+        SELF_PROFILE_SCOPE("collect.gpus");
+        data.gpus = _gpuMonitor->getGPUInfo();
+    }
+    {
+        SELF_PROFILE_SCOPE("collect.network");
+        data.networkInterfaces = _networkMonitor->getNetworkInfo();
+    }
+    if (data.dataClasses & dcConnections)
+    {
+        SELF_PROFILE_SCOPE("collect.connections");
+        data.connectionChanges = _connectionMonitor->getConnectionChanges();
+    }
+
+    data.selfCpuUsage = measureSelfCpuUsage();
+
+    data.emittedAtNs = SpanTracer::nowNs();
+    if (SpanTracer::isEnabled())
+    {
+        data.traceFlowId = SpanTracer::instance().nextFlowId();
+        TRACE_FLOW_BEGIN("dataReady", data.traceFlowId);
+    }
     emit dataReady(data);
 }
 
+void DataUpdater::updateBackground()
+{
+    SELF_PROFILE_SCOPE("collect.background");
+
+    BackgroundSample sample;
+    sample.durationMs = static_cast<quint32>(_sampleTimer.restart());
+
+    SystemInfo load = _systemMonitor->getSystemLoad();
+    sample.cpuUsage = load.cpuUsage;
+    sample.usedMemory = load.usedMemory;
+    sample.totalMemory = load.totalMemory;
+
+    DisksInfo disks = _diskMonitor->getDiskRates();
+    sample.diskReadBytesPerSec = disks.readBytesPerSec;
+    sample.diskWriteBytesPerSec = disks.writeBytesPerSec;
+
+    sample.networkInterfaces = _networkMonitor->getNetworkInfo();
+    sample.selfCpuUsage = measureSelfCpuUsage();
+
+    adaptBackgroundInterval(sample);
+
+    _backgroundHistory.append(sample);
+    _backgroundHistoryMs += sample.durationMs;
+    while (_backgroundHistoryMs > BACKGROUND_HISTORY_MS && _backgroundHistory.size() > 1)
+    {
+        _backgroundHistoryMs -= _backgroundHistory.first().durationMs;
+        _backgroundHistory.removeFirst();
+    }
+}
+
+// Скорость считается изменившейся, если выросла или упала более чем вдвое и заметна по абсолютной величине
+static bool isRateChanged(double previous, double current, double significantRate)
+{
+    double higher = qMax(previous, current);
+    return higher >= significantRate && qAbs(current - previous) > higher / 2;
+}
+
+void DataUpdater::adaptBackgroundInterval(const BackgroundSample& sample)
+{
+    if (_backgroundHistory.isEmpty())
+    {
+        return;
+    }
+
+    const BackgroundSample& previous = _backgroundHistory.last();
+    double memoryDelta = sample.totalMemory > 0
+        ? qAbs(static_cast<double>(sample.usedMemory) - static_cast<double>(previous.usedMemory)) * 100.0 / sample.totalMemory
+        : 0.0;
+    double cpuDelta = qAbs(sample.cpuUsage - previous.cpuUsage);
+
+    double previousRecv = 0, previousSent = 0, currentRecv = 0, currentSent = 0;
+    for (const auto& net : previous.networkInterfaces)
+    {
+        previousRecv += net.receiveBytesPerSec;
+        previousSent += net.sendBytesPerSec;
+    }
+    for (const auto& net : sample.networkInterfaces)
+    {
+        currentRecv += net.receiveBytesPerSec;
+        currentSent += net.sendBytesPerSec;
+    }
+
+    const double significantRate = 1024.0 * 1024.0; // 1 МБ/с
+    bool changed = cpuDelta >= 10.0 || memoryDelta >= 5.0
+        || isRateChanged(previous.diskReadBytesPerSec, sample.diskReadBytesPerSec, significantRate)
+        || isRateChanged(previous.diskWriteBytesPerSec, sample.diskWriteBytesPerSec, significantRate)
+        || isRateChanged(previousRecv, currentRecv, significantRate)
+        || isRateChanged(previousSent, currentSent, significantRate);
+
+    // Резкое изменение - сразу минимальный интервал, спокойная нагрузка - интервал растёт вдвое до максимума
+    int interval = _timer.interval();
+    if (changed)
+    {
+        interval = BACKGROUND_MIN_INTERVAL_MS;
+    }
+    else if (cpuDelta < 2.0 && memoryDelta < 1.0)
+    {
+        interval = qMin(interval * 2, BACKGROUND_MAX_INTERVAL_MS);
+    }
+
+    if (interval != _timer.interval())
+    {
+        _timer.setInterval(interval);
+    }
+}
+
+double DataUpdater::measureSelfCpuUsage()
+{
+    quint64 cpuUs = SelfProfiler::processCpuTimeUs();
+    if (!_selfCpuTimer.isValid())
+    {
+        _selfCpuTimer.start();
+        _lastSelfCpuUs = cpuUs;
+        return 0.0;
+    }
+
+    qint64 wallUs = _selfCpuTimer.nsecsElapsed() / 1000;
+    _selfCpuTimer.restart();
+    quint64 deltaCpuUs = cpuUs >= _lastSelfCpuUs ? cpuUs - _lastSelfCpuUs : 0;
+    _lastSelfCpuUs = cpuUs;
+
+    int logicalProcessors = qMax(1, QThread::idealThreadCount());
+    return wallUs > 0 ? deltaCpuUs * 100.0 / wallUs / logicalProcessors : 0.0;
+}
+
+void DataUpdater::setBackgroundMode(bool enabled)
+{
+    if (enabled == _backgroundMode)
+    {
+        return;
+    }
+    _backgroundMode = enabled;
+
+    if (enabled)
+    {
+        _backgroundHistory.clear();
+        _backgroundHistoryMs = 0;
+        _timer.setInterval(BACKGROUND_MIN_INTERVAL_MS);
+        return;
+    }
+
+    _timer.setInterval(_updateIntervalMs);
+    if (!_backgroundHistory.isEmpty())
+    {
+        emit backgroundHistoryReady(_backgroundHistory);
+        _backgroundHistory.clear();
+        _backgroundHistoryMs = 0;
+    }
+}
+
+void DataUpdater::setNetworkAdapterFilter(quint32 adapterTypes)
+{
+    _networkMonitor->setAdapterFilter(adapterTypes);
+}
+
+void DataUpdater::setProcessDetailFields(quint32 fields)
+{
+    _processDetailFields = fields;
+    if (fields == 0)
+    {
+        // Пустая маска сбрасывает кэш, чтобы колонки, включённые позже, не показали устаревшее
+        _processDetails->clear();
+    }
+}
+
+void DataUpdater::setNetworkBurstInterface(const QString& name)
+{
+    if (name == _networkBurstInterface)
+    {
+        return;
+    }
+    _networkBurstInterface = name;
+    _networkBurstSampler.reset();
+}
+
+void DataUpdater::updateNetworkBurstTimer(bool enabled)
+{
+    if (enabled == _networkBurstTimer.isActive())
+    {
+        return;
+    }
+
+    if (enabled)
+    {
+        _networkBurstSampler.reset();
+        _networkBurstTimer.start();
+    }
+    else
+    {
+        _networkBurstTimer.stop();
+    }
+}
+
+void DataUpdater::sampleNetworkBurst()
+{
+    SELF_PROFILE_SCOPE("collect.networkBurst");
+
+    quint64 bytesReceived = 0, bytesSent = 0;
+    if (!_networkMonitor->readInterfaceCounters(_networkBurstInterface, bytesReceived, bytesSent))
+    {
+        _networkBurstSampler.reset();
+        return;
+    }
+
+    NetworkBurstSample sample;
+    if (_networkBurstSampler.addSample(_networkBurstClock.nsecsElapsed(), bytesReceived, bytesSent, sample))
+    {
+        sample.interfaceName = _networkBurstInterface;
+        emit networkBurstReady(sample);
+    }
+}
+
 void DataUpdater::start() 
 {
     _timer.start();
@@ -38,4 +356,40 @@ void DataUpdater::start()
 void DataUpdater::stop() 
 {
     _timer.stop();
+    _networkBurstTimer.stop();
+}
+
+void DataUpdater::subscribe(quint32 dataClasses)
+{
+    for (int i = 0; i < DATA_CLASSES_COUNT; i++)
+    {
+        if (dataClasses & (1u << i))
+        {
+            _subscribers[i].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void DataUpdater::unsubscribe(quint32 dataClasses)
+{
+    for (int i = 0; i < DATA_CLASSES_COUNT; i++)
+    {
+        if (dataClasses & (1u << i))
+        {
+            _subscribers[i].fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+quint32 DataUpdater::subscribedClasses() const
+{
+    quint32 dataClasses = 0;
+    for (int i = 0; i < DATA_CLASSES_COUNT; i++)
+    {
+        if (_subscribers[i].load(std::memory_order_relaxed) > 0)
+        {
+            dataClasses |= 1u << i;
+        }
+    }
+    return dataClasses;
 }
\ No newline at end of file
@@ -4,16 +4,37 @@
 #include <QTimer>
 #include <QThread>
 #include <QList>
+#include <QElapsedTimer>
 #include <memory>
+#include <array>
+#include <atomic>
 #include "DataStructs.h"
 #include "ISystemMonitor.h"
 #include "IServiceMonitor.h"
 #include "IDiskMonitor.h"
 #include "INetworkMonitor.h"
+#include "IConnectionMonitor.h"
 #include "IGPUMonitor.h"
 #include <IProcessControl.h>
 #include "IProcessTreeBuilder.h"
 #include "IServiceControl.h"
+#include "NetworkBurstSampler.h"
+#include "ProcessDetailsCollector.h"
+
+// Классы данных, сбор которых можно отключить, если их не показывает ни одно представление
+enum DataClass : quint32
+{
+    dcProcessList = 1 << 0,     // список процессов (память, ЦП)
+    dcProcessIO = 1 << 1,       // дисковый ввод-вывод процессов
+    dcServices = 1 << 2,        // список служб
+    dcGPU = 1 << 3,             // видеокарты и загрузка GPU процессами
+    dcCpuCores = 1 << 4,        // загрузка по ядрам
+    dcProcessNetwork = 1 << 5,  // сетевой трафик процессов
+    dcConnections = 1 << 6,     // изменения таблицы TCP/UDP-соединений
+    dcNetworkBurst = 1 << 7     // частые замеры выбранного адаптера (сигнал networkBurstReady)
+};
+
+inline constexpr int DATA_CLASSES_COUNT = 8;
 
 struct UpdateData 
 {
@@ -21,8 +42,33 @@ struct UpdateData
     QList<ProcessInfo> processes;
     QList<ServiceInfo> services;
     QList<NetworkInterfaceInfo> networkInterfaces;
+    // Только разница с прошлым тактом, в котором собирались соединения: пропускать её при обработке нельзя
+    ConnectionChanges connectionChanges;
     DisksInfo disks;
     QList<GPUInfo> gpus;
+
+    // Маска DataClass: какие необязательные данные собраны в этом такте
+    quint32 dataClasses = 0;
+
+    // Загрузка ЦП самим приложением, в процентах от всех логических процессоров
+    double selfCpuUsage = 0.0;
+
+    // Связь интервала сбора с обработкой в потоке GUI (для трассировки доставки сигнала)
+    quint64 traceFlowId = 0;
+    quint64 emittedAtNs = 0;
+};
+
+// Сэмпл фонового режима: только глобальные счётчики, скорости усреднены за durationMs
+struct BackgroundSample
+{
+    quint32 durationMs = 0;
+    double cpuUsage = 0.0;
+    quint64 usedMemory = 0;
+    quint64 totalMemory = 0;
+    double diskReadBytesPerSec = 0.0;
+    double diskWriteBytesPerSec = 0.0;
+    QList<NetworkInterfaceInfo> networkInterfaces;
+    double selfCpuUsage = 0.0;
 };
 
 class DataUpdater : public QObject 
@@ -31,20 +77,76 @@ class DataUpdater : public QObject
 
 public:
     DataUpdater(quint32 updateIntervalMs = 1000);
+
+    // Таймер принадлежит DataUpdater и переезжает вместе с ним в поток сбора, поэтому запускать и
+    // останавливать его нужно из этого потока (через сигнал или QMetaObject::invokeMethod)
     void start(); 
     void stop();
 
+    // Подписки считаются по каждому классу отдельно, вызывать можно из любого потока.
+    // Класс собирается, пока на него есть хотя бы одна подписка
+    void subscribe(quint32 dataClasses);
+    void unsubscribe(quint32 dataClasses);
+    quint32 subscribedClasses() const;
+
 public slots:
     void update();
 
+    // В фоновом режиме (окно свёрнуто) собираются только глобальные счётчики с адаптивным интервалом,
+    // а сэмплы копятся здесь и отдаются одним сигналом backgroundHistoryReady() при выходе из режима
+    void setBackgroundMode(bool enabled);
+
+    // Маска NetworkAdapterType, применяется со следующего такта
+    void setNetworkAdapterFilter(quint32 adapterTypes);
+
+    // Адаптер для частых замеров (dcNetworkBurst), имя - как в NetworkInterfaceInfo::name
+    void setNetworkBurstInterface(const QString& name);
+
+    // Маска ProcessDetailField: дополнительные поля, которые собираются вместе со списком процессов
+    void setProcessDetailFields(quint32 fields);
+
 signals:
     void dataReady(const UpdateData& data);
+    void backgroundHistoryReady(const QList<BackgroundSample>& samples);
+    // Раз в секунду, пока есть подписка на dcNetworkBurst
+    void networkBurstReady(const NetworkBurstSample& sample);
 
 private:
+    void updateBackground();
+    void adaptBackgroundInterval(const BackgroundSample& sample);
+    double measureSelfCpuUsage();
+    void updateNetworkBurstTimer(bool enabled);
+    void sampleNetworkBurst();
+
+    static constexpr int BACKGROUND_MIN_INTERVAL_MS = 1000;
+    static constexpr int BACKGROUND_MAX_INTERVAL_MS = 8000;
+    static constexpr qint64 BACKGROUND_HISTORY_MS = 3600 * 1000;
+    static constexpr int NETWORK_BURST_INTERVAL_MS = 100;
+
     QTimer _timer;
+    quint32 _updateIntervalMs;
+    bool _backgroundMode = false;
+    QList<BackgroundSample> _backgroundHistory;
+    qint64 _backgroundHistoryMs = 0;
+    QElapsedTimer _sampleTimer;
+
+    // Частые замеры одного адаптера на отдельном таймере: читаются только его счётчики, полный сбор не затрагивается
+    QTimer _networkBurstTimer;
+    QElapsedTimer _networkBurstClock;
+    QString _networkBurstInterface;
+    NetworkBurstSampler _networkBurstSampler;
+
+    QElapsedTimer _selfCpuTimer;
+    quint64 _lastSelfCpuUs = 0;
     std::unique_ptr<ISystemMonitor> _systemMonitor;
     std::unique_ptr<IDiskMonitor> _diskMonitor;
     std::unique_ptr<INetworkMonitor> _networkMonitor;
+    std::unique_ptr<IConnectionMonitor> _connectionMonitor;
     std::unique_ptr<IGPUMonitor> _gpuMonitor;
     std::unique_ptr<IServiceMonitor> _serviceMonitor;
+    std::unique_ptr<IProcessControl> _processControl;
+    std::unique_ptr<ProcessDetailsCollector> _processDetails;
+    quint32 _processDetailFields = 0;
+
+    std::array<std::atomic<int>, DATA_CLASSES_COUNT> _subscribers{};
 };
\ No newline at end of file
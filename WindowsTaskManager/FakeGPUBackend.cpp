@@ -0,0 +1,61 @@
+﻿#include "FakeGPUBackend.h"
+#include <QCoreApplication>
+#include <QtMath>
+
+FakeGPUBackend::FakeGPUBackend(int deviceCount)
+    : _deviceCount(deviceCount)
+{
+    _clock.start();
+}
+
+QList<GPUInfo> FakeGPUBackend::enumerateDevices()
+{
+    QList<GPUInfo> devices;
+    for (int i = 0; i < _deviceCount; i++)
+    {
+        GPUInfo info;
+        info.vendor = "Fake";
+        info.name = QString("Fake GPU %1").arg(i);
+        info.totalMemoryBytes = TOTAL_MEMORY_BYTES;
+        info.driverVersion = "0.0";
+        devices.append(info);
+    }
+    return devices;
+}
+
+quint32 FakeGPUBackend::deviceUsage(int device) const
+{
+    // Период минута, у каждого следующего устройства фаза сдвинута на четверть периода
+    double phase = _clock.elapsed() / 60000.0 * 2 * M_PI + device * M_PI / 2;
+    return static_cast<quint32>(qRound(50.0 + 45.0 * qSin(phase)));
+}
+
+bool FakeGPUBackend::sampleDevice(int device, GPUInfo& info)
+{
+    if (device < 0 || device >= _deviceCount)
+    {
+        return false;
+    }
+
+    info.usage = deviceUsage(device);
+    info.usedMemoryBytes = TOTAL_MEMORY_BYTES / 100 * info.usage;
+    info.temperatureCelsius = 35.0 + info.usage * 0.5;
+    info.powerUsage = 30 + info.usage * 2;
+    info.fanSpeed = 20 + info.usage * 3 / 4;
+    return true;
+}
+
+void FakeGPUBackend::sampleProcesses(int firstDevice, QMap<quint32, ProcessGPUInfo>& processes)
+{
+    quint32 pid = static_cast<quint32>(QCoreApplication::applicationPid());
+    for (int i = 0; i < _deviceCount; i++)
+    {
+        quint32 usage = deviceUsage(i);
+        ProcessGPUDeviceUsage& processUsage = processDeviceUsage(processes, pid, firstDevice + i);
+        processUsage.smUtilization = usage;
+        processUsage.memoryUtilization = usage / 2.0;
+        processUsage.encoderUtilization = i == 0 ? usage / 4.0 : 0.0;
+        processUsage.decoderUtilization = i == 0 ? usage / 8.0 : 0.0;
+        processUsage.memoryBytes = TOTAL_MEMORY_BYTES / 200 * usage;
+    }
+}
@@ -0,0 +1,24 @@
+﻿#pragma once
+
+#include "IGPUBackend.h"
+#include <QElapsedTimer>
+
+// Подставные видеокарты для проверки всего пути GPU (графики, панель, колонка процессов) без видеокарты.
+// Загрузка - детерминированная волна со сдвигом фазы по устройствам, вся она приписывается самому приложению
+class FakeGPUBackend : public IGPUBackend
+{
+public:
+    explicit FakeGPUBackend(int deviceCount);
+
+    QList<GPUInfo> enumerateDevices() override;
+    bool sampleDevice(int device, GPUInfo& info) override;
+    void sampleProcesses(int firstDevice, QMap<quint32, ProcessGPUInfo>& processes) override;
+
+private:
+    static constexpr quint64 TOTAL_MEMORY_BYTES = 8ULL * 1024 * 1024 * 1024;
+
+    int _deviceCount;
+    QElapsedTimer _clock;
+
+    quint32 deviceUsage(int device) const;
+};
@@ -0,0 +1,371 @@
+﻿#include "FakeSystemdService.h"
+#include <QCoreApplication>
+#include <QDBusVariant>
+#include <QProcess>
+#include <QThread>
+
+static QProcess* fakeBusDaemon = nullptr;
+
+static void stopFakeBusDaemon()
+{
+    if (fakeBusDaemon)
+    {
+        fakeBusDaemon->kill();
+        fakeBusDaemon->waitForFinished(1000);
+        delete fakeBusDaemon;
+        fakeBusDaemon = nullptr;
+    }
+}
+
+QString FakeSystemdService::start(int unitCount)
+{
+    // Своя сессионная шина, чтобы не трогать системную и не требовать прав
+    fakeBusDaemon = new QProcess();
+    fakeBusDaemon->start("dbus-daemon", { "--session", "--nofork", "--print-address=1" });
+    if (!fakeBusDaemon->waitForStarted(5000) || !fakeBusDaemon->waitForReadyRead(5000))
+    {
+        stopFakeBusDaemon();
+        return QString();
+    }
+    qAddPostRoutine(stopFakeBusDaemon);
+
+    QString address = QString::fromUtf8(fakeBusDaemon->readLine()).trimmed();
+    QDBusConnection connection = QDBusConnection::connectToBus(address, "wintop-fake-systemd");
+    if (!connection.isConnected())
+    {
+        return QString();
+    }
+
+    // Состояние служб живёт в своём потоке: таймеры переходов и смены состояния срабатывают в нём, туда же
+    // handleMessage() передаёт вызовы из потока шины. Синхронные вызовы из потоков GUI и сбора данных не ждут друг друга
+    auto* thread = new QThread();
+    thread->setObjectName("FakeSystemd");
+    auto* service = new FakeSystemdService(unitCount, connection);
+    service->moveToThread(thread);
+    QObject::connect(thread, &QThread::started, service, [service]()
+        {
+        service->_flapTimer.start();
+    });
+    thread->start();
+
+    connection.registerVirtualObject(SYSTEMD_MANAGER_PATH, service, QDBusConnection::SubPath);
+    connection.registerService(SYSTEMD_SERVICE);
+    return address;
+}
+
+FakeSystemdService::FakeSystemdService(int unitCount, const QDBusConnection& connection)
+    : _connection(connection), _flapTimer(this)
+{
+    static const char* knownUnits[][2] = {
+        { "dbus.service", "D-Bus System Message Bus" },
+        { "cron.service", "Regular background program processing daemon" },
+        { "ssh.service", "OpenBSD Secure Shell server" },
+        { "systemd-journald.service", "Journal Service" },
+        { "nginx.service", "A high performance web server and a reverse proxy server" },
+        { "wintop-flapping.service", "Служба, которая сама запускается и останавливается" },
+        { "bluetooth.service", "Bluetooth service" },
+        { "apt-daily.service", "Daily apt download activities" },
+    };
+    const int knownCount = static_cast<int>(sizeof(knownUnits) / sizeof(knownUnits[0]));
+
+    for (int i = 0; i < unitCount; i++)
+    {
+        FakeUnit unit;
+        if (i < knownCount)
+        {
+            unit.name = knownUnits[i][0];
+            unit.description = QString::fromUtf8(knownUnits[i][1]);
+        }
+        else
+        {
+            unit.name = QString("fake-%1.service").arg(i);
+            unit.description = QString("Подставная служба %1").arg(i);
+        }
+        unit.binaryPath = "/usr/sbin/" + unit.name.chopped(static_cast<int>(qstrlen(".service")));
+
+        // Состояния вперемешку: большинство работает, часть остановлена, одна упала, одна замаскирована
+        if (i % 7 == 6)
+        {
+            unit.activeState = "failed";
+            unit.subState = "failed";
+            unit.unitFileState = "enabled";
+        }
+        else if (i % 11 == 10)
+        {
+            unit.activeState = "inactive";
+            unit.subState = "dead";
+            unit.unitFileState = "masked";
+        }
+        else if (i % 3 == 2)
+        {
+            unit.activeState = "inactive";
+            unit.subState = "dead";
+            unit.unitFileState = i % 2 ? "disabled" : "static";
+        }
+        else
+        {
+            unit.activeState = "active";
+            unit.subState = "running";
+            unit.unitFileState = "enabled";
+            unit.mainPid = _nextPid++;
+        }
+        // Часть служб требует dbus.service, а каждая пятая ещё и предыдущую: получаются цепочки зависимостей
+        if (i > 0 && i % 4 == 0)
+        {
+            unit.requiredUnits.append(_units[0].name);
+        }
+        if (i > 1 && i % 5 == 0)
+        {
+            unit.requiredUnits.append(_units[i - 1].name);
+        }
+        if (unit.name == "wintop-flapping.service")
+        {
+            _flappingUnit = i;
+        }
+        _units.append(unit);
+    }
+
+    _flapTimer.setInterval(FLAP_INTERVAL_MS);
+    connect(&_flapTimer, &QTimer::timeout, this, [this]()
+        {
+        if (_flappingUnit < 0)
+        {
+            return;
+        }
+        if (_units[_flappingUnit].activeState == "active")
+        {
+            stopUnit(_flappingUnit);
+        }
+        else if (_units[_flappingUnit].activeState == "inactive")
+        {
+            startUnit(_flappingUnit);
+        }
+    });
+}
+
+QString FakeSystemdService::introspect(const QString& path) const
+{
+    if (path == SYSTEMD_MANAGER_PATH)
+    {
+        return QString("<interface name=\"%1\"/>").arg(SYSTEMD_MANAGER_INTERFACE);
+    }
+    return QString("<interface name=\"%1\"/><interface name=\"%2\"/>").arg(SYSTEMD_UNIT_INTERFACE, SYSTEMD_SERVICE_INTERFACE);
+}
+
+bool FakeSystemdService::handleMessage(const QDBusMessage& message, const QDBusConnection& connection)
+{
+    bool isManagerCall = message.interface() == SYSTEMD_MANAGER_INTERFACE && message.path() == SYSTEMD_MANAGER_PATH;
+    if (!isManagerCall && message.interface() != DBUS_PROPERTIES_INTERFACE)
+    {
+        return false;
+    }
+
+    // Вызов приходит в потоке шины Qt, а _units, _nextPid и _nextJobId меняются таймерами в потоке службы:
+    // разбор переносится в поток службы, ответ отправляется оттуда
+    message.setDelayedReply(true);
+    QMetaObject::invokeMethod(this, [this, message, connection, isManagerCall]()
+        {
+        bool handled = isManagerCall ? handleManagerCall(message, connection) : handlePropertiesCall(message, connection);
+        if (!handled)
+        {
+            connection.send(message.createErrorReply(QDBusError::UnknownMethod,
+                QString("No such method '%1' in interface '%2' at object path '%3'").arg(message.member(), message.interface(), message.path())));
+        }
+    }, Qt::QueuedConnection);
+    return true;
+}
+
+bool FakeSystemdService::handleManagerCall(const QDBusMessage& message, const QDBusConnection& connection)
+{
+    const QString method = message.member();
+    if (method == "ListUnits")
+    {
+        QList<SystemdUnitRecord> records;
+        for (const auto& unit : _units)
+        {
+            SystemdUnitRecord record;
+            record.name = unit.name;
+            record.description = unit.description;
+            record.loadState = unit.unitFileState == "masked" ? "masked" : "loaded";
+            record.activeState = unit.activeState;
+            record.subState = unit.subState;
+            record.unitPath = QDBusObjectPath(systemdUnitPath(unit.name));
+            record.jobPath = QDBusObjectPath("/");
+            records.append(record);
+        }
+        return connection.send(message.createReply(QVariant::fromValue(records)));
+    }
+    if (method == "Subscribe" || method == "Unsubscribe")
+    {
+        return connection.send(message.createReply());
+    }
+
+    QString name = message.arguments().value(0).toString();
+    int index = unitIndex(name);
+    if (method == "GetUnit" || method == "LoadUnit" || method == "StartUnit" || method == "StopUnit" || method == "RestartUnit")
+    {
+        if (index < 0)
+        {
+            return connection.send(message.createErrorReply("org.freedesktop.systemd1.NoSuchUnit", QString("Unit %1 not loaded.").arg(name)));
+        }
+        if (method == "GetUnit" || method == "LoadUnit")
+        {
+            return connection.send(message.createReply(QVariant::fromValue(QDBusObjectPath(systemdUnitPath(name)))));
+        }
+        if (_units[index].unitFileState == "masked" && method != "StopUnit")
+        {
+            return connection.send(message.createErrorReply("org.freedesktop.systemd1.UnitMasked", QString("Unit %1 is masked.").arg(name)));
+        }
+
+        if (method == "StopUnit")
+        {
+            stopUnit(index);
+        }
+        else
+        {
+            startUnit(index);
+        }
+        QDBusObjectPath job(QString("%1/job/%2").arg(SYSTEMD_MANAGER_PATH).arg(_nextJobId++));
+        return connection.send(message.createReply(QVariant::fromValue(job)));
+    }
+
+    return false;
+}
+
+bool FakeSystemdService::handlePropertiesCall(const QDBusMessage& message, const QDBusConnection& connection)
+{
+    int index = unitIndexByPath(message.path());
+    if (index < 0)
+    {
+        return false;
+    }
+
+    QString interfaceName = message.arguments().value(0).toString();
+    QVariantMap properties;
+    if (interfaceName == SYSTEMD_UNIT_INTERFACE)
+    {
+        properties = unitProperties(_units[index]);
+    }
+    else if (interfaceName == SYSTEMD_SERVICE_INTERFACE)
+    {
+        properties = serviceProperties(_units[index]);
+    }
+
+    if (message.member() == "GetAll")
+    {
+        return connection.send(message.createReply(properties));
+    }
+    if (message.member() == "Get")
+    {
+        QString property = message.arguments().value(1).toString();
+        if (!properties.contains(property))
+        {
+            return connection.send(message.createErrorReply(QDBusError::UnknownProperty, property));
+        }
+        return connection.send(message.createReply(QVariant::fromValue(QDBusVariant(properties.value(property)))));
+    }
+    return false;
+}
+
+int FakeSystemdService::unitIndex(const QString& name) const
+{
+    for (int i = 0; i < _units.size(); i++)
+    {
+        if (_units[i].name == name)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int FakeSystemdService::unitIndexByPath(const QString& path) const
+{
+    for (int i = 0; i < _units.size(); i++)
+    {
+        if (systemdUnitPath(_units[i].name) == path)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+QVariantMap FakeSystemdService::unitProperties(const FakeUnit& unit) const
+{
+    QVariantMap properties;
+    properties["Id"] = unit.name;
+    properties["Description"] = unit.description;
+    properties["LoadState"] = unit.unitFileState == "masked" ? "masked" : "loaded";
+    properties["ActiveState"] = unit.activeState;
+    properties["SubState"] = unit.subState;
+    properties["UnitFileState"] = unit.unitFileState;
+    properties["Requires"] = unit.requiredUnits;
+    properties["BindsTo"] = QStringList();
+    return properties;
+}
+
+QVariantMap FakeSystemdService::serviceProperties(const FakeUnit& unit) const
+{
+    SystemdExecCommand command;
+    command.path = unit.binaryPath;
+    command.arguments = QStringList{ unit.binaryPath };
+    command.pid = unit.mainPid;
+
+    QVariantMap properties;
+    properties["MainPID"] = unit.mainPid;
+    properties["ExecStart"] = QVariant::fromValue(QList<SystemdExecCommand>{ command });
+    return properties;
+}
+
+void FakeSystemdService::startUnit(int index)
+{
+    if (_units[index].activeState == "active" || _units[index].activeState == "activating")
+    {
+        return;
+    }
+    setState(index, "activating", "start", 0);
+    QTimer::singleShot(TRANSITION_MS, this, [this, index]()
+        {
+        setState(index, "active", "running", _nextPid++);
+    });
+}
+
+void FakeSystemdService::stopUnit(int index)
+{
+    if (_units[index].activeState == "inactive" || _units[index].activeState == "deactivating")
+    {
+        return;
+    }
+    setState(index, "deactivating", "stop-sigterm", _units[index].mainPid);
+    QTimer::singleShot(TRANSITION_MS, this, [this, index]()
+        {
+        setState(index, "inactive", "dead", 0);
+    });
+}
+
+void FakeSystemdService::setState(int index, const QString& activeState, const QString& subState, quint32 mainPid)
+{
+    FakeUnit& unit = _units[index];
+    unit.activeState = activeState;
+    unit.subState = subState;
+
+    // Как и systemd, состояние юнита и PID службы приходят отдельными сигналами своих интерфейсов
+    QString path = systemdUnitPath(unit.name);
+    QVariantMap unitChanged;
+    unitChanged["ActiveState"] = activeState;
+    unitChanged["SubState"] = subState;
+    QDBusMessage unitSignal = QDBusMessage::createSignal(path, DBUS_PROPERTIES_INTERFACE, "PropertiesChanged");
+    unitSignal << QString(SYSTEMD_UNIT_INTERFACE) << unitChanged << QStringList();
+    _connection.send(unitSignal);
+
+    if (unit.mainPid != mainPid)
+    {
+        unit.mainPid = mainPid;
+        QVariantMap serviceChanged;
+        serviceChanged["MainPID"] = mainPid;
+        QDBusMessage serviceSignal = QDBusMessage::createSignal(path, DBUS_PROPERTIES_INTERFACE, "PropertiesChanged");
+        serviceSignal << QString(SYSTEMD_SERVICE_INTERFACE) << serviceChanged << QStringList();
+        _connection.send(serviceSignal);
+    }
+}
@@ -0,0 +1,56 @@
+﻿#pragma once
+
+#include "LinuxSystemd.h"
+#include <QDBusVirtualObject>
+#include <QDBusMessage>
+#include <QTimer>
+#include <QList>
+
+// Подставной org.freedesktop.systemd1 на отдельной шине: ListUnits, Get/LoadUnit, Start/StopUnit, Properties.Get/GetAll и
+// PropertiesChanged, как у настоящего systemd. Одна служба периодически запускается и останавливается сама
+class FakeSystemdService : public QDBusVirtualObject
+{
+public:
+    // Запускает свой dbus-daemon и регистрирует на нём службу в отдельном потоке, возвращает адрес шины
+    static QString start(int unitCount);
+
+    FakeSystemdService(int unitCount, const QDBusConnection& connection);
+
+    QString introspect(const QString& path) const override;
+    bool handleMessage(const QDBusMessage& message, const QDBusConnection& connection) override;
+
+private:
+    static constexpr int TRANSITION_MS = 700;
+    static constexpr int FLAP_INTERVAL_MS = 3000;
+
+    struct FakeUnit
+    {
+        QString name;
+        QString description;
+        QString activeState;
+        QString subState;
+        QString unitFileState;
+        QString binaryPath;
+        QStringList requiredUnits;
+        quint32 mainPid = 0;
+    };
+
+    bool handleManagerCall(const QDBusMessage& message, const QDBusConnection& connection);
+    bool handlePropertiesCall(const QDBusMessage& message, const QDBusConnection& connection);
+
+    int unitIndex(const QString& name) const;
+    int unitIndexByPath(const QString& path) const;
+    QVariantMap unitProperties(const FakeUnit& unit) const;
+    QVariantMap serviceProperties(const FakeUnit& unit) const;
+
+    void startUnit(int index);
+    void stopUnit(int index);
+    void setState(int index, const QString& activeState, const QString& subState, quint32 mainPid);
+
+    QList<FakeUnit> _units;
+    QDBusConnection _connection;
+    QTimer _flapTimer;
+    int _flappingUnit = -1;
+    quint32 _nextPid = 4000;
+    quint32 _nextJobId = 1;
+};
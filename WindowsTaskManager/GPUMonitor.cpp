@@ -0,0 +1,53 @@
+﻿#include "GPUMonitor.h"
+
+void GPUMonitor::addBackend(std::unique_ptr<IGPUBackend> backend)
+{
+    QList<GPUInfo> devices = backend->enumerateDevices();
+    if (devices.isEmpty())
+    {
+        // Источник без устройств (нет драйвера или видеокарты) дальше не опрашивается
+        return;
+    }
+
+    int firstDevice = _devices.size();
+    for (int i = 0; i < devices.size(); i++)
+    {
+        _devices.append(Device{ backend.get(), i, devices[i] });
+    }
+    _backends.push_back(Backend{ std::move(backend), firstDevice });
+}
+
+QList<GPUInfo> GPUMonitor::getGPUInfo()
+{
+    QList<GPUInfo> gpus;
+    gpus.reserve(_devices.size());
+
+    for (auto& device : _devices)
+    {
+        // При ошибке опроса остаются показатели прошлого такта
+        device.backend->sampleDevice(device.index, device.info);
+        gpus.append(device.info);
+    }
+
+    return gpus;
+}
+
+QMap<quint32, ProcessGPUInfo> GPUMonitor::getProcessGPUInfo()
+{
+    QMap<quint32, ProcessGPUInfo> processes;
+    for (const auto& backend : _backends)
+    {
+        backend.backend->sampleProcesses(backend.firstDevice, processes);
+    }
+
+    // Колонка GPU показывает самую загруженную процессом видеокарту, память складывается
+    for (auto& process : processes)
+    {
+        for (const auto& usage : process.devices)
+        {
+            process.gpuUtilization = qMax(process.gpuUtilization, static_cast<qint32>(qRound(usage.smUtilization)));
+            process.gpuMemoryBytes += usage.memoryBytes;
+        }
+    }
+    return processes;
+}
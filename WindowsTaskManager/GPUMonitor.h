@@ -0,0 +1,35 @@
+﻿#pragma once
+
+#include "IGPUMonitor.h"
+#include "IGPUBackend.h"
+#include <QList>
+#include <memory>
+#include <vector>
+
+// Реестр видеокарт всех подключённых источников. Перечень устройств строится при добавлении источника,
+// в такте опрашиваются только динамические показатели уже известных устройств
+class GPUMonitor : public IGPUMonitor
+{
+public:
+    void addBackend(std::unique_ptr<IGPUBackend> backend);
+
+    QList<GPUInfo> getGPUInfo() override;
+    QMap<quint32, ProcessGPUInfo> getProcessGPUInfo() override;
+
+private:
+    struct Device
+    {
+        IGPUBackend* backend = nullptr;
+        int index = 0;
+        GPUInfo info;
+    };
+
+    struct Backend
+    {
+        std::unique_ptr<IGPUBackend> backend;
+        int firstDevice = 0;
+    };
+
+    std::vector<Backend> _backends;
+    QList<Device> _devices;
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "DataStructs.h"
+
+class IConnectionMonitor
+{
+public:
+    virtual ~IConnectionMonitor() = default;
+    // Соединения, открытые, закрытые и сменившие состояние с прошлого вызова. Первый вызов возвращает все как открытые
+    virtual ConnectionChanges getConnectionChanges() = 0;
+};
@@ -6,6 +6,8 @@ class IDiskMonitor
 {
 public:
     virtual DisksInfo getDisksInfo() = 0;
+    // Только суммарные скорости чтения/записи, без обхода томов
+    virtual DisksInfo getDiskRates() = 0;
     virtual QMap<quint32, ProcessDiskInfo> getProcessDiskInfo() = 0;
     virtual ~IDiskMonitor() = default;
 };
\ No newline at end of file
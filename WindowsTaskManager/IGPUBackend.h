@@ -0,0 +1,34 @@
+#pragma once
+
+#include "DataStructs.h"
+
+// Источник данных о видеокартах одного производителя (NVML, ADL, DRM, подставной).
+// Устройства перечисляются один раз, дальше опрашиваются по номеру в этом перечне
+class IGPUBackend
+{
+public:
+    // Статические поля устройств: производитель, имя, объём памяти, версия драйвера
+    virtual QList<GPUInfo> enumerateDevices() = 0;
+    // Обновляет динамические поля устройства с номером device из enumerateDevices()
+    virtual bool sampleDevice(int device, GPUInfo& info) = 0;
+    // Заполняет ProcessGPUInfo::devices для устройств источника; firstDevice - номер его первого устройства
+    // в общем перечне. Итоговые gpuUtilization и gpuMemoryBytes считает GPUMonitor
+    virtual void sampleProcesses(int firstDevice, QMap<quint32, ProcessGPUInfo>& processes) = 0;
+    virtual ~IGPUBackend() = default;
+};
+
+inline ProcessGPUDeviceUsage& processDeviceUsage(QMap<quint32, ProcessGPUInfo>& processes, quint32 pid, int device)
+{
+    ProcessGPUInfo& process = processes[pid];
+    process.pid = pid;
+    for (auto& usage : process.devices)
+    {
+        if (usage.device == device)
+        {
+            return usage;
+        }
+    }
+    process.devices.append(ProcessGPUDeviceUsage());
+    process.devices.last().device = device;
+    return process.devices.last();
+}
@@ -6,5 +6,12 @@ class INetworkMonitor
 {
 public:
     virtual QList<NetworkInterfaceInfo> getNetworkInfo() = 0;
+    // Маска NetworkAdapterType: адаптеры других типов не попадают в getNetworkInfo()
+    virtual void setAdapterFilter(quint32 adapterTypes) = 0;
+    // Трафик по процессам. Соединение учитывается со второго такта, в котором оно видно
+    virtual QMap<quint32, ProcessNetworkInfo> getProcessNetworkInfo() = 0;
+    // Накопленные счётчики одного адаптера по имени из getNetworkInfo(), без обхода таблицы интерфейсов.
+    // Вызывается на частом таймере и не влияет на скорости, которые считает getNetworkInfo()
+    virtual bool readInterfaceCounters(const QString& name, quint64& bytesReceived, quint64& bytesSent) = 0;
     virtual ~INetworkMonitor() = default;
 };
\ No newline at end of file
@@ -1,12 +1,15 @@
 #pragma once
 
 #include "DataStructs.h"
-#include <QIcon.h>
+#include <QIcon>
 
 class IProcessControl 
 {
 public:
     virtual ProcessDetails getProcessDetails(quint32 pId, const QList<ProcessInfo> processes) = 0;
+    // Сведения сразу о многих процессах; порядок результата совпадает с pIds. Можно вызывать из любого потока.
+    // fields - маска ProcessDetailField: незапрошенные поля не собираются и остаются пустыми
+    virtual QList<ProcessDetails> getProcessDetails(const QList<quint32>& pIds, const QList<ProcessInfo>& processes, quint32 fields) = 0;
     virtual bool killProcess(quint32 pId) = 0;
     virtual QIcon getProcessIcon(quint32 pId) = 0;
     virtual ~IProcessControl() = default;
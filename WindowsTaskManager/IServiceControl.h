@@ -8,4 +8,6 @@ public:
 	virtual ~IServiceControl() = default;
 	virtual bool startService(const QString& serviceName) = 0;
 	virtual bool stopService(const QString& serviceName) = 0;
+	// Текущее состояние службы, по нему отслеживается завершение запуска и остановки
+	virtual bool queryStatus(const QString& serviceName, ServiceStatus& status) = 0;
 };
\ No newline at end of file
@@ -7,5 +7,9 @@ class ISystemMonitor
 public:
 	virtual ~ISystemMonitor() = default;
 	virtual SystemInfo getSystemInfo() = 0;
-	virtual QList<ProcessInfo> getProcesses() = 0;
+	// Только общая загрузка ЦП и память, без описания процессора и подсчёта процессов
+	virtual SystemInfo getSystemLoad() = 0;
+	virtual QList<double> getCpuCoreUsage() = 0;
+	// Дисковая статистика, сетевой трафик и загрузка GPU процессов собираются отдельными запросами, поэтому их можно пропустить
+	virtual QList<ProcessInfo> getProcesses(bool withDiskInfo, bool withGPUInfo, bool withNetworkInfo) = 0;
 };
\ No newline at end of file
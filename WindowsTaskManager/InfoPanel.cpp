@@ -0,0 +1,82 @@
+#include "InfoPanel.h"
+
+void InfoPanel::setTree(QTreeWidget* tree)
+{
+    _tree = tree;
+    _items.clear();
+    _touched.clear();
+}
+
+void InfoPanel::beginUpdate()
+{
+    _touched.clear();
+}
+
+void InfoPanel::setItem(const QString& key, const QString& text, const QString& parentKey, bool expanded)
+{
+    _touched.insert(key);
+
+    auto it = _items.find(key);
+    if (it != _items.end())
+    {
+        if (it.value()->text(0) != text)
+        {
+            it.value()->setText(0, text);
+        }
+        return;
+    }
+
+    QTreeWidgetItem* parent = parentKey.isEmpty() ? nullptr : _items.value(parentKey, nullptr);
+    auto* item = parent ? new QTreeWidgetItem(parent) : new QTreeWidgetItem(_tree);
+    item->setText(0, text);
+    // Начальное раскрытие задаётся только при создании, дальше его меняет пользователь
+    item->setExpanded(expanded);
+    _items.insert(key, item);
+}
+
+void InfoPanel::endUpdate()
+{
+    QList<QString> staleKeys;
+    for (auto it = _items.constBegin(); it != _items.constEnd(); ++it)
+    {
+        if (!_touched.contains(it.key()))
+        {
+            staleKeys.append(it.key());
+        }
+    }
+
+    for (const QString& key : staleKeys)
+    {
+        removeItem(key);
+    }
+}
+
+void InfoPanel::removeItem(const QString& key)
+{
+    QTreeWidgetItem* item = _items.take(key);
+    if (!item)
+    {
+        return;
+    }
+
+    // Дочерние элементы удаляются вместе с родителем, убираем их из индекса
+    for (auto it = _items.begin(); it != _items.end();)
+    {
+        QTreeWidgetItem* ancestor = it.value()->parent();
+        while (ancestor && ancestor != item)
+        {
+            ancestor = ancestor->parent();
+        }
+
+        if (ancestor == item)
+        {
+            it = _items.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    delete item;
+}
@@ -0,0 +1,27 @@
+﻿#pragma once
+
+#include <QTreeWidget>
+#include <QHash>
+#include <QSet>
+#include <QString>
+
+// Обёртка над QTreeWidget информационной панели под графиком.
+// Элементы адресуются ключами и живут между обновлениями, поэтому состояние раскрытия сохраняется самим деревом,
+// а за такт изменяются только строки, у которых поменялся текст
+class InfoPanel
+{
+public:
+    void setTree(QTreeWidget* tree);
+
+    // Все элементы, не переданные в setItem() между beginUpdate() и endUpdate(), удаляются
+    void beginUpdate();
+    void setItem(const QString& key, const QString& text, const QString& parentKey = QString(), bool expanded = false);
+    void endUpdate();
+
+private:
+    void removeItem(const QString& key);
+
+    QTreeWidget* _tree = nullptr;
+    QHash<QString, QTreeWidgetItem*> _items;
+    QSet<QString> _touched;
+};
@@ -0,0 +1,99 @@
+﻿#include "LinuxConnectionMonitor.h"
+#include "SelfProfiler.h"
+
+#include <cstring>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <linux/netlink.h>
+#include <linux/sock_diag.h>
+#include <linux/inet_diag.h>
+
+// Состояния из include/net/tcp_states.h: TCP_ESTABLISHED (1) ... TCP_CLOSING (11)
+static ConnectionState tcpState(quint8 state)
+{
+    static const ConnectionState STATES[] = { csNone, csEstablished, csSynSent, csSynReceived, csFinWait1, csFinWait2,
+        csTimeWait, csClosed, csCloseWait, csLastAck, csListen, csClosing };
+    return state < sizeof(STATES) / sizeof(STATES[0]) ? STATES[state] : csNone;
+}
+
+static const quint32 ALL_SOCKET_STATES = 0xFFF;
+
+LinuxConnectionMonitor::LinuxConnectionMonitor()
+    : _diagSocket(NETLINK_SOCK_DIAG)
+{
+}
+
+bool LinuxConnectionMonitor::querySockets(quint8 family, quint8 protocol)
+{
+    struct
+    {
+        nlmsghdr header;
+        inet_diag_req_v2 request;
+    } message = {};
+    message.header.nlmsg_len = sizeof(message);
+    message.header.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+    message.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    message.request.sdiag_family = family;
+    message.request.sdiag_protocol = protocol;
+    message.request.idiag_states = ALL_SOCKET_STATES;
+
+    return _diagSocket.dump(&message, sizeof(message), [this, family, protocol](const nlmsghdr* header)
+        {
+        const auto* diag = static_cast<const inet_diag_msg*>(NLMSG_DATA(header));
+
+        SocketEntry entry;
+        entry.inode = diag->idiag_inode;
+        ConnectionInfo& connection = entry.connection;
+        connection.protocol = protocol == IPPROTO_UDP ? cpUdp : cpTcp;
+        connection.isIPv6 = family == AF_INET6;
+
+        // Адреса в сетевом порядке байтов, для IPv4 занят только первый элемент
+        size_t addressSize = connection.isIPv6 ? 16 : 4;
+        memcpy(connection.localAddress.data(), diag->id.idiag_src, addressSize);
+        memcpy(connection.remoteAddress.data(), diag->id.idiag_dst, addressSize);
+        connection.localPort = ntohs(diag->id.idiag_sport);
+        connection.remotePort = ntohs(diag->id.idiag_dport);
+        connection.state = connection.protocol == cpTcp ? tcpState(diag->idiag_state) : csNone;
+
+        _sockets.append(entry);
+        if (entry.inode != 0)
+        {
+            _liveInodes.insert(entry.inode);
+        }
+    });
+}
+
+ConnectionChanges LinuxConnectionMonitor::getConnectionChanges()
+{
+    _sockets.clear();
+    _liveInodes.clear();
+    _tracker.beginSample();
+    {
+        TRACE_SCOPE("collect.connections.diag");
+        for (quint8 protocol : { IPPROTO_TCP, IPPROTO_UDP })
+        {
+            for (quint8 family : { AF_INET, AF_INET6 })
+            {
+                // Сокеты из оборванного дампа учитываются, а остальные соединения семейства остаются до следующего такта
+                if (!_diagSocket.isOpen() || !querySockets(family, protocol))
+                {
+                    _tracker.skipFamily(protocol == IPPROTO_UDP ? cpUdp : cpTcp, family == AF_INET6);
+                }
+            }
+        }
+    }
+
+    {
+        TRACE_SCOPE("collect.connections.owners");
+        _socketOwners.update(_liveInodes);
+    }
+
+    // У сокетов в TIME_WAIT inode нулевой: владельца у них уже нет
+    for (auto& entry : _sockets)
+    {
+        entry.connection.pid = entry.inode != 0 ? _socketOwners.owner(entry.inode) : 0;
+        _tracker.update(entry.connection);
+    }
+    return _tracker.endSample();
+}
@@ -0,0 +1,31 @@
+﻿#pragma once
+
+#include "IConnectionMonitor.h"
+#include "ConnectionTracker.h"
+#include "LinuxNetlink.h"
+#include "LinuxSocketOwners.h"
+#include <QSet>
+
+class LinuxConnectionMonitor : public IConnectionMonitor
+{
+public:
+    LinuxConnectionMonitor();
+    ~LinuxConnectionMonitor() override = default;
+    ConnectionChanges getConnectionChanges() override;
+
+private:
+    // Соединение и inode его сокета: владелец определяется после того, как известны все inode такта
+    struct SocketEntry
+    {
+        ConnectionInfo connection;
+        quint64 inode = 0;
+    };
+
+    NetlinkSocket _diagSocket;
+    SocketOwnerIndex _socketOwners;
+    ConnectionTracker _tracker;
+    QList<SocketEntry> _sockets;
+    QSet<quint64> _liveInodes;
+
+    bool querySockets(quint8 family, quint8 protocol);
+};
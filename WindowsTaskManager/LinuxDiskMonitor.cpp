@@ -0,0 +1,263 @@
+﻿#include "LinuxDiskMonitor.h"
+#include "LinuxProcFs.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <sys/statvfs.h>
+
+// В /proc/diskstats размер сектора всегда 512 байт, независимо от устройства
+static const quint64 DISKSTATS_SECTOR_SIZE = 512;
+
+// Счётчики ядра на 32-битных системах переполняются, такой интервал просто пропускаем
+static quint64 counterDelta(quint64 current, quint64 previous)
+{
+    return current >= previous ? current - previous : 0;
+}
+
+// В mountinfo пробелы и спецсимволы в путях записаны восьмеричными escape-последовательностями (\040)
+static QByteArray unescapeMountPath(const QByteArray& path)
+{
+    QByteArray result;
+    result.reserve(path.size());
+    for (int i = 0; i < path.size(); i++)
+    {
+        if (path[i] == '\\' && i + 3 < path.size())
+        {
+            bool ok = false;
+            int code = path.mid(i + 1, 3).toInt(&ok, 8);
+            if (ok)
+            {
+                result.append(static_cast<char>(code));
+                i += 3;
+                continue;
+            }
+        }
+        result.append(path[i]);
+    }
+    return result;
+}
+
+LinuxDiskMonitor::LinuxDiskMonitor()
+{
+    // Запоминаем начальные значения счётчиков, чтобы первый такт уже дал скорости
+    getDiskRates();
+}
+
+bool LinuxDiskMonitor::isPhysicalDevice(const QString& name)
+{
+    auto it = _physicalDevices.constFind(name);
+    if (it != _physicalDevices.constEnd())
+    {
+        return it.value();
+    }
+
+    // Разделы лежат внутри каталога диска, а у loop, ram и dm-устройств нет ссылки device
+    QString sysName = name;
+    sysName.replace('/', '!');
+    bool physical = QFileInfo::exists(QString("/sys/block/%1/device").arg(sysName));
+    _physicalDevices.insert(name, physical);
+    return physical;
+}
+
+DisksInfo LinuxDiskMonitor::getDiskRates()
+{
+    DisksInfo disksInfo;
+
+    QFile file("/proc/diskstats");
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        return disksInfo;
+    }
+    QByteArray content = file.readAll();
+
+    double elapsedMs = _diskTimer.isValid() ? _diskTimer.nsecsElapsed() / 1000000.0 : 0.0;
+    _diskTimer.start();
+
+    QHash<QString, DiskStatCounters> currentStats;
+    for (const QByteArray& line : content.split('\n'))
+    {
+        // major minor имя, затем счётчики: чтения, слияния, секторы, мс чтения, записи, слияния, секторы, мс записи,
+        // запросы в работе, мс занятости, взвешенные мс
+        QList<QByteArray> fields = line.simplified().split(' ');
+        if (fields.size() < 14)
+        {
+            continue;
+        }
+
+        QString name = QString::fromLatin1(fields[2]);
+        if (!isPhysicalDevice(name))
+        {
+            continue;
+        }
+
+        DiskStatCounters counters;
+        counters.readsCompleted = fields[3].toULongLong();
+        counters.sectorsRead = fields[5].toULongLong();
+        counters.readTimeMs = fields[6].toULongLong();
+        counters.writesCompleted = fields[7].toULongLong();
+        counters.sectorsWritten = fields[9].toULongLong();
+        counters.writeTimeMs = fields[10].toULongLong();
+        counters.ioTimeMs = fields[12].toULongLong();
+        counters.weightedIoTimeMs = fields[13].toULongLong();
+        currentStats.insert(name, counters);
+
+        PhysicalDiskInfo disk;
+        disk.name = name;
+
+        auto last = _lastDiskStats.constFind(name);
+        if (last != _lastDiskStats.constEnd() && elapsedMs > 0)
+        {
+            double elapsedSec = elapsedMs / 1000.0;
+            quint64 reads = counterDelta(counters.readsCompleted, last->readsCompleted);
+            quint64 writes = counterDelta(counters.writesCompleted, last->writesCompleted);
+            quint64 requestTimeMs = counterDelta(counters.readTimeMs, last->readTimeMs) + counterDelta(counters.writeTimeMs, last->writeTimeMs);
+
+            disk.readBytesPerSec = counterDelta(counters.sectorsRead, last->sectorsRead) * DISKSTATS_SECTOR_SIZE / elapsedSec;
+            disk.writeBytesPerSec = counterDelta(counters.sectorsWritten, last->sectorsWritten) * DISKSTATS_SECTOR_SIZE / elapsedSec;
+            disk.readOpsPerSec = reads / elapsedSec;
+            disk.writeOpsPerSec = writes / elapsedSec;
+            disk.averageServiceTimeMs = reads + writes > 0 ? static_cast<double>(requestTimeMs) / (reads + writes) : 0.0;
+            disk.queueLength = counterDelta(counters.weightedIoTimeMs, last->weightedIoTimeMs) / elapsedMs;
+            disk.busyPercent = qMin(100.0, counterDelta(counters.ioTimeMs, last->ioTimeMs) * 100.0 / elapsedMs);
+        }
+
+        disksInfo.readBytesPerSec += disk.readBytesPerSec;
+        disksInfo.writeBytesPerSec += disk.writeBytesPerSec;
+        disksInfo.physicalDisks.append(disk);
+    }
+
+    disksInfo.ioBytesPerSec = disksInfo.readBytesPerSec + disksInfo.writeBytesPerSec;
+
+    _lastDiskStats = std::move(currentStats);
+    return disksInfo;
+}
+
+DisksInfo LinuxDiskMonitor::getDisksInfo()
+{
+    DisksInfo disksInfo = getDiskRates();
+    disksInfo.disks = getMountedVolumes();
+    return disksInfo;
+}
+
+QList<DiskInfo> LinuxDiskMonitor::getMountedVolumes()
+{
+    QList<DiskInfo> volumes;
+
+    QFile file("/proc/self/mountinfo");
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        return volumes;
+    }
+
+    QSet<QByteArray> seenDevices;
+    for (const QByteArray& line : file.readAll().split('\n'))
+    {
+        // id родитель major:minor корень точка_монтирования опции [необязательные поля...] - тип_фс источник опции_фс
+        QList<QByteArray> fields = line.split(' ');
+        qsizetype separator = fields.indexOf(QByteArray("-"));
+        if (separator < 6 || separator + 2 >= fields.size())
+        {
+            continue;
+        }
+
+        // Только тома на блочных устройствах, без proc, tmpfs, cgroup и т.п.
+        if (!fields[separator + 2].startsWith("/dev/"))
+        {
+            continue;
+        }
+
+        // Один том может быть смонтирован несколько раз (bind-монтирование), учитываем его однажды
+        if (seenDevices.contains(fields[2]))
+        {
+            continue;
+        }
+        seenDevices.insert(fields[2]);
+
+        QByteArray mountPoint = unescapeMountPath(fields[4]);
+        struct statvfs stats;
+        if (statvfs(mountPoint.constData(), &stats) != 0)
+        {
+            continue;
+        }
+
+        DiskInfo volume;
+        volume.name = QString::fromLocal8Bit(mountPoint);
+        volume.totalBytes = static_cast<quint64>(stats.f_blocks) * stats.f_frsize;
+        volume.freeBytes = static_cast<quint64>(stats.f_bavail) * stats.f_frsize;
+        volumes.append(volume);
+    }
+
+    return volumes;
+}
+
+QMap<quint32, ProcessDiskInfo> LinuxDiskMonitor::getProcessDiskInfo()
+{
+    QMap<quint32, ProcessDiskInfo> processDiskMap;
+
+    _processIoRates.beginSample();
+
+    const QStringList entries = QDir("/proc").entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString& entry : entries)
+    {
+        bool isPid = false;
+        quint32 pid = entry.toUInt(&isPid);
+        if (!isPid)
+        {
+            continue;
+        }
+
+        // Без root доступны только свои процессы, остальные пропускаем
+        QFile file(QString("/proc/%1/io").arg(pid));
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        {
+            continue;
+        }
+
+        ProcessDiskInfo procDisk;
+        procDisk.pid = pid;
+        for (const QByteArray& line : file.readAll().split('\n'))
+        {
+            qsizetype colon = line.indexOf(':');
+            if (colon < 0)
+            {
+                continue;
+            }
+
+            // read_bytes/write_bytes - обращения к накопителю, а не к кэшу страниц
+            QByteArray key = line.left(colon);
+            quint64 value = line.mid(colon + 1).trimmed().toULongLong();
+            if (key == "read_bytes")
+            {
+                procDisk.bytesRead = value;
+            }
+            else if (key == "write_bytes")
+            {
+                procDisk.bytesWritten = value;
+            }
+            else if (key == "syscr")
+            {
+                procDisk.readOperations = value;
+            }
+            else if (key == "syscw")
+            {
+                procDisk.writeOperations = value;
+            }
+        }
+
+        // Скорость считаем только для процессов, которые были и в прошлом такте; время запуска
+        // отличает новый процесс, получивший PID завершившегося
+        RateTracker<2>::Rates rates;
+        _processIoRates.update(pid, readProcessStartTime(pid), { procDisk.bytesRead, procDisk.bytesWritten }, rates);
+        procDisk.readBytesPerSec = rates[0];
+        procDisk.writeBytesPerSec = rates[1];
+
+        processDiskMap[pid] = procDisk;
+    }
+
+    // Завершившиеся процессы выпадают из истории счётчиков
+    _processIoRates.endSample();
+
+    return processDiskMap;
+}
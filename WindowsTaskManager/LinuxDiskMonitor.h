@@ -0,0 +1,42 @@
+﻿#pragma once
+
+#include "IDiskMonitor.h"
+#include "RateTracker.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMap>
+
+// Накопленные счётчики устройства из /proc/diskstats
+struct DiskStatCounters
+{
+    quint64 readsCompleted = 0;
+    quint64 sectorsRead = 0;
+    quint64 readTimeMs = 0;
+    quint64 writesCompleted = 0;
+    quint64 sectorsWritten = 0;
+    quint64 writeTimeMs = 0;
+    quint64 ioTimeMs = 0;
+    quint64 weightedIoTimeMs = 0;
+};
+
+class LinuxDiskMonitor : public IDiskMonitor
+{
+public:
+    LinuxDiskMonitor();
+    ~LinuxDiskMonitor() override = default;
+    DisksInfo getDisksInfo() override;
+    DisksInfo getDiskRates() override;
+    QMap<quint32, ProcessDiskInfo> getProcessDiskInfo() override;
+
+private:
+    // Для физических устройств
+    QHash<QString, DiskStatCounters> _lastDiskStats;
+    QHash<QString, bool> _physicalDevices;
+    QElapsedTimer _diskTimer;
+
+    // Для процессов
+    RateTracker<2> _processIoRates;
+
+    bool isPhysicalDevice(const QString& name);
+    QList<DiskInfo> getMountedVolumes();
+};
@@ -0,0 +1,408 @@
+﻿#include "LinuxDrmGPUBackend.h"
+
+#include <QDir>
+#include <QFile>
+#include <QSet>
+#include <algorithm>
+#include <vector>
+#include <cstring>
+#include <dirent.h>
+#include <unistd.h>
+
+LinuxDrmGPUBackend::LinuxDrmGPUBackend(const QString& rootPath)
+    : _root(rootPath)
+{
+    // Корень без завершающего "/", пути ниже начинаются с "/proc" и "/sys"
+    while (_root.endsWith('/'))
+    {
+        _root.chop(1);
+    }
+}
+
+bool LinuxDrmGPUBackend::readNumber(const QString& path, qint64& value)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+    bool ok = false;
+    value = file.readAll().trimmed().toLongLong(&ok);
+    return ok;
+}
+
+static QString vendorName(const QString& pciVendorId, const QString& driver)
+{
+    if (pciVendorId.compare("10DE", Qt::CaseInsensitive) == 0)
+    {
+        return "NVIDIA";
+    }
+    if (pciVendorId.compare("1002", Qt::CaseInsensitive) == 0)
+    {
+        return "AMD";
+    }
+    if (pciVendorId.compare("8086", Qt::CaseInsensitive) == 0)
+    {
+        return "Intel";
+    }
+    return driver;
+}
+
+QList<GPUInfo> LinuxDrmGPUBackend::enumerateDevices()
+{
+    QList<GPUInfo> devices;
+    _devices.clear();
+    _devicesByPciAddress.clear();
+
+    QString kernelRelease;
+    QFile osRelease(_root + "/proc/sys/kernel/osrelease");
+    if (osRelease.open(QIODevice::ReadOnly))
+    {
+        kernelRelease = QString::fromLatin1(osRelease.readAll().trimmed());
+    }
+
+    // Только сами карты: в каталоге есть и разъёмы вида card0-DP-1, и узлы renderD128
+    QDir drm(_root + "/sys/class/drm");
+    QStringList cards = drm.entryList({ "card*" }, QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+    for (const QString& card : cards)
+    {
+        bool isCard = false;
+        card.mid(4).toUInt(&isCard);
+        if (!isCard)
+        {
+            continue;
+        }
+
+        Device device;
+        device.devicePath = drm.filePath(card + "/device");
+
+        // uevent есть и в живой системе, и в снятой копии, где ссылка device может быть обычным каталогом
+        QFile uevent(device.devicePath + "/uevent");
+        if (!uevent.open(QIODevice::ReadOnly | QIODevice::Text))
+        {
+            continue;
+        }
+        QString driver, pciId;
+        while (!uevent.atEnd())
+        {
+            QByteArray line = uevent.readLine().trimmed();
+            if (line.startsWith("DRIVER="))
+            {
+                driver = QString::fromLatin1(line.mid(7));
+            }
+            else if (line.startsWith("PCI_ID="))
+            {
+                pciId = QString::fromLatin1(line.mid(7));
+            }
+            else if (line.startsWith("PCI_SLOT_NAME="))
+            {
+                device.pciAddress = QString::fromLatin1(line.mid(14));
+            }
+        }
+        if (device.pciAddress.isEmpty())
+        {
+            continue;
+        }
+
+        QStringList hwmons = QDir(device.devicePath + "/hwmon").entryList({ "hwmon*" }, QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+        if (!hwmons.isEmpty())
+        {
+            device.hwmonPath = device.devicePath + "/hwmon/" + hwmons.first();
+        }
+
+        GPUInfo gpu;
+        gpu.vendor = vendorName(pciId.section(':', 0, 0), driver);
+
+        // Маркетинговое имя отдаёт только amdgpu и не для всех плат
+        QFile productName(device.devicePath + "/product_name");
+        if (productName.open(QIODevice::ReadOnly))
+        {
+            gpu.name = QString::fromUtf8(productName.readAll().trimmed());
+        }
+        if (gpu.name.isEmpty())
+        {
+            gpu.name = QString("%1 %2 (%3)").arg(gpu.vendor, pciId, card);
+        }
+
+        // Драйверы DRM входят в ядро, их версия - версия ядра
+        gpu.driverVersion = kernelRelease.isEmpty() ? driver : QString("%1 %2").arg(driver, kernelRelease);
+
+        qint64 vramTotal = 0;
+        if (readNumber(device.devicePath + "/mem_info_vram_total", vramTotal))
+        {
+            gpu.totalMemoryBytes = static_cast<quint64>(vramTotal);
+        }
+
+        _devicesByPciAddress.insert(device.pciAddress, _devices.size());
+        _devices.append(device);
+        devices.append(gpu);
+    }
+
+    return devices;
+}
+
+bool LinuxDrmGPUBackend::sampleDevice(int device, GPUInfo& info)
+{
+    if (device < 0 || device >= _devices.size())
+    {
+        return false;
+    }
+
+    qint64 value = 0;
+    if (readNumber(_devices[device].devicePath + "/gpu_busy_percent", value))
+    {
+        info.usage = static_cast<quint32>(value);
+    }
+    else
+    {
+        // Список процессов в этом такте не собирался - обходим клиентов DRM сами
+        if (!_clientsSampleTimer.isValid() || _clientsSampleTimer.elapsed() > CLIENTS_BUSY_MAX_AGE_MS)
+        {
+            QMap<quint32, ProcessGPUInfo> ignored;
+            sampleProcesses(0, ignored);
+        }
+        info.usage = static_cast<quint32>(qRound(_devices[device].clientsBusy));
+    }
+    const Device& drmDevice = _devices[device];
+
+    if (readNumber(drmDevice.devicePath + "/mem_info_vram_used", value))
+    {
+        info.usedMemoryBytes = static_cast<quint64>(value);
+    }
+
+    if (!drmDevice.hwmonPath.isEmpty())
+    {
+        // Температура в миллиградусах, мощность в микроваттах, ШИМ вентилятора 0..255
+        if (readNumber(drmDevice.hwmonPath + "/temp1_input", value))
+        {
+            info.temperatureCelsius = value / 1000.0;
+        }
+        if (readNumber(drmDevice.hwmonPath + "/power1_average", value) || readNumber(drmDevice.hwmonPath + "/power1_input", value))
+        {
+            info.powerUsage = static_cast<quint32>(value / 1000000);
+        }
+        if (readNumber(drmDevice.hwmonPath + "/pwm1", value))
+        {
+            info.fanSpeed = static_cast<quint32>(value * 100 / 255);
+        }
+    }
+
+    return true;
+}
+
+void LinuxDrmGPUBackend::rescanDrmFiles()
+{
+    _drmFiles.clear();
+
+    QByteArray procPath = QFile::encodeName(_root) + "/proc";
+    const QStringList entries = QDir(QFile::decodeName(procPath)).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString& entry : entries)
+    {
+        bool isPid = false;
+        quint32 pid = entry.toUInt(&isPid);
+        if (!isPid)
+        {
+            continue;
+        }
+
+        // Без root доступны только дескрипторы своих процессов
+        QByteArray fdPath = procPath + "/" + QByteArray::number(pid) + "/fd";
+        DIR* dir = opendir(fdPath.constData());
+        if (!dir)
+        {
+            continue;
+        }
+
+        // Ссылка на видеокарту: /dev/dri/card0 или /dev/dri/renderD128
+        static const char DRI_PREFIX[] = "/dev/dri/";
+        char target[64];
+        while (dirent* fdEntry = readdir(dir))
+        {
+            if (fdEntry->d_name[0] == '.')
+            {
+                continue;
+            }
+
+            ssize_t length = readlinkat(dirfd(dir), fdEntry->d_name, target, sizeof(target) - 1);
+            if (length < static_cast<ssize_t>(sizeof(DRI_PREFIX) - 1) || strncmp(target, DRI_PREFIX, sizeof(DRI_PREFIX) - 1) != 0)
+            {
+                continue;
+            }
+            _drmFiles.append(DrmFile{ pid, QByteArray(fdEntry->d_name) });
+        }
+
+        closedir(dir);
+    }
+}
+
+// Класс движка по имени из drm-engine-<имя>: 0 - графика и вычисления, 1 - кодер, 2 - декодер, -1 - не учитывается
+// (копирование, SDMA). Имена: amdgpu - gfx, compute, enc, dec, jpeg; i915 - render, video, video-enhance; xe - rcs, ccs, vcs
+static int engineClass(const QByteArray& name)
+{
+    if (name == "gfx" || name == "compute" || name == "render" || name == "rcs" || name == "ccs")
+    {
+        return 0;
+    }
+    if (name.startsWith("enc"))
+    {
+        return 1;
+    }
+    if (name.startsWith("dec") || name.startsWith("jpeg") || name == "video" || name == "vcs")
+    {
+        return 2;
+    }
+    return -1;
+}
+
+// "123 KiB", "4 MiB" или число байт без единиц
+static quint64 parseMemorySize(const QByteArray& value)
+{
+    QList<QByteArray> parts = value.simplified().split(' ');
+    quint64 size = parts.value(0).toULongLong();
+    QByteArray unit = parts.value(1);
+    if (unit == "KiB")
+    {
+        return size * 1024;
+    }
+    if (unit == "MiB")
+    {
+        return size * 1024 * 1024;
+    }
+    if (unit == "GiB")
+    {
+        return size * 1024 * 1024 * 1024;
+    }
+    return size;
+}
+
+bool LinuxDrmGPUBackend::readClientInfo(const DrmFile& file, DrmClientInfo& client) const
+{
+    QFile fdinfo(_root + QString("/proc/%1/fdinfo/").arg(file.pid) + QString::fromLatin1(file.fd));
+    if (!fdinfo.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    // Видеопамять: области vram и local* (локальная память дискретной карты). Новые ядра пишут drm-total-*,
+    // старые amdgpu - drm-memory-*, при наличии обоих берётся drm-total-*
+    quint64 totalMemory = 0, legacyMemory = 0;
+    bool hasTotal = false;
+
+    const QList<QByteArray> lines = fdinfo.readAll().split('\n');
+    for (const QByteArray& line : lines)
+    {
+        int colon = line.indexOf(':');
+        if (colon <= 0 || !line.startsWith("drm-"))
+        {
+            continue;
+        }
+        QByteArray key = line.left(colon);
+        QByteArray value = line.mid(colon + 1).trimmed();
+
+        if (key == "drm-pdev")
+        {
+            client.pciAddress = QString::fromLatin1(value);
+        }
+        else if (key == "drm-client-id")
+        {
+            client.clientId = value.toULongLong(&client.hasClientId);
+        }
+        else if (key.startsWith("drm-engine-") && !key.startsWith("drm-engine-capacity-"))
+        {
+            quint64 busyNs = value.split(' ').value(0).toULongLong();
+            switch (engineClass(key.mid(11)))
+            {
+            case 0: client.smNs += busyNs; break;
+            case 1: client.encoderNs += busyNs; break;
+            case 2: client.decoderNs += busyNs; break;
+            default: break;
+            }
+        }
+        else if (key.startsWith("drm-total-") || key.startsWith("drm-memory-"))
+        {
+            bool isTotal = key.startsWith("drm-total-");
+            QByteArray region = key.mid(isTotal ? 10 : 11);
+            if (region != "vram" && !region.startsWith("local"))
+            {
+                continue;
+            }
+            if (isTotal)
+            {
+                totalMemory += parseMemorySize(value);
+                hasTotal = true;
+            }
+            else
+            {
+                legacyMemory += parseMemorySize(value);
+            }
+        }
+    }
+
+    client.memoryBytes = hasTotal ? totalMemory : legacyMemory;
+    return client.hasClientId && !client.pciAddress.isEmpty();
+}
+
+void LinuxDrmGPUBackend::sampleProcesses(int firstDevice, QMap<quint32, ProcessGPUInfo>& processes)
+{
+    if (_devices.isEmpty())
+    {
+        return;
+    }
+
+    if (!_fullRescanTimer.isValid() || _fullRescanTimer.elapsed() >= FULL_RESCAN_INTERVAL_MS)
+    {
+        _fullRescanTimer.start();
+        rescanDrmFiles();
+    }
+
+    std::vector<double> devicesBusy(_devices.size(), 0.0);
+    QSet<quint64> seenClients;
+    _clientRates.beginSample();
+
+    for (auto it = _drmFiles.begin(); it != _drmFiles.end();)
+    {
+        DrmClientInfo client;
+        int device = -1;
+        if (readClientInfo(*it, client))
+        {
+            device = _devicesByPciAddress.value(client.pciAddress, -1);
+        }
+        if (device < 0)
+        {
+            // Дескриптор закрыт, процесс завершился или номер дескриптора занят другим файлом
+            it = _drmFiles.erase(it);
+            continue;
+        }
+        quint32 pid = it->pid;
+        ++it;
+
+        // Один клиент виден через все копии дескриптора (dup, fork): учитываем его один раз
+        quint64 clientKey = (static_cast<quint64>(device) << 48) ^ client.clientId;
+        if (seenClients.contains(clientKey))
+        {
+            continue;
+        }
+        seenClients.insert(clientKey);
+
+        ProcessGPUDeviceUsage& usage = processDeviceUsage(processes, pid, firstDevice + device);
+        usage.memoryBytes += client.memoryBytes;
+
+        // Наносекунды занятости в секунду -> проценты. У класса может быть несколько движков, поэтому не выше 100
+        RateTracker<3>::Rates rates;
+        if (_clientRates.update(clientKey, pid, { client.smNs, client.encoderNs, client.decoderNs }, rates))
+        {
+            usage.smUtilization = std::min(100.0, usage.smUtilization + rates[0] / 1e7);
+            usage.encoderUtilization = std::min(100.0, usage.encoderUtilization + rates[1] / 1e7);
+            usage.decoderUtilization = std::min(100.0, usage.decoderUtilization + rates[2] / 1e7);
+            devicesBusy[device] += rates[0] / 1e7;
+        }
+    }
+
+    _clientRates.endSample();
+
+    for (int i = 0; i < _devices.size(); i++)
+    {
+        _devices[i].clientsBusy = std::min(100.0, devicesBusy[i]);
+    }
+    _clientsSampleTimer.start();
+}
@@ -0,0 +1,69 @@
+﻿#pragma once
+
+#include "IGPUBackend.h"
+#include "RateTracker.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+
+// Видеокарты Linux через DRM: показатели устройства из sysfs (gpu_busy_percent, mem_info_vram_*, hwmon),
+// загрузка процессами - из /proc/[pid]/fdinfo (drm-engine-*, drm-memory-*, drm-total-*).
+// Корневой каталог можно подменить снятой копией /proc и /sys, чтобы проверять разбор без видеокарты
+class LinuxDrmGPUBackend : public IGPUBackend
+{
+public:
+    explicit LinuxDrmGPUBackend(const QString& rootPath = QString());
+
+    QList<GPUInfo> enumerateDevices() override;
+    bool sampleDevice(int device, GPUInfo& info) override;
+    void sampleProcesses(int firstDevice, QMap<quint32, ProcessGPUInfo>& processes) override;
+
+private:
+    struct Device
+    {
+        QString devicePath;     // /sys/class/drm/cardN/device
+        QString hwmonPath;
+        QString pciAddress;     // совпадает с drm-pdev в fdinfo
+        // Сумма занятости графики по клиентам DRM, если драйвер не отдаёт gpu_busy_percent (i915, xe)
+        double clientsBusy = 0.0;
+    };
+
+    // Дескриптор DRM процесса, найденный при обходе ссылок /proc/[pid]/fd
+    struct DrmFile
+    {
+        quint32 pid = 0;
+        QByteArray fd;
+    };
+
+    // Разобранный fdinfo: время занятости движков по классам (нс) и видеопамять клиента
+    struct DrmClientInfo
+    {
+        QString pciAddress;
+        quint64 clientId = 0;
+        bool hasClientId = false;
+        quint64 smNs = 0;
+        quint64 encoderNs = 0;
+        quint64 decoderNs = 0;
+        quint64 memoryBytes = 0;
+    };
+
+    static constexpr qint64 FULL_RESCAN_INTERVAL_MS = 5000;
+    // Занятость по клиентам, посчитанная не раньше этого, считается текущей (процессы собираются до устройств)
+    static constexpr qint64 CLIENTS_BUSY_MAX_AGE_MS = 500;
+
+    QString _root;
+    QList<Device> _devices;
+    QHash<QString, int> _devicesByPciAddress;
+
+    // Кэш дескрипторов DRM: между полными обходами /proc читаются только их fdinfo, поэтому
+    // процесс, открывший видеокарту, появится не позже чем через FULL_RESCAN_INTERVAL_MS
+    QList<DrmFile> _drmFiles;
+    QElapsedTimer _fullRescanTimer;
+    QElapsedTimer _clientsSampleTimer;
+    // Клиент DRM - номер устройства и drm-client-id, экземпляр - PID
+    RateTracker<3> _clientRates;
+
+    void rescanDrmFiles();
+    bool readClientInfo(const DrmFile& file, DrmClientInfo& client) const;
+    static bool readNumber(const QString& path, qint64& value);
+};
@@ -0,0 +1,59 @@
+﻿#include "LinuxNetlink.h"
+
+#include <cerrno>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+
+// Достаточно для нескольких сотен сокетов или интерфейсов за один recv
+static const size_t NETLINK_BUFFER_SIZE = 64 * 1024;
+
+NetlinkSocket::NetlinkSocket(int protocol)
+    : _fd(socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, protocol)), _buffer(NETLINK_BUFFER_SIZE)
+{
+}
+
+NetlinkSocket::~NetlinkSocket()
+{
+    if (_fd >= 0)
+    {
+        close(_fd);
+    }
+}
+
+bool NetlinkSocket::dump(const void* request, size_t requestSize, const std::function<void(const nlmsghdr*)>& handler)
+{
+    sockaddr_nl kernel = {};
+    kernel.nl_family = AF_NETLINK;
+    if (sendto(_fd, request, requestSize, 0, reinterpret_cast<sockaddr*>(&kernel), sizeof(kernel)) < 0)
+    {
+        return false;
+    }
+
+    while (true)
+    {
+        ssize_t length = recv(_fd, _buffer.data(), _buffer.size(), 0);
+        if (length < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+
+        int remaining = static_cast<int>(length);
+        for (nlmsghdr* header = reinterpret_cast<nlmsghdr*>(_buffer.data()); NLMSG_OK(header, remaining); header = NLMSG_NEXT(header, remaining))
+        {
+            if (header->nlmsg_type == NLMSG_DONE)
+            {
+                return true;
+            }
+            if (header->nlmsg_type == NLMSG_ERROR)
+            {
+                return false;
+            }
+            handler(header);
+        }
+    }
+}
@@ -0,0 +1,29 @@
+﻿#pragma once
+
+#include <functional>
+#include <vector>
+
+struct nlmsghdr;
+
+// Сокет netlink для запросов-дампов (RTM_GETLINK, SOCK_DIAG_BY_FAMILY) с переиспользуемым буфером ответа
+class NetlinkSocket
+{
+public:
+    explicit NetlinkSocket(int protocol);
+    ~NetlinkSocket();
+
+    NetlinkSocket(const NetlinkSocket&) = delete;
+    NetlinkSocket& operator=(const NetlinkSocket&) = delete;
+
+    bool isOpen() const
+    {
+        return _fd >= 0;
+    }
+
+    // Отправляет запрос с NLM_F_DUMP и вызывает handler для каждого сообщения ответа до NLMSG_DONE
+    bool dump(const void* request, size_t requestSize, const std::function<void(const nlmsghdr*)>& handler);
+
+private:
+    int _fd = -1;
+    std::vector<char> _buffer;
+};
@@ -0,0 +1,308 @@
+﻿#include "LinuxNetworkMonitor.h"
+
+#include <QFileInfo>
+#include <cstddef>
+#include <cstring>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <net/if.h>
+#include <net/if_arp.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/if_link.h>
+#include <linux/sock_diag.h>
+#include <linux/inet_diag.h>
+#include <linux/tcp.h>
+
+// Состояния TCP из include/net/tcp_states.h: у слушающих сокетов и TIME_WAIT нет трафика и владельца
+static const quint32 TCP_STATE_LISTEN = 10;
+static const quint32 TCP_STATE_TIME_WAIT = 6;
+static const quint32 TCP_ALL_STATES = 0xFFF;
+
+LinuxNetworkMonitor::LinuxNetworkMonitor()
+    : _routeSocket(NETLINK_ROUTE), _diagSocket(NETLINK_SOCK_DIAG)
+{
+}
+
+void LinuxNetworkMonitor::setAdapterFilter(quint32 adapterTypes)
+{
+    _adapterFilter = adapterTypes;
+}
+
+bool LinuxNetworkMonitor::readCounterFile(QFile& file, quint64& value)
+{
+    // Атрибут sysfs формируется заново при чтении с нулевого смещения
+    if (!file.seek(0))
+    {
+        return false;
+    }
+    char buffer[32];
+    qint64 size = file.read(buffer, sizeof(buffer));
+    if (size <= 0)
+    {
+        return false;
+    }
+
+    bool ok = false;
+    value = QByteArray(buffer, static_cast<int>(size)).trimmed().toULongLong(&ok);
+    return ok;
+}
+
+bool LinuxNetworkMonitor::readInterfaceCounters(const QString& name, quint64& bytesReceived, quint64& bytesSent)
+{
+    if (name != _counterInterfaceName || !_receiveCounterFile.isOpen() || !_sendCounterFile.isOpen())
+    {
+        _receiveCounterFile.close();
+        _sendCounterFile.close();
+        _counterInterfaceName = name;
+
+        QString statistics = QString("/sys/class/net/%1/statistics/").arg(name);
+        _receiveCounterFile.setFileName(statistics + "rx_bytes");
+        _sendCounterFile.setFileName(statistics + "tx_bytes");
+        if (!_receiveCounterFile.open(QIODevice::ReadOnly | QIODevice::Unbuffered)
+            || !_sendCounterFile.open(QIODevice::ReadOnly | QIODevice::Unbuffered))
+        {
+            _receiveCounterFile.close();
+            _sendCounterFile.close();
+            return false;
+        }
+    }
+
+    if (!readCounterFile(_receiveCounterFile, bytesReceived) || !readCounterFile(_sendCounterFile, bytesSent))
+    {
+        // Интерфейс удалён: при следующем вызове файлы откроются заново
+        _receiveCounterFile.close();
+        _sendCounterFile.close();
+        return false;
+    }
+    return true;
+}
+
+NetworkAdapterType LinuxNetworkMonitor::adapterType(const QString& name, quint16 linkType)
+{
+    auto it = _adapterTypes.constFind(name);
+    if (it != _adapterTypes.constEnd())
+    {
+        return it.value();
+    }
+
+    NetworkAdapterType type = natOther;
+    switch (linkType)
+    {
+    case ARPHRD_LOOPBACK:
+        type = natLoopback;
+        break;
+    case ARPHRD_ETHER:
+        // У мостов, bond, veth и macvlan нет ссылки на устройство шины
+        if (!QFileInfo::exists(QString("/sys/class/net/%1/device").arg(name)))
+        {
+            type = natVirtual;
+        }
+        else
+        {
+            type = QFileInfo::exists(QString("/sys/class/net/%1/wireless").arg(name)) ? natWireless : natEthernet;
+        }
+        break;
+    case ARPHRD_NONE:       // tun, wireguard
+    case ARPHRD_PPP:
+    case ARPHRD_TUNNEL:
+    case ARPHRD_TUNNEL6:
+    case ARPHRD_SIT:
+    case ARPHRD_IPGRE:
+        type = natTunnel;
+        break;
+    default:
+        break;
+    }
+
+    _adapterTypes.insert(name, type);
+    return type;
+}
+
+QList<NetworkInterfaceInfo> LinuxNetworkMonitor::getNetworkInfo()
+{
+    QList<NetworkInterfaceInfo> interfaces;
+    if (!_routeSocket.isOpen())
+    {
+        return interfaces;
+    }
+
+    struct
+    {
+        nlmsghdr header;
+        ifinfomsg link;
+    } request = {};
+    request.header.nlmsg_len = sizeof(request);
+    request.header.nlmsg_type = RTM_GETLINK;
+    request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    request.link.ifi_family = AF_UNSPEC;
+
+    _interfaceRates.beginSample();
+
+    _routeSocket.dump(&request, sizeof(request), [&](const nlmsghdr* header)
+        {
+        if (header->nlmsg_type != RTM_NEWLINK)
+        {
+            return;
+        }
+
+        const auto* link = static_cast<const ifinfomsg*>(NLMSG_DATA(header));
+        QString name;
+        const rtnl_link_stats64* stats64 = nullptr;
+        const rtnl_link_stats* stats32 = nullptr;
+        int attributesLength = static_cast<int>(IFLA_PAYLOAD(header));
+        for (const rtattr* attribute = IFLA_RTA(link); RTA_OK(attribute, attributesLength); attribute = RTA_NEXT(attribute, attributesLength))
+        {
+            if (attribute->rta_type == IFLA_IFNAME)
+            {
+                name = QString::fromLocal8Bit(static_cast<const char*>(RTA_DATA(attribute)));
+            }
+            else if (attribute->rta_type == IFLA_STATS64 && RTA_PAYLOAD(attribute) >= sizeof(rtnl_link_stats64))
+            {
+                stats64 = static_cast<const rtnl_link_stats64*>(RTA_DATA(attribute));
+            }
+            else if (attribute->rta_type == IFLA_STATS && RTA_PAYLOAD(attribute) >= sizeof(rtnl_link_stats))
+            {
+                stats32 = static_cast<const rtnl_link_stats*>(RTA_DATA(attribute));
+            }
+        }
+        if (name.isEmpty() || (!stats64 && !stats32))
+        {
+            return;
+        }
+
+        NetworkAdapterType type = adapterType(name, link->ifi_type);
+        bool isUp = (link->ifi_flags & IFF_UP) && (link->ifi_flags & IFF_RUNNING);
+        if (!(_adapterFilter & type) || (!isUp && type != natEthernet && type != natWireless))
+        {
+            return;
+        }
+
+        NetworkInterfaceInfo info;
+        info.name = name;
+        info.description = name;
+        info.type = type;
+        info.isUp = isUp;
+
+        // Атрибут с 64-битными счётчиками есть с ядра 2.6.35, на более старых переполнение 32-битных учитывает RateTracker
+        int counterBits = 64;
+        if (stats64)
+        {
+            info.bytesReceived = stats64->rx_bytes;
+            info.bytesSent = stats64->tx_bytes;
+            info.packetsReceived = stats64->rx_packets;
+            info.packetsSent = stats64->tx_packets;
+        }
+        else
+        {
+            info.bytesReceived = stats32->rx_bytes;
+            info.bytesSent = stats32->tx_bytes;
+            info.packetsReceived = stats32->rx_packets;
+            info.packetsSent = stats32->tx_packets;
+            counterBits = 32;
+        }
+
+        // Индекс интерфейса не переиспользуется, пока система не перезагружена
+        RateTracker<2>::Rates rates;
+        _interfaceRates.update(static_cast<quint64>(link->ifi_index), 0, { info.bytesReceived, info.bytesSent }, rates, counterBits);
+        info.receiveBytesPerSec = rates[0];
+        info.sendBytesPerSec = rates[1];
+
+        interfaces.append(info);
+    });
+
+    _interfaceRates.endSample();
+    return interfaces;
+}
+
+bool LinuxNetworkMonitor::querySockets(quint8 family)
+{
+    struct
+    {
+        nlmsghdr header;
+        inet_diag_req_v2 request;
+    } message = {};
+    message.header.nlmsg_len = sizeof(message);
+    message.header.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+    message.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    message.request.sdiag_family = family;
+    message.request.sdiag_protocol = IPPROTO_TCP;
+    message.request.idiag_ext = 1 << (INET_DIAG_INFO - 1);
+    message.request.idiag_states = TCP_ALL_STATES & ~((1u << TCP_STATE_LISTEN) | (1u << TCP_STATE_TIME_WAIT));
+
+    return _diagSocket.dump(&message, sizeof(message), [this](const nlmsghdr* header)
+        {
+        const auto* diag = static_cast<const inet_diag_msg*>(NLMSG_DATA(header));
+        if (diag->idiag_inode == 0)
+        {
+            return;
+        }
+
+        SocketTrafficCounters counters;
+        counters.inode = diag->idiag_inode;
+
+        // tcpi_bytes_acked/tcpi_bytes_received появились в ядре 4.1, на более старых сокет остаётся с нулями
+        int attributesLength = static_cast<int>(header->nlmsg_len - NLMSG_LENGTH(sizeof(*diag)));
+        for (const rtattr* attribute = reinterpret_cast<const rtattr*>(diag + 1); RTA_OK(attribute, attributesLength); attribute = RTA_NEXT(attribute, attributesLength))
+        {
+            if (attribute->rta_type != INET_DIAG_INFO || RTA_PAYLOAD(attribute) < offsetof(tcp_info, tcpi_bytes_received) + sizeof(__u64))
+            {
+                continue;
+            }
+
+            tcp_info info = {};
+            memcpy(&info, RTA_DATA(attribute), qMin<size_t>(sizeof(info), RTA_PAYLOAD(attribute)));
+            counters.bytesSent = info.tcpi_bytes_acked;
+            counters.bytesReceived = info.tcpi_bytes_received;
+        }
+
+        _sockets.append(counters);
+    });
+}
+
+QMap<quint32, ProcessNetworkInfo> LinuxNetworkMonitor::getProcessNetworkInfo()
+{
+    QMap<quint32, ProcessNetworkInfo> processes;
+    if (!_diagSocket.isOpen())
+    {
+        return processes;
+    }
+
+    _sockets.clear();
+    if (!querySockets(AF_INET) || !querySockets(AF_INET6))
+    {
+        return processes;
+    }
+
+    QSet<quint64> liveInodes;
+    for (const auto& socket : _sockets)
+    {
+        liveInodes.insert(socket.inode);
+    }
+    _socketOwners.update(liveInodes);
+
+    _socketRates.beginSample();
+    for (const auto& socket : _sockets)
+    {
+        // inode уникален, пока сокет открыт, поэтому служит и идентификатором, и экземпляром
+        RateTracker<2>::Rates rates;
+        _socketRates.update(socket.inode, 0, { socket.bytesReceived, socket.bytesSent }, rates);
+
+        quint32 owner = _socketOwners.owner(socket.inode);
+        if (owner == 0)
+        {
+            continue;
+        }
+
+        ProcessNetworkInfo& info = processes[owner];
+        info.pid = owner;
+        info.connectionCount++;
+        info.bytesReceived += socket.bytesReceived;
+        info.bytesSent += socket.bytesSent;
+        info.receiveBytesPerSec += rates[0];
+        info.sendBytesPerSec += rates[1];
+    }
+    _socketRates.endSample();
+
+    return processes;
+}
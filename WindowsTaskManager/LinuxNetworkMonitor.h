@@ -0,0 +1,50 @@
+﻿#pragma once
+
+#include "INetworkMonitor.h"
+#include "RateTracker.h"
+#include "LinuxNetlink.h"
+#include "LinuxSocketOwners.h"
+#include <QHash>
+#include <QFile>
+
+// Счётчики TCP-сокета из sock_diag (INET_DIAG_INFO)
+struct SocketTrafficCounters
+{
+    quint64 inode = 0;
+    quint64 bytesReceived = 0;
+    quint64 bytesSent = 0;
+};
+
+class LinuxNetworkMonitor : public INetworkMonitor
+{
+public:
+    LinuxNetworkMonitor();
+    ~LinuxNetworkMonitor() override = default;
+    QList<NetworkInterfaceInfo> getNetworkInfo() override;
+    void setAdapterFilter(quint32 adapterTypes) override;
+    QMap<quint32, ProcessNetworkInfo> getProcessNetworkInfo() override;
+    bool readInterfaceCounters(const QString& name, quint64& bytesReceived, quint64& bytesSent) override;
+
+private:
+    NetlinkSocket _routeSocket;
+    NetlinkSocket _diagSocket;
+
+    // Для интерфейсов
+    RateTracker<2> _interfaceRates;
+    QHash<QString, NetworkAdapterType> _adapterTypes;
+    quint32 _adapterFilter = DEFAULT_NETWORK_ADAPTER_FILTER;
+
+    // Адаптер частых замеров: файлы statistics в sysfs держатся открытыми и перечитываются с начала
+    QString _counterInterfaceName;
+    QFile _receiveCounterFile;
+    QFile _sendCounterFile;
+
+    // Для процессов
+    QList<SocketTrafficCounters> _sockets;
+    RateTracker<2> _socketRates;
+    SocketOwnerIndex _socketOwners;
+
+    NetworkAdapterType adapterType(const QString& name, quint16 linkType);
+    bool querySockets(quint8 family);
+    static bool readCounterFile(QFile& file, quint64& value);
+};
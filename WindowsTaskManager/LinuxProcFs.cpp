@@ -0,0 +1,77 @@
+﻿#include "LinuxProcFs.h"
+
+#include <QFile>
+#include <QList>
+#include <unistd.h>
+
+bool readProcessStat(quint32 pid, ProcessStat& stat, const QString& procPath)
+{
+    QFile file(QString("%1/%2/stat").arg(procPath).arg(pid));
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    // Имя процесса в скобках может содержать пробелы, поэтому поля считаются после последней ')'
+    QByteArray line = file.readAll();
+    qsizetype nameStart = line.indexOf('(');
+    qsizetype nameEnd = line.lastIndexOf(')');
+    if (nameStart < 0 || nameEnd < nameStart)
+    {
+        return false;
+    }
+
+    // После имени идут поля начиная с третьего (state): ppid - 1, utime - 11, nice - 16, starttime - 19, policy - 38
+    QList<QByteArray> fields = line.mid(nameEnd + 2).split(' ');
+    if (fields.size() < 22)
+    {
+        return false;
+    }
+
+    stat.name = QString::fromUtf8(line.mid(nameStart + 1, nameEnd - nameStart - 1));
+    stat.parentPID = fields[1].toUInt();
+    stat.userTicks = fields[11].toULongLong();
+    stat.systemTicks = fields[12].toULongLong();
+    stat.nice = fields[16].toInt();
+    stat.threadCount = fields[17].toUInt();
+    stat.startTime = fields[19].toULongLong();
+    stat.residentPages = fields[21].toULongLong();
+    stat.policy = fields.size() > 38 ? fields[38].toUInt() : 0;
+    return true;
+}
+
+quint64 readProcessStartTime(quint32 pid, const QString& procPath)
+{
+    ProcessStat stat;
+    return readProcessStat(pid, stat, procPath) ? stat.startTime : 0;
+}
+
+static qint64 bootTimeSeconds()
+{
+    QFile file("/proc/stat");
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        return 0;
+    }
+    while (!file.atEnd())
+    {
+        QByteArray line = file.readLine();
+        if (line.startsWith("btime "))
+        {
+            return line.mid(6).trimmed().toLongLong();
+        }
+    }
+    return 0;
+}
+
+QDateTime processStartDateTime(quint64 startTime)
+{
+    // Время загрузки и длина тика не меняются, читаются один раз
+    static const qint64 bootTime = bootTimeSeconds();
+    static const long ticksPerSecond = sysconf(_SC_CLK_TCK);
+    if (bootTime == 0 || ticksPerSecond <= 0)
+    {
+        return QDateTime();
+    }
+    return QDateTime::fromMSecsSinceEpoch(bootTime * 1000 + static_cast<qint64>(startTime * 1000 / ticksPerSecond));
+}
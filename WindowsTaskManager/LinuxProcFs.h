@@ -0,0 +1,29 @@
+﻿#pragma once
+
+#include <QtGlobal>
+#include <QString>
+#include <QDateTime>
+
+// Поля /proc/[pid]/stat, которые нужны мониторам
+struct ProcessStat
+{
+    QString name;               // comm: имя программы, обрезанное ядром до 15 символов
+    quint32 parentPID = 0;
+    quint64 userTicks = 0;      // процессорное время в тиках sysconf(_SC_CLK_TCK)
+    quint64 systemTicks = 0;
+    qint32 nice = 0;
+    quint32 threadCount = 0;
+    quint64 startTime = 0;      // тики с загрузки системы
+    quint64 residentPages = 0;
+    quint32 policy = 0;         // SCHED_OTHER, SCHED_FIFO, ...
+};
+
+// procPath - каталог proc: настоящий /proc или его снятая копия
+bool readProcessStat(quint32 pid, ProcessStat& stat, const QString& procPath = QStringLiteral("/proc"));
+
+// Время запуска процесса в тиках с загрузки системы (поле 22 /proc/[pid]/stat), 0 если процесс недоступен.
+// Вместе с PID однозначно определяет процесс: переиспользованный PID получит другое время запуска
+quint64 readProcessStartTime(quint32 pid, const QString& procPath = QStringLiteral("/proc"));
+
+// Время запуска в тиках с загрузки -> дата по btime из /proc/stat
+QDateTime processStartDateTime(quint64 startTime);
@@ -0,0 +1,204 @@
+﻿#include "LinuxProcessControl.h"
+#include "LinuxProcFs.h"
+#include "AccountNameResolver.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QThread>
+#include <sched.h>
+#include <signal.h>
+#include <errno.h>
+
+const quint32 GRACEFUL_KILL_PROCESS_TIMEOUT = 3000;
+
+ProcessPriority LinuxProcessControl::getProcessPriority(qint32 nice, quint32 policy)
+{
+    // Классы приоритета Windows по значению nice; процессы реального времени - отдельный класс
+    if (policy == SCHED_FIFO || policy == SCHED_RR)
+    {
+        return ppRealtime;
+    }
+    if (nice <= -15)
+    {
+        return ppHigh;
+    }
+    if (nice < 0)
+    {
+        return ppAboveNormal;
+    }
+    if (nice == 0)
+    {
+        return ppNormal;
+    }
+    if (nice < 15)
+    {
+        return ppBelowNormal;
+    }
+    return ppIdle;
+}
+
+void LinuxProcessControl::fillProcessDetails(ProcessDetails& details, quint32 fields)
+{
+    if (fields & pdfUserName)
+    {
+        details.userName = "Не определен";
+    }
+    details.priorityClass = ProcessPriorityString[ppUnknown];
+
+    // Один разбор stat даёт и время запуска, и потоки, и приоритет
+    ProcessStat stat;
+    if (!readProcessStat(details.pid, stat))
+    {
+        return;
+    }
+
+    // Время запуска нужно всегда: по нему кэшируются неизменяемые поля
+    details.startTime = processStartDateTime(stat.startTime);
+    QString procDir = QString("/proc/%1").arg(details.pid);
+
+    if (fields & pdfPath)
+    {
+        // У потоков ядра и чужих процессов без прав ссылка не читается
+        details.path = QFileInfo(procDir + "/exe").symLinkTarget();
+    }
+    if (fields & pdfThreadCount)
+    {
+        details.threadCount = stat.threadCount;
+    }
+    if (fields & pdfHandleCount)
+    {
+        details.handleCount = QDir(procDir + "/fd").entryList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::System).size();
+    }
+    if (fields & pdfPriority)
+    {
+        details.priority = getProcessPriority(stat.nice, stat.policy);
+        details.priorityClass = ProcessPriorityString[details.priority];
+    }
+    if (fields & pdfUserName)
+    {
+        // Реальный uid - первое число строки "Uid:"
+        QFile status(procDir + "/status");
+        if (status.open(QIODevice::ReadOnly | QIODevice::Text))
+        {
+            while (!status.atEnd())
+            {
+                QByteArray line = status.readLine();
+                if (line.startsWith("Uid:"))
+                {
+                    bool ok = false;
+                    quint32 uid = line.mid(4).simplified().split(' ').value(0).toUInt(&ok);
+                    if (ok)
+                    {
+                        details.accountId = AccountNameResolver::accountId(uid);
+                        details.userName = AccountNameResolver::instance().accountName(details.accountId);
+                    }
+                    break;
+                }
+            }
+        }
+    }
+    if (fields & pdfCommandLine)
+    {
+        // Аргументы разделены нулями; у потоков ядра командная строка пустая
+        QFile cmdline(procDir + "/cmdline");
+        if (cmdline.open(QIODevice::ReadOnly))
+        {
+            QByteArray data = cmdline.readAll();
+            while (data.endsWith('\0'))
+            {
+                data.chop(1);
+            }
+            details.commandLine = QString::fromLocal8Bit(data.replace('\0', ' '));
+        }
+    }
+}
+
+ProcessDetails LinuxProcessControl::getProcessDetails(quint32 pid, const QList<ProcessInfo> processes)
+{
+    return getProcessDetails(QList<quint32>{ pid }, processes, PROCESS_DETAIL_ALL_FIELDS).value(0);
+}
+
+QList<ProcessDetails> LinuxProcessControl::getProcessDetails(const QList<quint32>& pids, const QList<ProcessInfo>& processes, quint32 fields)
+{
+    // Индексы по PID строятся один раз на пакет вместо прохода по списку для каждого процесса
+    QHash<quint32, const ProcessInfo*> infoByPid;
+    QHash<quint32, quint32> childCounts;
+    infoByPid.reserve(processes.size());
+    for (const auto& processInfo : processes)
+    {
+        infoByPid.insert(processInfo.pid, &processInfo);
+        childCounts[processInfo.parentPID]++;
+    }
+
+    // Чтение /proc не блокируется на других процессах, поэтому пул потоков, как на Windows, не нужен
+    QList<ProcessDetails> result(pids.size());
+    for (qsizetype i = 0; i < pids.size(); i++)
+    {
+        ProcessDetails& details = result[i];
+        quint32 pid = pids[i];
+        details.pid = pid;
+        details.childProcessesCount = childCounts.value(pid);
+
+        const ProcessInfo* info = infoByPid.value(pid, nullptr);
+        if (info)
+        {
+            details.name = info->name;
+            details.parentPID = info->parentPID;
+            details.cpuUsage = info->cpuUsage;
+            details.memoryUsage = info->memoryUsage;
+            details.workingSetSize = info->workingSetSize;
+        }
+        else
+        {
+            ProcessStat stat;
+            if (readProcessStat(pid, stat))
+            {
+                details.name = stat.name;
+                details.parentPID = stat.parentPID;
+            }
+        }
+
+        fillProcessDetails(details, fields);
+    }
+
+    return result;
+}
+
+bool LinuxProcessControl::waitForExit(quint32 pId, qint64 timeoutMs)
+{
+    // Чужой процесс нельзя дождаться через waitpid: проверяем его существование сигналом 0
+    QElapsedTimer timer;
+    timer.start();
+    while (!timer.hasExpired(timeoutMs))
+    {
+        if (::kill(static_cast<pid_t>(pId), 0) != 0 && errno == ESRCH)
+        {
+            return true;
+        }
+        QThread::msleep(50);
+    }
+    return false;
+}
+
+bool LinuxProcessControl::killProcess(quint32 pId)
+{
+    // Сначала SIGTERM, чтобы процесс мог завершиться сам, затем SIGKILL
+    if (::kill(static_cast<pid_t>(pId), SIGTERM) != 0)
+    {
+        return false;
+    }
+    if (waitForExit(pId, GRACEFUL_KILL_PROCESS_TIMEOUT))
+    {
+        return true;
+    }
+    return ::kill(static_cast<pid_t>(pId), SIGKILL) == 0;
+}
+
+QIcon LinuxProcessControl::getProcessIcon(quint32 pId)
+{
+    // У исполняемых файлов Linux нет встроенных значков: берётся общий значок из темы
+    Q_UNUSED(pId);
+    return QIcon::fromTheme("application-x-executable");
+}
@@ -0,0 +1,21 @@
+﻿#pragma once
+
+#include "IProcessControl.h"
+
+// Сведения о процессах из /proc/[pid], завершение сигналами
+class LinuxProcessControl : public IProcessControl
+{
+public:
+    LinuxProcessControl() = default;
+    ~LinuxProcessControl() override = default;
+
+    ProcessDetails getProcessDetails(quint32 pid, const QList<ProcessInfo> processes) override;
+    QList<ProcessDetails> getProcessDetails(const QList<quint32>& pids, const QList<ProcessInfo>& processes, quint32 fields) override;
+    bool killProcess(quint32 pId) override;
+    QIcon getProcessIcon(quint32 pId) override;
+
+private:
+    static void fillProcessDetails(ProcessDetails& details, quint32 fields);
+    static ProcessPriority getProcessPriority(qint32 nice, quint32 policy);
+    static bool waitForExit(quint32 pId, qint64 timeoutMs);
+};
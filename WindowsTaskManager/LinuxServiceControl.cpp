@@ -0,0 +1,50 @@
+#include "LinuxServiceControl.h"
+#include "LinuxSystemd.h"
+#include <QDBusMessage>
+
+bool LinuxServiceControl::startService(const QString& serviceName)
+{
+    return callManager("StartUnit", serviceName);
+}
+
+bool LinuxServiceControl::stopService(const QString& serviceName)
+{
+    return callManager("StopUnit", serviceName);
+}
+
+bool LinuxServiceControl::queryStatus(const QString& serviceName, ServiceStatus& status)
+{
+    // LoadUnit, в отличие от GetUnit, отвечает и для уже выгруженных остановленных юнитов
+    QDBusMessage load = QDBusMessage::createMethodCall(SYSTEMD_SERVICE, SYSTEMD_MANAGER_PATH, SYSTEMD_MANAGER_INTERFACE, "LoadUnit");
+    load << serviceName;
+    QDBusMessage loadReply = systemdBus().call(load);
+    if (loadReply.type() != QDBusMessage::ReplyMessage || loadReply.arguments().isEmpty())
+    {
+        return false;
+    }
+
+    QString path = loadReply.arguments().at(0).value<QDBusObjectPath>().path();
+    QDBusMessage getAll = QDBusMessage::createMethodCall(SYSTEMD_SERVICE, path, DBUS_PROPERTIES_INTERFACE, "GetAll");
+    getAll << QString(SYSTEMD_UNIT_INTERFACE);
+    QDBusMessage reply = systemdBus().call(getAll);
+    if (reply.type() != QDBusMessage::ReplyMessage || reply.arguments().isEmpty())
+    {
+        return false;
+    }
+
+    QVariantMap properties = qdbus_cast<QVariantMap>(reply.arguments().at(0));
+    status = systemdServiceStatus(properties.value("ActiveState").toString(), properties.value("SubState").toString());
+    return true;
+}
+
+bool LinuxServiceControl::callManager(const char* method, const QString& serviceName)
+{
+    QDBusMessage call = QDBusMessage::createMethodCall(SYSTEMD_SERVICE, SYSTEMD_MANAGER_PATH, SYSTEMD_MANAGER_INTERFACE, method);
+    call << serviceName << QString("replace");
+    // Для системной шины polkit может запросить пароль, поэтому разрешаем интерактивную авторизацию
+    call.setInteractiveAuthorizationAllowed(true);
+
+    // Ответ означает, что задание поставлено в очередь, а не что служба уже запущена или остановлена
+    QDBusMessage reply = systemdBus().call(call);
+    return reply.type() == QDBusMessage::ReplyMessage;
+}
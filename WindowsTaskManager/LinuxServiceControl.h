@@ -0,0 +1,16 @@
+#pragma once
+
+#include "IServiceControl.h"
+
+class LinuxServiceControl : public IServiceControl
+{
+public:
+    LinuxServiceControl() = default;
+    ~LinuxServiceControl() override = default;
+    bool startService(const QString& serviceName) override;
+    bool stopService(const QString& serviceName) override;
+    bool queryStatus(const QString& serviceName, ServiceStatus& status) override;
+
+private:
+    bool callManager(const char* method, const QString& serviceName);
+};
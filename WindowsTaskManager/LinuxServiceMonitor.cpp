@@ -0,0 +1,200 @@
+﻿#include "LinuxServiceMonitor.h"
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+
+LinuxServiceMonitor::LinuxServiceMonitor(QObject* parent)
+    : QObject(parent)
+{
+}
+
+QList<ServiceInfo> LinuxServiceMonitor::getServices()
+{
+    // Подключение откладывается до первого запроса: к этому моменту объект уже в потоке сбора данных
+    if (!_listed)
+    {
+        _listed = connectToSystemd();
+    }
+
+    QList<ServiceInfo> services;
+    services.reserve(_units.size());
+    for (const auto& unit : _units)
+    {
+        services.append(unit.info);
+    }
+    return services;
+}
+
+bool LinuxServiceMonitor::connectToSystemd()
+{
+    QDBusConnection bus = systemdBus();
+    if (!bus.isConnected())
+    {
+        return false;
+    }
+
+    // Сигналы подключаются до ListUnits, чтобы не потерять изменения между ответом и подпиской
+    if (!_signalsConnected)
+    {
+        bus.connect(SYSTEMD_SERVICE, QString(), DBUS_PROPERTIES_INTERFACE, "PropertiesChanged", this,
+            SLOT(onPropertiesChanged(QString, QVariantMap, QStringList, QDBusMessage)));
+        bus.connect(SYSTEMD_SERVICE, SYSTEMD_MANAGER_PATH, SYSTEMD_MANAGER_INTERFACE, "UnitNew", this,
+            SLOT(onUnitNew(QString, QDBusObjectPath)));
+        bus.connect(SYSTEMD_SERVICE, SYSTEMD_MANAGER_PATH, SYSTEMD_MANAGER_INTERFACE, "UnitRemoved", this,
+            SLOT(onUnitRemoved(QString, QDBusObjectPath)));
+        _signalsConnected = true;
+    }
+
+    // Без Subscribe systemd не рассылает сигналы об изменениях юнитов
+    bus.call(QDBusMessage::createMethodCall(SYSTEMD_SERVICE, SYSTEMD_MANAGER_PATH, SYSTEMD_MANAGER_INTERFACE, "Subscribe"));
+
+    QDBusMessage reply = bus.call(QDBusMessage::createMethodCall(SYSTEMD_SERVICE, SYSTEMD_MANAGER_PATH, SYSTEMD_MANAGER_INTERFACE, "ListUnits"));
+    if (reply.type() != QDBusMessage::ReplyMessage || reply.arguments().isEmpty())
+    {
+        return false;
+    }
+
+    const auto records = qdbus_cast<QList<SystemdUnitRecord>>(reply.arguments().at(0));
+    for (const auto& record : records)
+    {
+        if (!record.name.endsWith(".service"))
+        {
+            continue;
+        }
+
+        UnitEntry& unit = addUnit(record.name, record.unitPath.path());
+        unit.info.description = record.description;
+        unit.activeState = record.activeState;
+        unit.subState = record.subState;
+        unit.info.status = systemdServiceStatus(unit.activeState, unit.subState);
+
+        // Тип запуска, PID и путь к программе в ListUnits не входят, дочитываются асинхронно
+        requestProperties(record.name, SYSTEMD_UNIT_INTERFACE);
+        requestProperties(record.name, SYSTEMD_SERVICE_INTERFACE);
+    }
+    return true;
+}
+
+LinuxServiceMonitor::UnitEntry& LinuxServiceMonitor::addUnit(const QString& name, const QString& path)
+{
+    UnitEntry& unit = _units[name];
+    unit.info.name = name;
+    unit.info.status = ssUnknown;
+    unit.path = path;
+    _unitNames.insert(path, name);
+    return unit;
+}
+
+void LinuxServiceMonitor::requestProperties(const QString& name, const QString& interfaceName)
+{
+    auto it = _units.find(name);
+    if (it == _units.end())
+    {
+        return;
+    }
+
+    QDBusMessage call = QDBusMessage::createMethodCall(SYSTEMD_SERVICE, it->path, DBUS_PROPERTIES_INTERFACE, "GetAll");
+    call << interfaceName;
+    auto* watcher = new QDBusPendingCallWatcher(systemdBus().asyncCall(call), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, name, interfaceName](QDBusPendingCallWatcher* watcher)
+        {
+        QDBusPendingReply<QVariantMap> reply = *watcher;
+        watcher->deleteLater();
+
+        // Юнит мог пропасть, пока шёл ответ
+        auto it = _units.find(name);
+        if (reply.isError() || it == _units.end())
+        {
+            return;
+        }
+        applyProperties(*it, interfaceName, reply.value());
+    });
+}
+
+void LinuxServiceMonitor::applyProperties(UnitEntry& unit, const QString& interfaceName, const QVariantMap& properties)
+{
+    if (interfaceName == SYSTEMD_UNIT_INTERFACE)
+    {
+        if (properties.contains("Description"))
+        {
+            unit.info.description = properties.value("Description").toString();
+        }
+        if (properties.contains("ActiveState"))
+        {
+            unit.activeState = properties.value("ActiveState").toString();
+        }
+        if (properties.contains("SubState"))
+        {
+            unit.subState = properties.value("SubState").toString();
+        }
+        if (properties.contains("UnitFileState"))
+        {
+            unit.info.startType = systemdStartType(properties.value("UnitFileState").toString());
+        }
+        if (properties.contains("Requires") || properties.contains("BindsTo"))
+        {
+            // Зависимостями считаем жёсткие связи: остановка такой службы останавливает и зависящие от неё
+            unit.info.dependencies.clear();
+            QStringList required = properties.value("Requires").toStringList() + properties.value("BindsTo").toStringList();
+            for (const QString& name : required)
+            {
+                if (name.endsWith(".service") && !unit.info.dependencies.contains(name))
+                {
+                    unit.info.dependencies.append(name);
+                }
+            }
+        }
+        unit.info.status = systemdServiceStatus(unit.activeState, unit.subState);
+    }
+    else if (interfaceName == SYSTEMD_SERVICE_INTERFACE)
+    {
+        if (properties.contains("MainPID"))
+        {
+            unit.info.processId = properties.value("MainPID").toUInt();
+        }
+        if (properties.contains("ExecStart"))
+        {
+            const auto commands = qdbus_cast<QList<SystemdExecCommand>>(properties.value("ExecStart").value<QDBusArgument>());
+            unit.info.binaryPath = commands.isEmpty() ? QString() : commands.first().path;
+        }
+    }
+}
+
+void LinuxServiceMonitor::onPropertiesChanged(const QString& interfaceName, const QVariantMap& changed, const QStringList& invalidated,
+    const QDBusMessage& message)
+{
+    auto name = _unitNames.constFind(message.path());
+    if (name == _unitNames.constEnd())
+    {
+        return;
+    }
+    auto it = _units.find(*name);
+    if (it == _units.end())
+    {
+        return;
+    }
+
+    applyProperties(*it, interfaceName, changed);
+
+    // Часть свойств systemd только объявляет устаревшими, их значения запрашиваются отдельно
+    if (!invalidated.isEmpty())
+    {
+        requestProperties(*name, interfaceName);
+    }
+}
+
+void LinuxServiceMonitor::onUnitNew(const QString& name, const QDBusObjectPath& path)
+{
+    if (!name.endsWith(".service") || _units.contains(name))
+    {
+        return;
+    }
+    addUnit(name, path.path());
+    requestProperties(name, SYSTEMD_UNIT_INTERFACE);
+    requestProperties(name, SYSTEMD_SERVICE_INTERFACE);
+}
+
+void LinuxServiceMonitor::onUnitRemoved(const QString& name, const QDBusObjectPath& path)
+{
+    _unitNames.remove(path.path());
+    _units.remove(name);
+}
@@ -0,0 +1,44 @@
+﻿#pragma once
+
+#include "IServiceMonitor.h"
+#include "LinuxSystemd.h"
+#include <QObject>
+#include <QMap>
+#include <QHash>
+#include <QDBusMessage>
+
+// Службы systemd: список юнитов читается один раз, дальше он поддерживается сигналами PropertiesChanged,
+// UnitNew и UnitRemoved. Сигналы обрабатываются в потоке объекта, поэтому он должен жить в потоке сбора данных
+class LinuxServiceMonitor : public QObject, public IServiceMonitor
+{
+    Q_OBJECT
+
+public:
+    explicit LinuxServiceMonitor(QObject* parent = nullptr);
+    ~LinuxServiceMonitor() override = default;
+    QList<ServiceInfo> getServices() override;
+
+private slots:
+    void onPropertiesChanged(const QString& interfaceName, const QVariantMap& changed, const QStringList& invalidated, const QDBusMessage& message);
+    void onUnitNew(const QString& name, const QDBusObjectPath& path);
+    void onUnitRemoved(const QString& name, const QDBusObjectPath& path);
+
+private:
+    struct UnitEntry
+    {
+        ServiceInfo info;
+        QString path;
+        QString activeState;
+        QString subState;
+    };
+
+    bool connectToSystemd();
+    UnitEntry& addUnit(const QString& name, const QString& path);
+    void requestProperties(const QString& name, const QString& interfaceName);
+    void applyProperties(UnitEntry& unit, const QString& interfaceName, const QVariantMap& properties);
+
+    bool _signalsConnected = false;
+    bool _listed = false;
+    QMap<QString, UnitEntry> _units;
+    QHash<QString, QString> _unitNames;    // путь объекта -> имя юнита
+};
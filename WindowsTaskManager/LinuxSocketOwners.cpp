@@ -0,0 +1,164 @@
+﻿#include "LinuxSocketOwners.h"
+#include "LinuxProcFs.h"
+
+#include <QDir>
+#include <QFile>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <dirent.h>
+#include <unistd.h>
+
+SocketOwnerIndex::SocketOwnerIndex(const QString& rootPath)
+    : _procPath(rootPath)
+{
+    while (_procPath.endsWith('/'))
+    {
+        _procPath.chop(1);
+    }
+    _procPath += "/proc";
+}
+
+void SocketOwnerIndex::forgetProcess(quint32 pid)
+{
+    auto it = _processSockets.find(pid);
+    if (it == _processSockets.end())
+    {
+        return;
+    }
+
+    for (quint64 inode : it->inodes)
+    {
+        auto owner = _owners.find(inode);
+        if (owner != _owners.end() && owner.value() == pid)
+        {
+            _owners.erase(owner);
+        }
+    }
+    _processSockets.erase(it);
+}
+
+void SocketOwnerIndex::scanProcessSockets(quint32 pid, quint64 startTime)
+{
+    ProcessSockets& sockets = _processSockets[pid];
+    sockets.startTime = startTime;
+    sockets.inodes.clear();
+
+    // Без root доступны только дескрипторы своих процессов
+    QByteArray path = QFile::encodeName(_procPath) + '/' + QByteArray::number(pid) + "/fd";
+    DIR* dir = opendir(path.constData());
+    if (!dir)
+    {
+        return;
+    }
+
+    // Ссылка на сокет выглядит как "socket:[12345]"
+    static const char SOCKET_PREFIX[] = "socket:[";
+    char target[64];
+    while (dirent* entry = readdir(dir))
+    {
+        if (entry->d_name[0] == '.')
+        {
+            continue;
+        }
+
+        ssize_t length = readlinkat(dirfd(dir), entry->d_name, target, sizeof(target) - 1);
+        if (length <= static_cast<ssize_t>(sizeof(SOCKET_PREFIX) - 1) || strncmp(target, SOCKET_PREFIX, sizeof(SOCKET_PREFIX) - 1) != 0)
+        {
+            continue;
+        }
+        target[length] = '\0';
+
+        quint64 inode = strtoull(target + sizeof(SOCKET_PREFIX) - 1, nullptr, 10);
+        sockets.inodes.append(inode);
+        _owners.insert(inode, pid);
+    }
+
+    closedir(dir);
+}
+
+void SocketOwnerIndex::update(const QSet<quint64>& liveInodes)
+{
+    bool hasUnknown = false;
+    for (quint64 inode : liveInodes)
+    {
+        if (!_owners.contains(inode) && !_unresolvedInodes.contains(inode))
+        {
+            hasUnknown = true;
+            break;
+        }
+    }
+    _unresolvedInodes.intersect(liveInodes);
+
+    // Все сокеты уже известны - /proc не трогаем
+    if (!hasUnknown)
+    {
+        return;
+    }
+
+    // Сначала только новые процессы и процессы с переиспользованным PID
+    QSet<quint32> alivePids;
+    const QStringList entries = QDir(_procPath).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString& entry : entries)
+    {
+        bool isPid = false;
+        quint32 pid = entry.toUInt(&isPid);
+        if (!isPid)
+        {
+            continue;
+        }
+        alivePids.insert(pid);
+
+        quint64 startTime = readProcessStartTime(pid, _procPath);
+        auto known = _processSockets.constFind(pid);
+        if (known == _processSockets.constEnd() || known->startTime != startTime)
+        {
+            forgetProcess(pid);
+            scanProcessSockets(pid, startTime);
+        }
+    }
+
+    const QList<quint32> indexedPids = _processSockets.keys();
+    for (quint32 pid : indexedPids)
+    {
+        if (!alivePids.contains(pid))
+        {
+            forgetProcess(pid);
+        }
+    }
+
+    // Сокет мог открыть уже известный процесс - тогда нужен полный обход, но не чаще FULL_RESCAN_INTERVAL_MS
+    QList<quint64> unknownInodes;
+    for (quint64 inode : liveInodes)
+    {
+        if (!_owners.contains(inode))
+        {
+            unknownInodes.append(inode);
+        }
+    }
+    if (!unknownInodes.isEmpty() && (!_fullRescanTimer.isValid() || _fullRescanTimer.elapsed() >= FULL_RESCAN_INTERVAL_MS))
+    {
+        _fullRescanTimer.start();
+        _unresolvedInodes.clear();
+        for (auto it = _processSockets.begin(); it != _processSockets.end(); ++it)
+        {
+            for (quint64 inode : it->inodes)
+            {
+                _owners.remove(inode);
+            }
+        }
+        for (quint32 pid : _processSockets.keys())
+        {
+            scanProcessSockets(pid, _processSockets.value(pid).startTime);
+        }
+
+        unknownInodes.erase(std::remove_if(unknownInodes.begin(), unknownInodes.end(),
+            [this](quint64 inode) { return _owners.contains(inode); }), unknownInodes.end());
+    }
+
+    // Оставшиеся (чужие процессы без прав, уже закрытые) не ищем до следующего полного обхода
+    for (quint64 inode : unknownInodes)
+    {
+        _unresolvedInodes.insert(inode);
+    }
+}
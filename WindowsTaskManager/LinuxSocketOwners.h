@@ -0,0 +1,46 @@
+﻿#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+
+// Индекс inode сокета -> PID владельца по ссылкам /proc/[pid]/fd.
+// Обход /proc выполняется только при появлении неизвестных сокетов и только для новых процессов
+// (или процессов с переиспользованным PID); полный обход ради сокетов, открытых уже известными
+// процессами, - не чаще FULL_RESCAN_INTERVAL_MS. Сокеты, владелец которых не нашёлся (чужие процессы
+// без прав, уже закрытые), до следующего полного обхода не ищутся.
+// Корневой каталог можно подменить копией /proc, чтобы проверять разбор ссылок без настоящих процессов
+class SocketOwnerIndex
+{
+public:
+    explicit SocketOwnerIndex(const QString& rootPath = QString());
+
+    void update(const QSet<quint64>& liveInodes);
+
+    // 0, если владелец неизвестен
+    quint32 owner(quint64 inode) const
+    {
+        return _owners.value(inode, 0);
+    }
+
+private:
+    // Сокеты процесса на момент последнего обхода его дескрипторов
+    struct ProcessSockets
+    {
+        quint64 startTime = 0;
+        QList<quint64> inodes;
+    };
+
+    static constexpr qint64 FULL_RESCAN_INTERVAL_MS = 5000;
+
+    QString _procPath;
+    QHash<quint64, quint32> _owners;
+    QHash<quint32, ProcessSockets> _processSockets;
+    QSet<quint64> _unresolvedInodes;
+    QElapsedTimer _fullRescanTimer;
+
+    void scanProcessSockets(quint32 pid, quint64 startTime);
+    void forgetProcess(quint32 pid);
+};
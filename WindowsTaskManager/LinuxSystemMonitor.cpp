@@ -0,0 +1,378 @@
+﻿#include "LinuxSystemMonitor.h"
+#include "LinuxProcFs.h"
+#include "SpanTracer.h"
+
+#include <QDir>
+#include <QFile>
+#include <QSet>
+#include <unistd.h>
+
+// Строка cpu или cpuN из /proc/stat: user nice system idle iowait irq softirq steal. Простой - idle и iowait
+static bool parseCpuLine(const QByteArray& line, quint64& busy, quint64& total)
+{
+    QList<QByteArray> fields = line.simplified().split(' ');
+    if (fields.size() < 9)
+    {
+        return false;
+    }
+
+    total = 0;
+    for (int i = 1; i <= 8; i++)
+    {
+        total += fields[i].toULongLong();
+    }
+    quint64 idle = fields[4].toULongLong() + fields[5].toULongLong();
+    busy = total - idle;
+    return true;
+}
+
+// Доля занятости за такт по скоростям тиков занятости и всех тиков
+static double busyPercent(const RateTracker<2>::Rates& rates)
+{
+    return rates[1] > 0.0 ? qBound(0.0, rates[0] * 100.0 / rates[1], 100.0) : 0.0;
+}
+
+// "32K", "1024K", "8M" из sysfs
+static quint32 parseCacheSizeKB(const QByteArray& value)
+{
+    QByteArray size = value.trimmed();
+    quint32 multiplier = 1;
+    if (size.endsWith('K'))
+    {
+        size.chop(1);
+    }
+    else if (size.endsWith('M'))
+    {
+        size.chop(1);
+        multiplier = 1024;
+    }
+    return size.toUInt() * multiplier;
+}
+
+static QByteArray readSysFile(const QString& path)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) ? file.readAll().trimmed() : QByteArray();
+}
+
+LinuxSystemMonitor::LinuxSystemMonitor(IDiskMonitor* diskMonitor, INetworkMonitor* networkMonitor, IGPUMonitor* gpuMonitor)
+    : _diskMonitor(diskMonitor), _networkMonitor(networkMonitor), _gpuMonitor(gpuMonitor)
+{
+    long pageSize = sysconf(_SC_PAGESIZE);
+    if (pageSize > 0)
+    {
+        _pageSize = static_cast<quint64>(pageSize);
+    }
+    long ticksPerSecond = sysconf(_SC_CLK_TCK);
+    if (ticksPerSecond > 0)
+    {
+        _ticksPerSecond = ticksPerSecond;
+    }
+    _cpu = readCpuDescription();
+
+    // Запоминаем начальные значения счётчиков, чтобы первый такт уже дал загрузку
+    getSystemLoad();
+    getCpuCoreUsage();
+}
+
+quint32 LinuxSystemMonitor::readCacheSizeKB(int level)
+{
+    // Общий кэш видят несколько процессоров: каждый экземпляр учитывается один раз по списку его процессоров.
+    // L1 данных и команд - отдельные экземпляры, как и в GetLogicalProcessorInformation
+    QSet<QByteArray> seen;
+    quint32 totalKB = 0;
+    QDir cpus("/sys/devices/system/cpu");
+    const QStringList cpuNames = cpus.entryList({ "cpu[0-9]*" }, QDir::Dirs);
+    for (const QString& cpuName : cpuNames)
+    {
+        QDir cache(cpus.filePath(cpuName + "/cache"));
+        const QStringList indexes = cache.entryList({ "index*" }, QDir::Dirs);
+        for (const QString& index : indexes)
+        {
+            QString path = cache.filePath(index);
+            if (readSysFile(path + "/level").toInt() != level)
+            {
+                continue;
+            }
+            QByteArray key = readSysFile(path + "/type") + '/' + readSysFile(path + "/shared_cpu_list");
+            if (seen.contains(key))
+            {
+                continue;
+            }
+            seen.insert(key);
+            totalKB += parseCacheSizeKB(readSysFile(path + "/size"));
+        }
+    }
+    return totalKB;
+}
+
+LinuxSystemMonitor::CpuDescription LinuxSystemMonitor::readCpuDescription()
+{
+    CpuDescription cpu;
+
+    // Ядра - различные пары (physical id, core id), логические процессоры - строки processor
+    QSet<QByteArray> cores;
+    QByteArray physicalId;
+    double mhz = 0.0;
+    QFile cpuinfo("/proc/cpuinfo");
+    if (cpuinfo.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        while (!cpuinfo.atEnd())
+        {
+            QByteArray line = cpuinfo.readLine();
+            int colon = line.indexOf(':');
+            if (colon < 0)
+            {
+                continue;
+            }
+            QByteArray key = line.left(colon).trimmed();
+            QByteArray value = line.mid(colon + 1).trimmed();
+            if (key == "processor")
+            {
+                cpu.logicalProcessorCount++;
+            }
+            else if (key == "physical id")
+            {
+                physicalId = value;
+            }
+            else if (key == "core id")
+            {
+                cores.insert(physicalId + ':' + value);
+            }
+            else if (key == "cpu MHz" && mhz == 0.0)
+            {
+                mhz = value.toDouble();
+            }
+        }
+    }
+    // Без core id (часть ARM и виртуальных машин) считаем каждый логический процессор ядром
+    cpu.coreCount = cores.isEmpty() ? cpu.logicalProcessorCount : static_cast<quint32>(cores.size());
+
+    // Базовая частота есть у intel_pstate и amd-pstate, иначе берётся максимальная; в cpuinfo - текущая
+    QByteArray baseKHz = readSysFile("/sys/devices/system/cpu/cpu0/cpufreq/base_frequency");
+    if (baseKHz.isEmpty())
+    {
+        baseKHz = readSysFile("/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq");
+    }
+    cpu.baseSpeedGHz = !baseKHz.isEmpty() ? baseKHz.toDouble() / 1000000.0 : mhz / 1000.0;
+
+    cpu.cacheL1KB = readCacheSizeKB(1);
+    cpu.cacheL2KB = readCacheSizeKB(2);
+    cpu.cacheL3KB = readCacheSizeKB(3);
+    return cpu;
+}
+
+SystemInfo LinuxSystemMonitor::getSystemLoad()
+{
+    SystemInfo info = {};
+
+    // CPU
+    QFile stat("/proc/stat");
+    if (stat.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        quint64 busy = 0, total = 0;
+        if (parseCpuLine(stat.readLine(), busy, total))
+        {
+            RateTracker<2>::Rates rates;
+            _cpuRates.beginSample();
+            _cpuRates.update(0, 0, { busy, total }, rates);
+            info.cpuUsage = busyPercent(rates);
+        }
+    }
+
+    // Memory: MemAvailable учитывает освобождаемый кэш страниц, в отличие от MemFree
+    QFile meminfo("/proc/meminfo");
+    if (meminfo.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        while (!meminfo.atEnd())
+        {
+            QByteArray line = meminfo.readLine();
+            if (line.startsWith("MemTotal:"))
+            {
+                info.totalMemory = line.mid(9).trimmed().split(' ').value(0).toULongLong() * 1024;
+            }
+            else if (line.startsWith("MemAvailable:"))
+            {
+                info.availableMemory = line.mid(13).trimmed().split(' ').value(0).toULongLong() * 1024;
+            }
+        }
+        info.usedMemory = info.totalMemory > info.availableMemory ? info.totalMemory - info.availableMemory : 0;
+    }
+
+    return info;
+}
+
+void LinuxSystemMonitor::countProcesses(quint32& processCount, quint32& threadCount)
+{
+    processCount = 0;
+    const QStringList entries = QDir("/proc").entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString& entry : entries)
+    {
+        bool isPid = false;
+        entry.toUInt(&isPid);
+        if (isPid)
+        {
+            processCount++;
+        }
+    }
+
+    // Четвёртое поле loadavg - "выполняемые/всего" потоков планировщика, без обхода /proc/[pid]/task
+    threadCount = 0;
+    QFile loadavg("/proc/loadavg");
+    if (loadavg.open(QIODevice::ReadOnly))
+    {
+        QList<QByteArray> fields = loadavg.readAll().split(' ');
+        threadCount = fields.value(3).split('/').value(1).toUInt();
+    }
+}
+
+SystemInfo LinuxSystemMonitor::getSystemInfo()
+{
+    SystemInfo info = getSystemLoad();
+
+    info.baseSpeedGHz = _cpu.baseSpeedGHz;
+    info.coreCount = _cpu.coreCount;
+    info.logicalProcessorCount = _cpu.logicalProcessorCount;
+    info.cacheL1KB = _cpu.cacheL1KB;
+    info.cacheL2KB = _cpu.cacheL2KB;
+    info.cacheL3KB = _cpu.cacheL3KB;
+    countProcesses(info.processCount, info.threadCount);
+
+    return info;
+}
+
+QList<double> LinuxSystemMonitor::getCpuCoreUsage()
+{
+    QList<double> coreUsage;
+
+    QFile stat("/proc/stat");
+    if (!stat.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        return coreUsage;
+    }
+
+    // Отключённые процессоры в /proc/stat не попадают, номер ядра берётся из имени строки
+    _coreRates.beginSample();
+    while (!stat.atEnd())
+    {
+        QByteArray line = stat.readLine();
+        if (!line.startsWith("cpu"))
+        {
+            break;
+        }
+        bool isCore = false;
+        quint32 core = line.mid(3, line.indexOf(' ') - 3).toUInt(&isCore);
+        quint64 busy = 0, total = 0;
+        if (!isCore || !parseCpuLine(line, busy, total))
+        {
+            continue;
+        }
+
+        RateTracker<2>::Rates rates;
+        _coreRates.update(core, 0, { busy, total }, rates);
+        while (coreUsage.size() < static_cast<qsizetype>(core))
+        {
+            coreUsage.append(0.0);
+        }
+        coreUsage.append(busyPercent(rates));
+    }
+    _coreRates.endSample();
+
+    return coreUsage;
+}
+
+QList<ProcessInfo> LinuxSystemMonitor::getProcesses(bool withDiskInfo, bool withGPUInfo, bool withNetworkInfo)
+{
+    QList<ProcessInfo> processes;
+
+    // Получаем статистику диска
+    QMap<quint32, ProcessDiskInfo> processDiskInfo;
+    if (withDiskInfo)
+    {
+        TRACE_SCOPE("collect.processes.disk");
+        processDiskInfo = _diskMonitor->getProcessDiskInfo();
+    }
+
+    // Получаем статистику GPU
+    QMap<quint32, ProcessGPUInfo> processGPUInfo;
+    if (withGPUInfo)
+    {
+        TRACE_SCOPE("collect.processes.gpu");
+        processGPUInfo = _gpuMonitor->getProcessGPUInfo();
+    }
+
+    // Получаем сетевой трафик
+    QMap<quint32, ProcessNetworkInfo> processNetworkInfo;
+    if (withNetworkInfo)
+    {
+        TRACE_SCOPE("collect.processes.network");
+        processNetworkInfo = _networkMonitor->getProcessNetworkInfo();
+    }
+
+    const QStringList entries = QDir("/proc").entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    processes.reserve(entries.size());
+    _processCpuRates.beginSample();
+
+    for (const QString& entry : entries)
+    {
+        bool isPid = false;
+        quint32 pid = entry.toUInt(&isPid);
+        ProcessStat stat;
+        // Процесс мог завершиться между чтением каталога и чтением stat
+        if (!isPid || !readProcessStat(pid, stat))
+        {
+            continue;
+        }
+
+        ProcessInfo info;
+        info.pid = pid;
+        info.parentPID = stat.parentPID;
+        info.name = stat.name;
+        info.startTime = processStartDateTime(stat.startTime);
+
+        // Memory: statm - "size resident shared ..." в страницах; частная память - резидентная без разделяемой
+        info.workingSetSize = stat.residentPages * _pageSize;
+        QFile statm(QString("/proc/%1/statm").arg(pid));
+        if (statm.open(QIODevice::ReadOnly))
+        {
+            QList<QByteArray> fields = statm.readAll().split(' ');
+            quint64 resident = fields.value(1).toULongLong();
+            quint64 shared = fields.value(2).toULongLong();
+            info.memoryUsage = (resident > shared ? resident - shared : 0) * _pageSize;
+        }
+
+        // CPU Time: тиков в секунду _ticksPerSecond = 100% одного ядра, как и на Windows
+        RateTracker<1>::Rates rates;
+        _processCpuRates.update(pid, stat.startTime, { stat.userTicks + stat.systemTicks }, rates);
+        info.cpuUsage = rates[0] * 100.0 / _ticksPerSecond;
+
+        auto disk = processDiskInfo.constFind(pid);
+        if (disk != processDiskInfo.constEnd())
+        {
+            info.diskReadBytes = static_cast<quint64>(disk->readBytesPerSec);
+            info.diskWriteBytes = static_cast<quint64>(disk->writeBytesPerSec);
+        }
+
+        auto gpu = processGPUInfo.constFind(pid);
+        if (gpu != processGPUInfo.constEnd())
+        {
+            info.gpuUsage = gpu->gpuUtilization;
+            info.gpuMemoryBytes = gpu->gpuMemoryBytes;
+            info.gpuDevices = gpu->devices;
+        }
+
+        auto network = processNetworkInfo.constFind(pid);
+        if (network != processNetworkInfo.constEnd())
+        {
+            info.networkReceiveBytesPerSec = network->receiveBytesPerSec;
+            info.networkSendBytesPerSec = network->sendBytesPerSec;
+        }
+
+        processes.append(info);
+    }
+
+    // Завершившиеся процессы удаляются из истории счётчиков
+    _processCpuRates.endSample();
+
+    return processes;
+}
@@ -0,0 +1,50 @@
+﻿#pragma once
+
+#include "ISystemMonitor.h"
+#include "IDiskMonitor.h"
+#include "INetworkMonitor.h"
+#include "IGPUMonitor.h"
+#include "RateTracker.h"
+
+// Загрузка ЦП из /proc/stat, память из /proc/meminfo, процессы из /proc/[pid]/stat и statm,
+// описание процессора из /proc/cpuinfo и sysfs
+class LinuxSystemMonitor : public ISystemMonitor
+{
+public:
+    LinuxSystemMonitor(IDiskMonitor* diskMonitor, INetworkMonitor* networkMonitor, IGPUMonitor* gpuMonitor);
+    ~LinuxSystemMonitor() override = default;
+
+    SystemInfo getSystemInfo() override;
+    SystemInfo getSystemLoad() override;
+    QList<double> getCpuCoreUsage() override;
+    QList<ProcessInfo> getProcesses(bool withDiskInfo, bool withGPUInfo, bool withNetworkInfo) override;
+
+private:
+    // Описание процессора не меняется и читается один раз
+    struct CpuDescription
+    {
+        double baseSpeedGHz = 0.0;
+        quint32 coreCount = 0;
+        quint32 logicalProcessorCount = 0;
+        quint32 cacheL1KB = 0;
+        quint32 cacheL2KB = 0;
+        quint32 cacheL3KB = 0;
+    };
+
+    IDiskMonitor* _diskMonitor;
+    INetworkMonitor* _networkMonitor;
+    IGPUMonitor* _gpuMonitor;
+    CpuDescription _cpu;
+    quint64 _pageSize = 4096;
+    long _ticksPerSecond = 100;
+
+    // Тики занятости и всего по строкам cpu и cpuN из /proc/stat
+    RateTracker<2> _cpuRates;
+    RateTracker<2> _coreRates;
+    // Процессорное время процессов (пользователь + ядро, тики)
+    RateTracker<1> _processCpuRates;
+
+    static CpuDescription readCpuDescription();
+    static quint32 readCacheSizeKB(int level);
+    void countProcesses(quint32& processCount, quint32& threadCount);
+};
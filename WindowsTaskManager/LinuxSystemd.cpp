@@ -0,0 +1,148 @@
+﻿#include "LinuxSystemd.h"
+#include "FakeSystemdService.h"
+#include <QDBusMetaType>
+
+QDBusArgument& operator<<(QDBusArgument& argument, const SystemdUnitRecord& unit)
+{
+    argument.beginStructure();
+    argument << unit.name << unit.description << unit.loadState << unit.activeState << unit.subState
+        << unit.following << unit.unitPath << unit.jobId << unit.jobType << unit.jobPath;
+    argument.endStructure();
+    return argument;
+}
+
+const QDBusArgument& operator>>(const QDBusArgument& argument, SystemdUnitRecord& unit)
+{
+    argument.beginStructure();
+    argument >> unit.name >> unit.description >> unit.loadState >> unit.activeState >> unit.subState
+        >> unit.following >> unit.unitPath >> unit.jobId >> unit.jobType >> unit.jobPath;
+    argument.endStructure();
+    return argument;
+}
+
+QDBusArgument& operator<<(QDBusArgument& argument, const SystemdExecCommand& command)
+{
+    argument.beginStructure();
+    argument << command.path << command.arguments << command.ignoreFailure << command.startRealtimeUs << command.startMonotonicUs
+        << command.exitRealtimeUs << command.exitMonotonicUs << command.pid << command.exitCode << command.exitStatus;
+    argument.endStructure();
+    return argument;
+}
+
+const QDBusArgument& operator>>(const QDBusArgument& argument, SystemdExecCommand& command)
+{
+    argument.beginStructure();
+    argument >> command.path >> command.arguments >> command.ignoreFailure >> command.startRealtimeUs >> command.startMonotonicUs
+        >> command.exitRealtimeUs >> command.exitMonotonicUs >> command.pid >> command.exitCode >> command.exitStatus;
+    argument.endStructure();
+    return argument;
+}
+
+static QDBusConnection connectSystemdBus()
+{
+    qDBusRegisterMetaType<SystemdUnitRecord>();
+    qDBusRegisterMetaType<QList<SystemdUnitRecord>>();
+    qDBusRegisterMetaType<SystemdExecCommand>();
+    qDBusRegisterMetaType<QList<SystemdExecCommand>>();
+
+    QString address = qEnvironmentVariable("WINTOP_SYSTEMD_BUS");
+    int fakeUnitCount = qEnvironmentVariableIntValue("WINTOP_FAKE_SYSTEMD");
+    if (address.isEmpty() && fakeUnitCount > 0)
+    {
+        address = FakeSystemdService::start(fakeUnitCount);
+    }
+    if (address.isEmpty())
+    {
+        return QDBusConnection::systemBus();
+    }
+    return QDBusConnection::connectToBus(address, "wintop-systemd");
+}
+
+QDBusConnection systemdBus()
+{
+    // Монитор и управление службами живут в разных потоках, но работают с одним подключением
+    static const QDBusConnection bus = connectSystemdBus();
+    return bus;
+}
+
+QString systemdUnitPath(const QString& unitName)
+{
+    QString path = QString(SYSTEMD_MANAGER_PATH) + "/unit/";
+    if (unitName.isEmpty())
+    {
+        return path + "_";
+    }
+
+    QByteArray name = unitName.toUtf8();
+    for (int i = 0; i < name.size(); i++)
+    {
+        char c = name[i];
+        bool plain = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (i > 0 && c >= '0' && c <= '9');
+        if (plain)
+        {
+            path += QLatin1Char(c);
+        }
+        else
+        {
+            path += QString("_%1").arg(static_cast<quint8>(c), 2, 16, QLatin1Char('0'));
+        }
+    }
+    return path;
+}
+
+ServiceStatus systemdServiceStatus(const QString& activeState, const QString& subState)
+{
+    // SubState службы точнее ActiveState: по нему различаются этапы запуска и остановки
+    if (subState == "running" || subState == "reload" || subState == "exited")
+    {
+        return ssRunning;
+    }
+    if (subState == "condition" || subState.startsWith("start") || subState == "auto-restart")
+    {
+        return ssStartPending;
+    }
+    if (subState.startsWith("stop") || subState.startsWith("final"))
+    {
+        return ssStopPending;
+    }
+    if (subState == "dead" || subState == "failed")
+    {
+        return ssStopped;
+    }
+
+    if (activeState == "active" || activeState == "reloading" || activeState == "refreshing")
+    {
+        return ssRunning;
+    }
+    if (activeState == "activating")
+    {
+        return ssStartPending;
+    }
+    if (activeState == "deactivating")
+    {
+        return ssStopPending;
+    }
+    if (activeState == "inactive" || activeState == "failed")
+    {
+        return ssStopped;
+    }
+    return ssUnknown;
+}
+
+ServiceStartType systemdStartType(const QString& unitFileState)
+{
+    if (unitFileState == "enabled" || unitFileState == "enabled-runtime")
+    {
+        return sstAutomatic;
+    }
+    if (unitFileState == "masked" || unitFileState == "masked-runtime")
+    {
+        return sstDisabled;
+    }
+    if (unitFileState == "disabled" || unitFileState == "static" || unitFileState == "indirect" || unitFileState == "linked" ||
+        unitFileState == "linked-runtime" || unitFileState == "alias" || unitFileState == "generated" || unitFileState == "transient")
+    {
+        return sstManual;
+    }
+    return sstUnknown;
+}
@@ -0,0 +1,62 @@
+﻿#pragma once
+
+#include "DataStructs.h"
+#include <QDBusConnection>
+#include <QDBusArgument>
+#include <QDBusObjectPath>
+#include <QStringList>
+#include <QMetaType>
+
+inline const char* SYSTEMD_SERVICE = "org.freedesktop.systemd1";
+inline const char* SYSTEMD_MANAGER_PATH = "/org/freedesktop/systemd1";
+inline const char* SYSTEMD_MANAGER_INTERFACE = "org.freedesktop.systemd1.Manager";
+inline const char* SYSTEMD_UNIT_INTERFACE = "org.freedesktop.systemd1.Unit";
+inline const char* SYSTEMD_SERVICE_INTERFACE = "org.freedesktop.systemd1.Service";
+inline const char* DBUS_PROPERTIES_INTERFACE = "org.freedesktop.DBus.Properties";
+
+// Элемент ответа Manager.ListUnits, сигнатура (ssssssouso)
+struct SystemdUnitRecord
+{
+    QString name;
+    QString description;
+    QString loadState;
+    QString activeState;
+    QString subState;
+    QString following;
+    QDBusObjectPath unitPath;
+    quint32 jobId = 0;
+    QString jobType;
+    QDBusObjectPath jobPath;
+};
+Q_DECLARE_METATYPE(SystemdUnitRecord)
+
+// Элемент свойства Service.ExecStart, сигнатура (sasbttttuii)
+struct SystemdExecCommand
+{
+    QString path;
+    QStringList arguments;
+    bool ignoreFailure = false;
+    quint64 startRealtimeUs = 0;
+    quint64 startMonotonicUs = 0;
+    quint64 exitRealtimeUs = 0;
+    quint64 exitMonotonicUs = 0;
+    quint32 pid = 0;
+    qint32 exitCode = 0;
+    qint32 exitStatus = 0;
+};
+Q_DECLARE_METATYPE(SystemdExecCommand)
+
+QDBusArgument& operator<<(QDBusArgument& argument, const SystemdUnitRecord& unit);
+const QDBusArgument& operator>>(const QDBusArgument& argument, SystemdUnitRecord& unit);
+QDBusArgument& operator<<(QDBusArgument& argument, const SystemdExecCommand& command);
+const QDBusArgument& operator>>(const QDBusArgument& argument, SystemdExecCommand& command);
+
+// Шина, на которой работает systemd. WINTOP_SYSTEMD_BUS=<адрес> подключает к другой шине,
+// WINTOP_FAKE_SYSTEMD=<число служб> поднимает свой dbus-daemon с подставным systemd
+QDBusConnection systemdBus();
+
+// Путь объекта юнита так же, как его экранирует systemd: всё, кроме [A-Za-z0-9], заменяется на _xx
+QString systemdUnitPath(const QString& unitName);
+
+ServiceStatus systemdServiceStatus(const QString& activeState, const QString& subState);
+ServiceStartType systemdStartType(const QString& unitFileState);
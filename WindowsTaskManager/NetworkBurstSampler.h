@@ -0,0 +1,100 @@
+﻿#pragma once
+
+#include <QtGlobal>
+#include <algorithm>
+#include "DataStructs.h"
+#include "RateTracker.h"
+
+// Сводка частых замеров счётчиков одного адаптера в секундные точки. Скорость считается на каждом
+// коротком интервале, поэтому всплеск длиной в один интервал виден в максимуме, а не размазывается
+// по секунде; средняя - весь прирост счётчика, делённый на всё время точки
+class NetworkBurstSampler
+{
+public:
+    static constexpr qint64 WINDOW_NS = 1000000000;
+
+    void reset()
+    {
+        _hasPrevious = false;
+        startWindow();
+    }
+
+    // Возвращает true и заполняет sample, когда накоплена секунда замеров
+    bool addSample(qint64 timestampNs, quint64 bytesReceived, quint64 bytesSent, NetworkBurstSample& sample)
+    {
+        if (!_hasPrevious || timestampNs <= _previousNs)
+        {
+            _hasPrevious = true;
+            _previousNs = timestampNs;
+            _previousReceived = bytesReceived;
+            _previousSent = bytesSent;
+            return false;
+        }
+
+        qint64 elapsedNs = timestampNs - _previousNs;
+        quint64 received = RateTracker<2>::counterDelta(bytesReceived, _previousReceived, 64);
+        quint64 sent = RateTracker<2>::counterDelta(bytesSent, _previousSent, 64);
+        double receiveRate = received * 1000000000.0 / elapsedNs;
+        double sendRate = sent * 1000000000.0 / elapsedNs;
+
+        if (_samplesCount == 0)
+        {
+            _receiveMin = _receiveMax = receiveRate;
+            _sendMin = _sendMax = sendRate;
+        }
+        else
+        {
+            _receiveMin = std::min(_receiveMin, receiveRate);
+            _receiveMax = std::max(_receiveMax, receiveRate);
+            _sendMin = std::min(_sendMin, sendRate);
+            _sendMax = std::max(_sendMax, sendRate);
+        }
+        _samplesCount++;
+        _windowNs += elapsedNs;
+        _windowReceived += received;
+        _windowSent += sent;
+
+        _previousNs = timestampNs;
+        _previousReceived = bytesReceived;
+        _previousSent = bytesSent;
+
+        if (_windowNs < WINDOW_NS)
+        {
+            return false;
+        }
+
+        sample.durationMs = static_cast<quint32>(_windowNs / 1000000);
+        sample.samplesCount = _samplesCount;
+        sample.receiveMinBytesPerSec = _receiveMin;
+        sample.receiveAvgBytesPerSec = _windowReceived * 1000000000.0 / _windowNs;
+        sample.receiveMaxBytesPerSec = _receiveMax;
+        sample.sendMinBytesPerSec = _sendMin;
+        sample.sendAvgBytesPerSec = _windowSent * 1000000000.0 / _windowNs;
+        sample.sendMaxBytesPerSec = _sendMax;
+        startWindow();
+        return true;
+    }
+
+private:
+    void startWindow()
+    {
+        _samplesCount = 0;
+        _windowNs = 0;
+        _windowReceived = 0;
+        _windowSent = 0;
+    }
+
+    bool _hasPrevious = false;
+    qint64 _previousNs = 0;
+    quint64 _previousReceived = 0;
+    quint64 _previousSent = 0;
+
+    quint32 _samplesCount = 0;
+    qint64 _windowNs = 0;
+    quint64 _windowReceived = 0;
+    quint64 _windowSent = 0;
+    double _receiveMin = 0.0;
+    double _receiveMax = 0.0;
+    double _sendMin = 0.0;
+    double _sendMax = 0.0;
+};
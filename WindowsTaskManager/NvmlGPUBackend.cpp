@@ -0,0 +1,208 @@
+﻿#include "NvmlGPUBackend.h"
+#include <QDateTime>
+#include <algorithm>
+
+NvmlGPUBackend::NvmlGPUBackend()
+{
+    _initialized = nvmlInit() == NVML_SUCCESS;
+}
+
+NvmlGPUBackend::~NvmlGPUBackend()
+{
+    if (_initialized)
+    {
+        nvmlShutdown();
+    }
+}
+
+QList<GPUInfo> NvmlGPUBackend::enumerateDevices()
+{
+    QList<GPUInfo> devices;
+    _devices.clear();
+
+    unsigned int deviceCount = 0;
+    if (!_initialized || nvmlDeviceGetCount(&deviceCount) != NVML_SUCCESS)
+    {
+        return devices;
+    }
+
+    // Версия драйвера общая для всех устройств
+    QString driverVersion;
+    char driver[NVML_SYSTEM_DRIVER_VERSION_BUFFER_SIZE];
+    if (nvmlSystemGetDriverVersion(driver, sizeof(driver)) == NVML_SUCCESS)
+    {
+        driverVersion = driver;
+    }
+
+    for (unsigned int i = 0; i < deviceCount; i++)
+    {
+        nvmlDevice_t device;
+        if (nvmlDeviceGetHandleByIndex(i, &device) != NVML_SUCCESS)
+        {
+            continue;
+        }
+
+        GPUInfo gpu;
+        gpu.vendor = "NVIDIA";
+        gpu.driverVersion = driverVersion;
+
+        char name[NVML_DEVICE_NAME_V2_BUFFER_SIZE];
+        if (nvmlDeviceGetName(device, name, sizeof(name)) == NVML_SUCCESS)
+        {
+            gpu.name = name;
+        }
+
+        nvmlMemory_t memory;
+        if (nvmlDeviceGetMemoryInfo(device, &memory) == NVML_SUCCESS)
+        {
+            gpu.totalMemoryBytes = memory.total;
+            gpu.usedMemoryBytes = memory.used;
+        }
+
+        _devices.push_back(Device{ device, 0 });
+        devices.append(gpu);
+    }
+
+    return devices;
+}
+
+bool NvmlGPUBackend::sampleDevice(int device, GPUInfo& info)
+{
+    if (device < 0 || device >= static_cast<int>(_devices.size()))
+    {
+        return false;
+    }
+    nvmlDevice_t handle = _devices[device].handle;
+
+    // Использование GPU
+    nvmlUtilization_t utilization;
+    if (nvmlDeviceGetUtilizationRates(handle, &utilization) != NVML_SUCCESS)
+    {
+        // Устройство пропало (сброс драйвера, отключение eGPU)
+        return false;
+    }
+    info.usage = utilization.gpu;
+
+    // Информация о памяти
+    nvmlMemory_t memory;
+    if (nvmlDeviceGetMemoryInfo(handle, &memory) == NVML_SUCCESS)
+    {
+        info.usedMemoryBytes = memory.used;
+    }
+
+    // Температура
+    unsigned int temp;
+    if (nvmlDeviceGetTemperature(handle, NVML_TEMPERATURE_GPU, &temp) == NVML_SUCCESS)
+    {
+        info.temperatureCelsius = temp;
+    }
+
+    // Использование мощности
+    unsigned int power;
+    if (nvmlDeviceGetPowerUsage(handle, &power) == NVML_SUCCESS)
+    {
+        info.powerUsage = power / 1000; // В ватты
+    }
+
+    // Скорость вентилятора, у видеокарт с пассивным охлаждением не поддерживается
+    unsigned int fanSpeed;
+    if (nvmlDeviceGetFanSpeed(handle, &fanSpeed) == NVML_SUCCESS)
+    {
+        info.fanSpeed = fanSpeed;
+    }
+
+    return true;
+}
+
+void NvmlGPUBackend::sampleProcesses(int firstDevice, QMap<quint32, ProcessGPUInfo>& processes)
+{
+    for (size_t i = 0; i < _devices.size(); i++)
+    {
+        sampleProcessUtilization(_devices[i], firstDevice + static_cast<int>(i), processes);
+        sampleProcessMemory(_devices[i], firstDevice + static_cast<int>(i), processes);
+    }
+}
+
+void NvmlGPUBackend::sampleProcessUtilization(Device& device, int deviceIndex, QMap<quint32, ProcessGPUInfo>& processes)
+{
+    if (device.lastSeenTimeStamp == 0)
+    {
+        // Без метки NVML отдаёт весь накопленный буфер выборок, для первого такта достаточно последней секунды
+        device.lastSeenTimeStamp = static_cast<unsigned long long>(QDateTime::currentMSecsSinceEpoch() - 1000) * 1000;
+    }
+
+    // Первый вызов без буфера возвращает число выборок новее метки
+    unsigned int samplesCount = 0;
+    nvmlReturn_t result = nvmlDeviceGetProcessUtilization(device.handle, nullptr, &samplesCount, device.lastSeenTimeStamp);
+    if (result != NVML_ERROR_INSUFFICIENT_SIZE || samplesCount == 0)
+    {
+        // NVML_ERROR_NOT_FOUND - новых выборок нет, процессы GPU не использовали
+        return;
+    }
+
+    if (_processSamples.size() < samplesCount)
+    {
+        _processSamples.resize(samplesCount);
+    }
+    if (nvmlDeviceGetProcessUtilization(device.handle, _processSamples.data(), &samplesCount, device.lastSeenTimeStamp) != NVML_SUCCESS)
+    {
+        return;
+    }
+
+    // Выборок одного процесса за такт несколько (драйвер пишет их чаще раза в секунду): усредняем
+    _sampleSums.clear();
+    for (unsigned int i = 0; i < samplesCount; i++)
+    {
+        const auto& sample = _processSamples[i];
+        SampleSums& sums = _sampleSums[sample.pid];
+        sums.sm += sample.smUtil;
+        sums.memory += sample.memUtil;
+        sums.encoder += sample.encUtil;
+        sums.decoder += sample.decUtil;
+        sums.count++;
+        device.lastSeenTimeStamp = std::max(device.lastSeenTimeStamp, sample.timeStamp);
+    }
+
+    for (auto it = _sampleSums.cbegin(); it != _sampleSums.cend(); ++it)
+    {
+        const SampleSums& sums = it.value();
+        ProcessGPUDeviceUsage& usage = processDeviceUsage(processes, it.key(), deviceIndex);
+        usage.smUtilization = static_cast<double>(sums.sm) / sums.count;
+        usage.memoryUtilization = static_cast<double>(sums.memory) / sums.count;
+        usage.encoderUtilization = static_cast<double>(sums.encoder) / sums.count;
+        usage.decoderUtilization = static_cast<double>(sums.decoder) / sums.count;
+    }
+}
+
+void NvmlGPUBackend::sampleProcessMemory(const Device& device, int deviceIndex, QMap<quint32, ProcessGPUInfo>& processes)
+{
+    // Процесс с вычислительным и графическим контекстом есть в обоих списках с одной и той же памятью
+    for (auto query : { nvmlDeviceGetComputeRunningProcesses, nvmlDeviceGetGraphicsRunningProcesses })
+    {
+        unsigned int processCount = static_cast<unsigned int>(_runningProcesses.size());
+        nvmlReturn_t result = query(device.handle, &processCount, _runningProcesses.data());
+        if (result == NVML_ERROR_INSUFFICIENT_SIZE)
+        {
+            // Запас на процессы, запущенные между двумя вызовами
+            _runningProcesses.resize(processCount + 16);
+            processCount = static_cast<unsigned int>(_runningProcesses.size());
+            result = query(device.handle, &processCount, _runningProcesses.data());
+        }
+        if (result != NVML_SUCCESS)
+        {
+            continue;
+        }
+
+        for (unsigned int i = 0; i < processCount; i++)
+        {
+            const auto& process = _runningProcesses[i];
+            // В режиме WDDM память по процессам драйвер не отдаёт
+            if (process.usedGpuMemory == NVML_VALUE_NOT_AVAILABLE)
+            {
+                continue;
+            }
+            ProcessGPUDeviceUsage& usage = processDeviceUsage(processes, process.pid, deviceIndex);
+            usage.memoryBytes = std::max(usage.memoryBytes, static_cast<quint64>(process.usedGpuMemory));
+        }
+    }
+}
@@ -0,0 +1,47 @@
+﻿#pragma once
+
+#include "IGPUBackend.h"
+#include <nvml.h>
+#include <QHash>
+#include <vector>
+
+// Видеокарты NVIDIA через NVML. Библиотека инициализируется один раз на время жизни объекта,
+// дескрипторы устройств получаются при перечислении и дальше не запрашиваются
+class NvmlGPUBackend : public IGPUBackend
+{
+public:
+    NvmlGPUBackend();
+    ~NvmlGPUBackend() override;
+
+    QList<GPUInfo> enumerateDevices() override;
+    bool sampleDevice(int device, GPUInfo& info) override;
+    void sampleProcesses(int firstDevice, QMap<quint32, ProcessGPUInfo>& processes) override;
+
+private:
+    struct Device
+    {
+        nvmlDevice_t handle = nullptr;
+        // Метка времени последней учтённой выборки загрузки процессами (мкс): NVML отдаёт только более новые
+        unsigned long long lastSeenTimeStamp = 0;
+    };
+
+    // Сумма выборок процесса за такт
+    struct SampleSums
+    {
+        quint64 sm = 0;
+        quint64 memory = 0;
+        quint64 encoder = 0;
+        quint64 decoder = 0;
+        quint32 count = 0;
+    };
+
+    bool _initialized = false;
+    std::vector<Device> _devices;
+    // Буферы ответов NVML переиспользуются между тактами и растут только при нехватке места
+    std::vector<nvmlProcessUtilizationSample_t> _processSamples;
+    std::vector<nvmlProcessInfo_t> _runningProcesses;
+    QHash<quint32, SampleSums> _sampleSums;
+
+    void sampleProcessUtilization(Device& device, int deviceIndex, QMap<quint32, ProcessGPUInfo>& processes);
+    void sampleProcessMemory(const Device& device, int deviceIndex, QMap<quint32, ProcessGPUInfo>& processes);
+};
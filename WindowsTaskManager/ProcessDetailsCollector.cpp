@@ -0,0 +1,100 @@
+﻿#include "ProcessDetailsCollector.h"
+#include "AccountNameResolver.h"
+
+ProcessDetailsCollector::ProcessDetailsCollector(IProcessControl* processControl)
+    : _processControl(processControl)
+{
+}
+
+void ProcessDetailsCollector::clear()
+{
+    _cache.clear();
+    _dynamicAge.invalidate();
+}
+
+void ProcessDetailsCollector::fill(QList<ProcessInfo>& processes, quint32 fields)
+{
+    if (fields == 0)
+    {
+        clear();
+        return;
+    }
+
+    const quint32 staticFields = fields & PROCESS_DETAIL_STATIC_FIELDS;
+    const quint32 dynamicFields = fields & ~PROCESS_DETAIL_STATIC_FIELDS;
+    const bool dynamicExpired = dynamicFields && (!_dynamicAge.isValid() || _dynamicAge.hasExpired(DYNAMIC_REFRESH_INTERVAL_MS));
+    if (dynamicExpired)
+    {
+        _dynamicAge.start();
+    }
+
+    // Кэш пересобирается по текущему списку, так что записи завершившихся процессов уходят сами
+    QHash<quint32, CachedDetails> cache;
+    cache.reserve(processes.size());
+    QList<quint32> staticPids;
+    QList<quint32> dynamicPids;
+    for (const auto& process : processes)
+    {
+        qint64 startTimeMs = process.startTime.isValid() ? process.startTime.toMSecsSinceEpoch() : 0;
+        CachedDetails entry = _cache.take(process.pid);
+        if (entry.startTimeMs != startTimeMs)
+        {
+            // PID достался новому процессу
+            entry = CachedDetails();
+            entry.startTimeMs = startTimeMs;
+        }
+        // Поля скрытых колонок не обновлялись, после повторного включения их нужно прочитать заново
+        entry.fields &= fields;
+
+        if (staticFields & ~entry.fields)
+        {
+            staticPids.append(process.pid);
+        }
+        if (dynamicExpired || (dynamicFields & ~entry.fields))
+        {
+            dynamicPids.append(process.pid);
+        }
+        cache.insert(process.pid, entry);
+    }
+    _cache = std::move(cache);
+
+    if (!staticPids.isEmpty())
+    {
+        const QList<ProcessDetails> details = _processControl->getProcessDetails(staticPids, processes, staticFields);
+        for (const auto& processDetails : details)
+        {
+            CachedDetails& entry = _cache[processDetails.pid];
+            entry.path = processDetails.path;
+            entry.commandLine = processDetails.commandLine;
+            entry.userName = processDetails.userName;
+            entry.accountId = processDetails.accountId;
+            entry.fields |= staticFields;
+        }
+    }
+    if (!dynamicPids.isEmpty())
+    {
+        const QList<ProcessDetails> details = _processControl->getProcessDetails(dynamicPids, processes, dynamicFields);
+        for (const auto& processDetails : details)
+        {
+            CachedDetails& entry = _cache[processDetails.pid];
+            entry.threadCount = static_cast<quint32>(processDetails.threadCount);
+            entry.handleCount = processDetails.handleCount;
+            entry.priority = processDetails.priority;
+            entry.fields |= dynamicFields;
+        }
+    }
+
+    for (auto& process : processes)
+    {
+        const CachedDetails& entry = _cache[process.pid];
+        process.detailFields = entry.fields & fields;
+        process.path = entry.path;
+        process.commandLine = entry.commandLine;
+        // Имя берётся заново на каждом такте: фоновый поиск мог завершиться после того, как записан SID
+        process.userName = (fields & pdfUserName) && !entry.accountId.isEmpty()
+            ? AccountNameResolver::instance().accountName(entry.accountId) : entry.userName;
+        process.threadCount = entry.threadCount;
+        process.handleCount = entry.handleCount;
+        process.priority = entry.priority;
+    }
+}
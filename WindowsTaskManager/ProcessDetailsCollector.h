@@ -0,0 +1,40 @@
+﻿#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QElapsedTimer>
+#include "DataStructs.h"
+#include "IProcessControl.h"
+
+// Дополнительные поля процессов для таблицы: собираются только запрошенные. Путь, командная строка и пользователь
+// не меняются за жизнь процесса и берутся из кэша по PID и времени запуска (для пользователя кэшируется SID,
+// имя по нему даёт AccountNameResolver), а число потоков, дескрипторов и приоритет перечитываются реже, чем загрузка ЦП
+class ProcessDetailsCollector
+{
+public:
+    static constexpr qint64 DYNAMIC_REFRESH_INTERVAL_MS = 5000;
+
+    explicit ProcessDetailsCollector(IProcessControl* processControl);
+
+    // fields - маска ProcessDetailField; с пустой маской кэш сбрасывается
+    void fill(QList<ProcessInfo>& processes, quint32 fields);
+    void clear();
+
+private:
+    struct CachedDetails
+    {
+        qint64 startTimeMs = 0;
+        quint32 fields = 0; // уже собранные поля, в том числе те, что прочитать не удалось
+        QString path;
+        QString commandLine;
+        QString userName;
+        QByteArray accountId;
+        quint32 threadCount = 0;
+        quint32 handleCount = 0;
+        ProcessPriority priority = ppUnknown;
+    };
+
+    IProcessControl* _processControl;
+    QHash<quint32, CachedDetails> _cache;
+    QElapsedTimer _dynamicAge;
+};
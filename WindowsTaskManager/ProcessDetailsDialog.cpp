@@ -104,6 +104,10 @@ void ProcessDetailsDialog::setProcessDetails(const ProcessDetails& details)
     auto* pathItem = new QTreeWidgetItem(mainGroup);
     pathItem->setText(0, QString("Путь: %1").arg(details.path));
 
+    auto* commandLineItem = new QTreeWidgetItem(mainGroup);
+    commandLineItem->setText(0, QString("Командная строка: %1").arg(details.commandLine));
+    commandLineItem->setToolTip(0, details.commandLine);
+
     auto* parentItem = new QTreeWidgetItem(mainGroup);
     parentItem->setText(0, QString("Родительский PID: %1").arg(details.parentPID));
 
@@ -1,9 +1,10 @@
 ﻿#include "ProcessTableModel.h"
 #include <QApplication>
 
-const int COLUMNS_COUNT = 7;
+const int COLUMNS_COUNT = 15;
 
-enum ProcessTableColumns { ptcPID, ptcName, ptcCPUUsage, ptcMemoryUsage, ptcDiskReadBytes, ptcDiskWriteBytes, ptcGPUUsage };
+enum ProcessTableColumns { ptcPID, ptcName, ptcCPUUsage, ptcMemoryUsage, ptcDiskReadBytes, ptcDiskWriteBytes, ptcGPUUsage, ptcNetwork,
+    ptcUserName, ptcThreadCount, ptcHandleCount, ptcStartTime, ptcPriority, ptcCommandLine, ptcPath };
 
 ProcessTableModel::ProcessTableModel(QObject* parent)
     : QAbstractTableModel(parent) 
@@ -17,7 +18,26 @@ int ProcessTableModel::rowCount(const QModelIndex& parent) const
 
 int ProcessTableModel::columnCount(const QModelIndex& parent) const 
 {
-    return COLUMNS_COUNT; // PID, Name, CPU, Memory, Disk Read, Disk Write, GPUUsage
+    return COLUMNS_COUNT; // PID, Name, CPU, Memory, Disk Read, Disk Write, GPUUsage, Network + дополнительные
+}
+
+bool ProcessTableModel::isExtendedColumn(int column)
+{
+    return column >= ptcUserName && column < COLUMNS_COUNT;
+}
+
+quint32 ProcessTableModel::columnDetailField(int column)
+{
+    switch (column)
+    {
+    case ptcUserName: return pdfUserName;
+    case ptcThreadCount: return pdfThreadCount;
+    case ptcHandleCount: return pdfHandleCount;
+    case ptcPriority: return pdfPriority;
+    case ptcCommandLine: return pdfCommandLine;
+    case ptcPath: return pdfPath;
+    default: return 0; // время запуска приходит со списком процессов
+    }
 }
 
 static inline int lerp(int a, int b, double t) 
@@ -59,6 +79,13 @@ QVariant ProcessTableModel::data(const QModelIndex& index, int role) const
 
     const auto& proc = _processes[index.row()];
 
+    // Незапрошенные дополнительные поля не собирались, пустая ячейка вместо нулей
+    quint32 detailField = columnDetailField(index.column());
+    if (detailField != 0 && !(proc.detailFields & detailField) && (role == Qt::DisplayRole || role == Qt::UserRole || role == Qt::ToolTipRole))
+    {
+        return QVariant();
+    }
+
     if (role == Qt::DisplayRole) 
     {
         switch (index.column()) 
@@ -70,6 +97,14 @@ QVariant ProcessTableModel::data(const QModelIndex& index, int role) const
         case ptcDiskReadBytes: return QString::number(proc.diskReadBytes / 1024 / 1024) + " MB";
         case ptcDiskWriteBytes: return QString::number(proc.diskWriteBytes / 1024 / 1024) + " MB";
         case ptcGPUUsage: return QString::number(proc.gpuUsage) + "%";
+        case ptcNetwork: return QString::number((proc.networkReceiveBytesPerSec + proc.networkSendBytesPerSec) / 1024, 'f', 1) + " KB/s";
+        case ptcUserName: return proc.userName;
+        case ptcThreadCount: return proc.threadCount;
+        case ptcHandleCount: return proc.handleCount;
+        case ptcStartTime: return proc.startTime.isValid() ? proc.startTime.toString("dd.MM.yyyy hh:mm:ss") : QString();
+        case ptcPriority: return ProcessPriorityString[proc.priority];
+        case ptcCommandLine: return proc.commandLine;
+        case ptcPath: return proc.path;
         default: return QVariant();
         }
     }
@@ -85,10 +120,57 @@ QVariant ProcessTableModel::data(const QModelIndex& index, int role) const
         case ptcDiskReadBytes: return proc.diskReadBytes;
         case ptcDiskWriteBytes: return proc.diskWriteBytes;
         case ptcGPUUsage: return proc.gpuUsage;
+        case ptcNetwork: return proc.networkReceiveBytesPerSec + proc.networkSendBytesPerSec;
+        case ptcUserName: return proc.userName;
+        case ptcThreadCount: return proc.threadCount;
+        case ptcHandleCount: return proc.handleCount;
+        case ptcStartTime: return proc.startTime;
+        case ptcPriority: return static_cast<int>(proc.priority);
+        case ptcCommandLine: return proc.commandLine;
+        case ptcPath: return proc.path;
         default: return QVariant();
         }
     }
 
+    // Процесс-хост показывает размещённые в нём службы
+    if (role == Qt::ToolTipRole && index.column() == ptcName && _serviceGraph)
+    {
+        QStringList services = _serviceGraph->servicesInProcess(proc.pid);
+        if (!services.isEmpty())
+        {
+            return "Службы: " + services.join(", ");
+        }
+    }
+
+    // Командная строка и путь длинные и в колонку обычно не помещаются
+    if (role == Qt::ToolTipRole && (index.column() == ptcCommandLine || index.column() == ptcPath))
+    {
+        return index.column() == ptcCommandLine ? proc.commandLine : proc.path;
+    }
+
+    if (role == Qt::ToolTipRole && index.column() == ptcNetwork)
+    {
+        return QString("Приём: %1 KB/s\nПередача: %2 KB/s")
+            .arg(proc.networkReceiveBytesPerSec / 1024, 0, 'f', 1)
+            .arg(proc.networkSendBytesPerSec / 1024, 0, 'f', 1);
+    }
+
+    if (role == Qt::ToolTipRole && index.column() == ptcGPUUsage && !proc.gpuDevices.isEmpty())
+    {
+        QString toolTip = QString("Видеопамять: %1 MB").arg(proc.gpuMemoryBytes / 1024 / 1024);
+        for (const auto& usage : proc.gpuDevices)
+        {
+            toolTip += QString("\nGPU %1: SM %2%, память %3%, кодер %4%, декодер %5%, %6 MB")
+                .arg(usage.device)
+                .arg(usage.smUtilization, 0, 'f', 0)
+                .arg(usage.memoryUtilization, 0, 'f', 0)
+                .arg(usage.encoderUtilization, 0, 'f', 0)
+                .arg(usage.decoderUtilization, 0, 'f', 0)
+                .arg(usage.memoryBytes / 1024 / 1024);
+        }
+        return toolTip;
+    }
+
     if (role == Qt::DecorationRole && index.column() == 1) 
     { // колонка с именем
         if (_processControl) {
@@ -131,6 +213,10 @@ QVariant ProcessTableModel::data(const QModelIndex& index, int role) const
             value = proc.gpuUsage;
             break;
 
+        case 7: // Сеть, 100% = 100 МБ/с
+            value = (proc.networkReceiveBytesPerSec + proc.networkSendBytesPerSec) / 1024.0 / 1024.0;
+            break;
+
         default:
             return QVariant(); // для других колонок не рисуем цвет
         }
@@ -155,6 +241,14 @@ QVariant ProcessTableModel::headerData(int section, Qt::Orientation orientation,
         case ptcDiskReadBytes: return "Disk Read (MB)";
         case ptcDiskWriteBytes: return "Disk Write (MB)";
         case ptcGPUUsage: return "GPU %";
+        case ptcNetwork: return "Network (KB/s)";
+        case ptcUserName: return "User";
+        case ptcThreadCount: return "Threads";
+        case ptcHandleCount: return "Handles";
+        case ptcStartTime: return "Start time";
+        case ptcPriority: return "Priority";
+        case ptcCommandLine: return "Command line";
+        case ptcPath: return "Path";
         default: return QVariant();
         }
     }
@@ -175,6 +269,23 @@ void ProcessTableModel::setProcessControl(IProcessControl* control)
     _processControl = control;
 }
 
+void ProcessTableModel::setServiceGraph(const ServiceDependencyGraph* graph)
+{
+    _serviceGraph = graph;
+}
+
+int ProcessTableModel::rowOfProcess(quint32 pid) const
+{
+    for (int row = 0; row < _processes.size(); row++)
+    {
+        if (_processes[row].pid == pid)
+        {
+            return row;
+        }
+    }
+    return -1;
+}
+
 void ProcessTableModel::updateData(const QList<ProcessInfo>& data) 
 {
     beginResetModel();
@@ -211,7 +322,19 @@ void ProcessTableModel::updateDataPartial(const QList<ProcessInfo>& newData)
 
             if (_processes[i].cpuUsage != newProc.cpuUsage ||
                 _processes[i].memoryUsage != newProc.memoryUsage ||
-                _processes[i].name != newProc.name)
+                _processes[i].gpuUsage != newProc.gpuUsage ||
+                _processes[i].gpuMemoryBytes != newProc.gpuMemoryBytes ||
+                _processes[i].networkReceiveBytesPerSec != newProc.networkReceiveBytesPerSec ||
+                _processes[i].networkSendBytesPerSec != newProc.networkSendBytesPerSec ||
+                _processes[i].name != newProc.name ||
+                _processes[i].detailFields != newProc.detailFields ||
+                _processes[i].threadCount != newProc.threadCount ||
+                _processes[i].handleCount != newProc.handleCount ||
+                _processes[i].priority != newProc.priority ||
+                _processes[i].startTime != newProc.startTime ||
+                _processes[i].userName != newProc.userName ||
+                _processes[i].commandLine != newProc.commandLine ||
+                _processes[i].path != newProc.path)
             {
                 changed = true;
             }
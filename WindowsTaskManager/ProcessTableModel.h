@@ -4,6 +4,7 @@
 #include <QList>
 #include "DataStructs.h"
 #include <IProcessControl.h>
+#include "ServiceDependencyGraph.h"
 
 class ProcessTableModel : public QAbstractTableModel
 {
@@ -19,6 +20,13 @@ public:
     ProcessInfo getProcessByRow(int row) const;
 
     void setProcessControl(IProcessControl* controller);
+    void setServiceGraph(const ServiceDependencyGraph* graph);
+    int rowOfProcess(quint32 pid) const;
+
+    // Дополнительные колонки (пользователь, потоки, путь и т.п.) скрыты по умолчанию и собираются, только пока видны
+    static bool isExtendedColumn(int column);
+    // Поле ProcessDetailField, которое нужно собирать для колонки, или 0
+    static quint32 columnDetailField(int column);
 
     void updateDataPartial(const QList<ProcessInfo>& newData);
 
@@ -27,6 +35,7 @@ public:
 private:
     QList<ProcessInfo> _processes;
     IProcessControl* _processControl = nullptr;
+    const ServiceDependencyGraph* _serviceGraph = nullptr;
     mutable QHash<quint32, QIcon> _iconCache;
 };
 
@@ -24,6 +24,11 @@ void ProcessTreeModel::setProcessControl(IProcessControl* controller)
     _processControl = controller;
 }
 
+void ProcessTreeModel::setServiceGraph(const ServiceDependencyGraph* graph)
+{
+    _serviceGraph = graph;
+}
+
 QList<QStandardItem*> ProcessTreeModel::createTreeRow(const ProcessInfo& processInfo)
 {
     QList<QStandardItem*> treeRow(COLUMNS_COUNT);
@@ -179,6 +184,16 @@ QVariant ProcessTreeModel::data(const QModelIndex& index, int role) const
         return QStandardItemModel::data(index, role);
     }
 
+    // Процесс-хост показывает размещённые в нём службы
+    if (role == Qt::ToolTipRole && index.column() == tcName && _serviceGraph)
+    {
+        QStringList services = _serviceGraph->servicesInProcess(QStandardItemModel::data(index, Qt::UserRole + 1).toUInt());
+        if (!services.isEmpty())
+        {
+            return "Службы: " + services.join(", ");
+        }
+    }
+
     if (role == Qt::UserRole) 
     {
         QModelIndex nameIndex = index.siblingAtColumn(0);
@@ -4,6 +4,7 @@
 #include <memory>
 #include "IProcessTreeBuilder.h"
 #include <IProcessControl.h>
+#include "ServiceDependencyGraph.h"
 #include <QHash>
 
 struct ProcessItemRow 
@@ -32,6 +33,7 @@ public:
 
     void setTreeBuilder(std::unique_ptr<IProcessTreeBuilder> builder);
     void setProcessControl(IProcessControl* controller);
+    void setServiceGraph(const ServiceDependencyGraph* graph);
     void updateData(const QList<ProcessInfo>& data);
     QVariant data(const QModelIndex& index, int role) const;
 private:
@@ -42,6 +44,7 @@ private:
     QList<FlatProcessNode> _currentFlatTree;
 
     IProcessControl* _processControl = nullptr;
+    const ServiceDependencyGraph* _serviceGraph = nullptr;
     QHash<quint32, QIcon> _iconCache;
 
     void updateTreeFromNewFlatList(const QList<FlatProcessNode>& newTree);
@@ -0,0 +1,14 @@
+#include "ProfiledChartView.h"
+#include "SelfProfiler.h"
+
+ProfiledChartView::ProfiledChartView(QChart* chart, const char* stageName, QWidget* parent)
+    : QChartView(chart, parent)
+{
+    _stageId = SelfProfiler::instance().registerStage(stageName);
+}
+
+void ProfiledChartView::paintEvent(QPaintEvent* event)
+{
+    ScopedStageTimer timer(_stageId);
+    QChartView::paintEvent(event);
+}
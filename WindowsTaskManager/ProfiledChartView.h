@@ -0,0 +1,16 @@
+﻿#pragma once
+
+#include <QtCharts/QChartView>
+
+// QChartView, замеряющий стоимость каждой отрисовки кадра в SelfProfiler
+class ProfiledChartView : public QChartView
+{
+public:
+    ProfiledChartView(QChart* chart, const char* stageName, QWidget* parent = nullptr);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    int _stageId;
+};
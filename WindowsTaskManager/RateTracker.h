@@ -0,0 +1,117 @@
+﻿#pragma once
+
+#include <QHash>
+#include <QElapsedTimer>
+#include <array>
+
+// Скорости по монотонным счётчикам для набора объектов: процессов, сетевых интерфейсов, соединений.
+// Объект задаётся идентификатором и экземпляром - у процесса это PID и время запуска, поэтому
+// переиспользованный системой PID считается новым процессом. Для впервые увиденного объекта скорость
+// не выдаётся (иначе весь накопленный счётчик попал бы в одну секунду), а объекты, не обновлённые
+// за такт, удаляются в endSample()
+template <int N>
+class RateTracker
+{
+public:
+    using Counters = std::array<quint64, N>;
+    using Rates = std::array<double, N>;
+
+    RateTracker()
+    {
+        _clock.start();
+    }
+
+    // Начинает такт по монотонным часам
+    void beginSample()
+    {
+        beginSample(_clock.nsecsElapsed());
+    }
+
+    // Такт с явной меткой времени в наносекундах, например для воспроизведения записанных счётчиков
+    void beginSample(qint64 timestampNs)
+    {
+        _sampleNs = timestampNs;
+        _generation++;
+    }
+
+    // Возвращает false, если скорость ещё не определена (новый объект или повторный вызов в том же такте).
+    // counterBits - разрядность счётчиков источника: у 32-битных уменьшение считается переполнением
+    bool update(quint64 id, quint64 instance, const Counters& counters, Rates& rates, int counterBits = 64)
+    {
+        rates.fill(0.0);
+
+        Entry& entry = _entries[id];
+        bool known = entry.generation != 0 && entry.instance == instance && _sampleNs > entry.sampleNs;
+        if (known)
+        {
+            double elapsedSec = (_sampleNs - entry.sampleNs) / 1000000000.0;
+            for (int i = 0; i < N; i++)
+            {
+                rates[i] = counterDelta(counters[i], entry.counters[i], counterBits) / elapsedSec;
+            }
+        }
+
+        entry.instance = instance;
+        entry.counters = counters;
+        entry.sampleNs = _sampleNs;
+        entry.generation = _generation;
+        return known;
+    }
+
+    // Удаляет объекты, которые не обновлялись в текущем такте (завершённые процессы, отключённые интерфейсы)
+    void endSample()
+    {
+        for (auto it = _entries.begin(); it != _entries.end();)
+        {
+            if (it->generation != _generation)
+            {
+                it = _entries.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    int size() const
+    {
+        return static_cast<int>(_entries.size());
+    }
+
+    void clear()
+    {
+        _entries.clear();
+    }
+
+    // Прирост счётчика с учётом одного переполнения. 64-битный счётчик за интервал опроса переполниться
+    // не может, поэтому его уменьшение - это сброс, и интервал даёт ноль
+    static quint64 counterDelta(quint64 current, quint64 previous, int counterBits)
+    {
+        if (current >= previous)
+        {
+            return current - previous;
+        }
+        if (counterBits >= 64)
+        {
+            return 0;
+        }
+
+        quint64 modulus = 1ULL << counterBits;
+        return previous < modulus ? modulus - previous + current : 0;
+    }
+
+private:
+    struct Entry
+    {
+        quint64 instance = 0;
+        Counters counters{};
+        qint64 sampleNs = 0;
+        quint64 generation = 0;
+    };
+
+    QHash<quint64, Entry> _entries;
+    QElapsedTimer _clock;
+    qint64 _sampleNs = 0;
+    quint64 _generation = 0;
+};
@@ -0,0 +1,302 @@
+﻿#include "SelfProfiler.h"
+#include <QMutexLocker>
+#include <cstring>
+#include <algorithm>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+int StageHistogram::bucketFor(quint64 valueUs)
+{
+    if (valueUs < 4)
+    {
+        return static_cast<int>(valueUs);
+    }
+
+    // Номер старшего бита и два следующих за ним бита задают корзину
+    int exponent = 63;
+    while (!(valueUs & (1ULL << exponent)))
+    {
+        exponent--;
+    }
+    int subBucket = static_cast<int>((valueUs >> (exponent - 2)) & 3);
+    int bucket = 4 + (exponent - 2) * 4 + subBucket;
+    return std::min(bucket, BUCKETS_COUNT - 1);
+}
+
+quint64 StageHistogram::bucketUpperBound(int bucket)
+{
+    if (bucket < 4)
+    {
+        return static_cast<quint64>(bucket);
+    }
+
+    int exponent = (bucket - 4) / 4 + 2;
+    int subBucket = (bucket - 4) % 4;
+    quint64 lower = static_cast<quint64>(4 + subBucket) << (exponent - 2);
+    return lower + (1ULL << (exponent - 2)) - 1;
+}
+
+void StageHistogram::record(quint64 valueUs)
+{
+    _buckets[bucketFor(valueUs)].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    _sum.fetch_add(valueUs, std::memory_order_relaxed);
+
+    quint64 currentMax = _max.load(std::memory_order_relaxed);
+    while (valueUs > currentMax && !_max.compare_exchange_weak(currentMax, valueUs, std::memory_order_relaxed))
+    {
+    }
+}
+
+void StageHistogram::reset()
+{
+    for (auto& bucket : _buckets)
+    {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    _count.store(0, std::memory_order_relaxed);
+    _sum.store(0, std::memory_order_relaxed);
+    _max.store(0, std::memory_order_relaxed);
+}
+
+quint64 StageHistogram::count() const
+{
+    return _count.load(std::memory_order_relaxed);
+}
+
+quint64 StageHistogram::max() const
+{
+    return _max.load(std::memory_order_relaxed);
+}
+
+quint64 StageHistogram::sum() const
+{
+    return _sum.load(std::memory_order_relaxed);
+}
+
+double StageHistogram::percentile(double p) const
+{
+    // Считаем по копии корзин, т.к. запись может идти параллельно
+    std::array<quint64, BUCKETS_COUNT> buckets;
+    quint64 total = 0;
+    for (int i = 0; i < BUCKETS_COUNT; i++)
+    {
+        buckets[i] = _buckets[i].load(std::memory_order_relaxed);
+        total += buckets[i];
+    }
+    if (total == 0)
+    {
+        return 0.0;
+    }
+
+    quint64 rank = static_cast<quint64>(p * total);
+    if (rank >= total)
+    {
+        rank = total - 1;
+    }
+
+    quint64 seen = 0;
+    for (int i = 0; i < BUCKETS_COUNT; i++)
+    {
+        seen += buckets[i];
+        if (seen > rank)
+        {
+            return static_cast<double>(std::min(bucketUpperBound(i), max()));
+        }
+    }
+    return static_cast<double>(max());
+}
+
+SelfProfiler& SelfProfiler::instance()
+{
+    static SelfProfiler profiler;
+    return profiler;
+}
+
+int SelfProfiler::registerStage(const char* name)
+{
+    QMutexLocker locker(&_registerMutex);
+
+    int count = _stageCount.load(std::memory_order_acquire);
+    for (int i = 0; i < count; i++)
+    {
+        if (std::strcmp(_stages[i].name.load(std::memory_order_relaxed), name) == 0)
+        {
+            return i;
+        }
+    }
+
+    if (count >= MAX_STAGES)
+    {
+        return -1;
+    }
+
+    _stages[count].name.store(name, std::memory_order_relaxed);
+    _stageCount.store(count + 1, std::memory_order_release);
+    return count;
+}
+
+void SelfProfiler::record(int stageId, quint64 wallUs, quint64 cpuUs)
+{
+    if (stageId < 0 || stageId >= MAX_STAGES)
+    {
+        return;
+    }
+    _stages[stageId].wall.record(wallUs);
+    _stages[stageId].cpu.record(cpuUs);
+}
+
+void SelfProfiler::setEnabled(bool enabled)
+{
+    _enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool SelfProfiler::isEnabled() const
+{
+    return _enabled.load(std::memory_order_relaxed);
+}
+
+QList<StageStats> SelfProfiler::snapshot() const
+{
+    QList<StageStats> result;
+
+    int count = _stageCount.load(std::memory_order_acquire);
+    for (int i = 0; i < count; i++)
+    {
+        const Stage& stage = _stages[i];
+
+        StageStats stats;
+        stats.name = QString::fromUtf8(stage.name.load(std::memory_order_relaxed));
+        stats.count = stage.wall.count();
+        stats.wallP50Us = stage.wall.percentile(0.50);
+        stats.wallP99Us = stage.wall.percentile(0.99);
+        stats.wallMaxUs = stage.wall.max();
+        stats.wallTotalUs = stage.wall.sum();
+        stats.cpuP50Us = stage.cpu.percentile(0.50);
+        stats.cpuP99Us = stage.cpu.percentile(0.99);
+        stats.cpuMaxUs = stage.cpu.max();
+        stats.cpuTotalUs = stage.cpu.sum();
+        result.append(stats);
+    }
+
+    return result;
+}
+
+QString SelfProfiler::dump() const
+{
+    QString text = QString("%1 %2 %3 %4 %5 %6 %7 %8\n")
+        .arg("stage", -32)
+        .arg("count", 8)
+        .arg("wall p50", 10)
+        .arg("wall p99", 10)
+        .arg("wall max", 10)
+        .arg("cpu p50", 10)
+        .arg("cpu p99", 10)
+        .arg("cpu max", 10);
+
+    for (const auto& stats : snapshot())
+    {
+        text += QString("%1 %2 %3 %4 %5 %6 %7 %8\n")
+            .arg(stats.name, -32)
+            .arg(stats.count, 8)
+            .arg(stats.wallP50Us, 10, 'f', 0)
+            .arg(stats.wallP99Us, 10, 'f', 0)
+            .arg(stats.wallMaxUs, 10)
+            .arg(stats.cpuP50Us, 10, 'f', 0)
+            .arg(stats.cpuP99Us, 10, 'f', 0)
+            .arg(stats.cpuMaxUs, 10);
+    }
+
+    return text;
+}
+
+void SelfProfiler::reset()
+{
+    int count = _stageCount.load(std::memory_order_acquire);
+    for (int i = 0; i < count; i++)
+    {
+        _stages[i].wall.reset();
+        _stages[i].cpu.reset();
+    }
+}
+
+quint64 SelfProfiler::threadCpuTimeUs()
+{
+#ifdef Q_OS_WIN
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (!GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime))
+    {
+        return 0;
+    }
+
+    ULARGE_INTEGER kernel, user;
+    kernel.LowPart = kernelTime.dwLowDateTime;
+    kernel.HighPart = kernelTime.dwHighDateTime;
+    user.LowPart = userTime.dwLowDateTime;
+    user.HighPart = userTime.dwHighDateTime;
+
+    // 100нс интервалы -> мкс
+    return (kernel.QuadPart + user.QuadPart) / 10;
+#else
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+    {
+        return 0;
+    }
+    return static_cast<quint64>(ts.tv_sec) * 1000000ULL + static_cast<quint64>(ts.tv_nsec) / 1000;
+#endif
+}
+
+quint64 SelfProfiler::processCpuTimeUs()
+{
+#ifdef Q_OS_WIN
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+    {
+        return 0;
+    }
+
+    ULARGE_INTEGER kernel, user;
+    kernel.LowPart = kernelTime.dwLowDateTime;
+    kernel.HighPart = kernelTime.dwHighDateTime;
+    user.LowPart = userTime.dwLowDateTime;
+    user.HighPart = userTime.dwHighDateTime;
+
+    return (kernel.QuadPart + user.QuadPart) / 10;
+#else
+    timespec ts;
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) != 0)
+    {
+        return 0;
+    }
+    return static_cast<quint64>(ts.tv_sec) * 1000000ULL + static_cast<quint64>(ts.tv_nsec) / 1000;
+#endif
+}
+
+ScopedStageTimer::ScopedStageTimer(int stageId)
+    : _stageId(stageId), _active(stageId >= 0 && SelfProfiler::instance().isEnabled())
+{
+    if (_active)
+    {
+        _wallStart = std::chrono::steady_clock::now();
+        _cpuStart = SelfProfiler::threadCpuTimeUs();
+    }
+}
+
+ScopedStageTimer::~ScopedStageTimer()
+{
+    if (!_active)
+    {
+        return;
+    }
+
+    quint64 cpuEnd = SelfProfiler::threadCpuTimeUs();
+    auto wallEnd = std::chrono::steady_clock::now();
+    quint64 wallUs = static_cast<quint64>(std::chrono::duration_cast<std::chrono::microseconds>(wallEnd - _wallStart).count());
+    quint64 cpuUs = cpuEnd >= _cpuStart ? cpuEnd - _cpuStart : 0;
+    SelfProfiler::instance().record(_stageId, wallUs, cpuUs);
+}
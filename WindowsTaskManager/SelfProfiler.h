@@ -0,0 +1,113 @@
+﻿#pragma once
+
+#include <QString>
+#include <QList>
+#include <QMutex>
+#include <atomic>
+#include <array>
+#include <chrono>
+#include "SpanTracer.h"
+
+// Агрегированная статистика одного этапа (значения в микросекундах)
+struct StageStats
+{
+	QString name;
+	quint64 count = 0;
+	double wallP50Us = 0.0;
+	double wallP99Us = 0.0;
+	quint64 wallMaxUs = 0;
+	double cpuP50Us = 0.0;
+	double cpuP99Us = 0.0;
+	quint64 cpuMaxUs = 0;
+	quint64 wallTotalUs = 0;
+	quint64 cpuTotalUs = 0;
+};
+
+// Гистограмма с логарифмическими корзинами: 4 корзины на каждую степень двойки.
+// Запись - только атомарные инкременты, без блокировок
+class StageHistogram
+{
+public:
+	static constexpr int BUCKETS_COUNT = 128;
+
+	void record(quint64 valueUs);
+	void reset();
+
+	quint64 count() const;
+	quint64 max() const;
+	quint64 sum() const;
+	double percentile(double p) const;
+
+private:
+	static int bucketFor(quint64 valueUs);
+	static quint64 bucketUpperBound(int bucket);
+
+	std::array<std::atomic<quint64>, BUCKETS_COUNT> _buckets{};
+	std::atomic<quint64> _count{ 0 };
+	std::atomic<quint64> _sum{ 0 };
+	std::atomic<quint64> _max{ 0 };
+};
+
+// Реестр этапов самоизмерения (сбор данных, обновление моделей, графиков, отрисовка)
+class SelfProfiler
+{
+public:
+	static SelfProfiler& instance();
+
+	// Регистрация выполняется один раз на точку измерения, повторная регистрация имени возвращает тот же id
+	int registerStage(const char* name);
+	void record(int stageId, quint64 wallUs, quint64 cpuUs);
+
+	void setEnabled(bool enabled);
+	bool isEnabled() const;
+
+	QList<StageStats> snapshot() const;
+	QString dump() const;
+	void reset();
+
+	static quint64 threadCpuTimeUs();
+	static quint64 processCpuTimeUs();
+
+private:
+	SelfProfiler() = default;
+
+	static constexpr int MAX_STAGES = 96;
+
+	struct Stage
+	{
+		std::atomic<const char*> name{ nullptr };
+		StageHistogram wall;
+		StageHistogram cpu;
+	};
+
+	std::array<Stage, MAX_STAGES> _stages;
+	std::atomic<int> _stageCount{ 0 };
+	std::atomic<bool> _enabled{ true };
+	QMutex _registerMutex;
+};
+
+class ScopedStageTimer
+{
+public:
+	explicit ScopedStageTimer(int stageId);
+	~ScopedStageTimer();
+
+	ScopedStageTimer(const ScopedStageTimer&) = delete;
+	ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+private:
+	int _stageId;
+	bool _active;
+	std::chrono::steady_clock::time_point _wallStart;
+	quint64 _cpuStart = 0;
+};
+
+#define SELF_PROFILE_CONCAT_INNER(a, b) a##b
+#define SELF_PROFILE_CONCAT(a, b) SELF_PROFILE_CONCAT_INNER(a, b)
+
+// Замеряет время стены и процессорное время потока до конца текущей области видимости,
+// а при включённой трассировке дополнительно пишет интервал в SpanTracer
+#define SELF_PROFILE_SCOPE(stageName) \
+	static const int SELF_PROFILE_CONCAT(_selfProfileStage, __LINE__) = SelfProfiler::instance().registerStage(stageName); \
+	ScopedStageTimer SELF_PROFILE_CONCAT(_selfProfileTimer, __LINE__)(SELF_PROFILE_CONCAT(_selfProfileStage, __LINE__)); \
+	TRACE_SCOPE(stageName)
@@ -0,0 +1,238 @@
+﻿#include "ServiceDependencyGraph.h"
+#include <QSet>
+#include <algorithm>
+#include <functional>
+
+// Имена служб Windows не различают регистр, и в списках зависимостей он может не совпадать с перечислением
+static QString nodeKey(const QString& name)
+{
+    return name.toLower();
+}
+
+int ServiceDependencyGraph::findNode(const QString& name) const
+{
+    return _index.value(nodeKey(name), -1);
+}
+
+int ServiceDependencyGraph::nodeFor(const QString& name)
+{
+    QString key = nodeKey(name);
+    auto it = _index.constFind(key);
+    if (it != _index.constEnd())
+    {
+        return it.value();
+    }
+
+    // Зависимость может ссылаться на службу, которой ещё нет в снимке: узел создаётся заранее
+    Node node;
+    node.name = name;
+    _nodes.append(node);
+    _index.insert(key, _nodes.size() - 1);
+    return _nodes.size() - 1;
+}
+
+void ServiceDependencyGraph::setDependencies(int node, const QStringList& names)
+{
+    for (int target : _nodes[node].dependsOn)
+    {
+        _nodes[target].dependents.removeOne(node);
+    }
+    _nodes[node].dependsOn.clear();
+    _nodes[node].dependencyNames = names;
+
+    for (const QString& name : names)
+    {
+        int target = nodeFor(name);
+        if (target == node || _nodes[node].dependsOn.contains(target))
+        {
+            continue;
+        }
+        _nodes[node].dependsOn.append(target);
+        _nodes[target].dependents.append(node);
+    }
+}
+
+void ServiceDependencyGraph::setProcessId(int node, quint32 pid)
+{
+    quint32 previous = _nodes[node].processId;
+    if (previous == pid)
+    {
+        return;
+    }
+
+    if (previous != 0)
+    {
+        auto it = _byProcess.find(previous);
+        if (it != _byProcess.end())
+        {
+            it->removeOne(node);
+            if (it->isEmpty())
+            {
+                _byProcess.erase(it);
+            }
+        }
+    }
+    if (pid != 0)
+    {
+        _byProcess[pid].append(node);
+    }
+    _nodes[node].processId = pid;
+}
+
+void ServiceDependencyGraph::update(const QList<ServiceInfo>& services)
+{
+    _generation++;
+    for (const auto& svc : services)
+    {
+        int node = nodeFor(svc.name);
+        // Узел мог быть создан по ссылке из чужого списка зависимостей с другим регистром
+        _nodes[node].name = svc.name;
+        _nodes[node].generation = _generation;
+        _nodes[node].present = true;
+        _nodes[node].status = svc.status;
+        if (_nodes[node].dependencyNames != svc.dependencies)
+        {
+            setDependencies(node, svc.dependencies);
+        }
+        setProcessId(node, svc.processId);
+    }
+
+    // Пропавшие службы теряют свои рёбра и процесс; рёбра к ним от оставшихся служб сохраняются
+    for (int node = 0; node < _nodes.size(); node++)
+    {
+        if (_nodes[node].present && _nodes[node].generation != _generation)
+        {
+            _nodes[node].present = false;
+            _nodes[node].status = ssUnknown;
+            setDependencies(node, QStringList());
+            setProcessId(node, 0);
+        }
+    }
+}
+
+QList<int> ServiceDependencyGraph::collectDependents(int node, bool runningOnly) const
+{
+    QList<int> result;
+    QSet<int> visited{ node };
+    QList<int> queue{ node };
+    for (int i = 0; i < queue.size(); i++)
+    {
+        for (int dependent : _nodes[queue[i]].dependents)
+        {
+            if (visited.contains(dependent))
+            {
+                continue;
+            }
+            visited.insert(dependent);
+            // Остановленная служба не держит свои зависимости, но через неё обход не продолжается
+            if (runningOnly && _nodes[dependent].status == ssStopped)
+            {
+                continue;
+            }
+            result.append(dependent);
+            queue.append(dependent);
+        }
+    }
+    return result;
+}
+
+QStringList ServiceDependencyGraph::dependents(const QString& serviceName, bool runningOnly) const
+{
+    QStringList names;
+    int node = findNode(serviceName);
+    if (node < 0)
+    {
+        return names;
+    }
+    for (int dependent : collectDependents(node, runningOnly))
+    {
+        names.append(_nodes[dependent].name);
+    }
+    return names;
+}
+
+QList<QStringList> ServiceDependencyGraph::stopOrder(const QStringList& serviceNames) const
+{
+    QList<QStringList> waves;
+
+    // Множество останавливаемых: выбранные и все их работающие зависимые
+    QSet<int> stopping;
+    QStringList unknown;
+    for (const QString& name : serviceNames)
+    {
+        int node = findNode(name);
+        if (node < 0)
+        {
+            unknown.append(name);
+            continue;
+        }
+        stopping.insert(node);
+        for (int dependent : collectDependents(node, true))
+        {
+            stopping.insert(dependent);
+        }
+    }
+
+    // Глубина - длина самой длинной цепочки зависимых внутри множества; службы без зависимых останавливаются первыми
+    QHash<int, int> depth;
+    std::function<int(int)> depthOf = [&](int node) -> int
+        {
+        auto it = depth.constFind(node);
+        if (it != depth.constEnd())
+        {
+            return it.value();
+        }
+        depth.insert(node, 0);  // защита от циклов
+        int value = 0;
+        for (int dependent : _nodes[node].dependents)
+        {
+            if (stopping.contains(dependent))
+            {
+                value = std::max(value, depthOf(dependent) + 1);
+            }
+        }
+        depth.insert(node, value);
+        return value;
+    };
+
+    for (int node : stopping)
+    {
+        int level = depthOf(node);
+        while (waves.size() <= level)
+        {
+            waves.append(QStringList());
+        }
+        waves[level].append(_nodes[node].name);
+    }
+    if (!unknown.isEmpty())
+    {
+        if (waves.isEmpty())
+        {
+            waves.append(QStringList());
+        }
+        waves.last().append(unknown);
+    }
+    return waves;
+}
+
+QStringList ServiceDependencyGraph::servicesInProcess(quint32 pid) const
+{
+    QStringList names;
+    auto it = _byProcess.constFind(pid);
+    if (it == _byProcess.constEnd())
+    {
+        return names;
+    }
+    for (int node : it.value())
+    {
+        names.append(_nodes[node].name);
+    }
+    names.sort(Qt::CaseInsensitive);
+    return names;
+}
+
+quint32 ServiceDependencyGraph::processId(const QString& serviceName) const
+{
+    int node = findNode(serviceName);
+    return node < 0 ? 0 : _nodes[node].processId;
+}
@@ -0,0 +1,46 @@
+﻿#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QStringList>
+#include "DataStructs.h"
+
+// Граф зависимостей служб с индексом по процессам. Узлы адресуются номерами, которые не меняются,
+// пока живёт граф; снимок служб меняет только рёбра и привязки тех служб, у которых они разошлись
+class ServiceDependencyGraph
+{
+public:
+    void update(const QList<ServiceInfo>& services);
+
+    // Службы, которые прямо или через другие зависят от данной
+    QStringList dependents(const QString& serviceName, bool runningOnly) const;
+    // Порядок остановки служб вместе с работающими зависимыми: каждая волна останавливается только после предыдущей
+    QList<QStringList> stopOrder(const QStringList& serviceNames) const;
+
+    QStringList servicesInProcess(quint32 pid) const;
+    quint32 processId(const QString& serviceName) const;
+
+private:
+    struct Node
+    {
+        QString name;
+        quint32 processId = 0;
+        ServiceStatus status = ssUnknown;
+        QStringList dependencyNames;
+        QList<int> dependsOn;
+        QList<int> dependents;
+        quint64 generation = 0;
+        bool present = false;
+    };
+
+    int nodeFor(const QString& name);
+    int findNode(const QString& name) const;
+    void setDependencies(int node, const QStringList& names);
+    void setProcessId(int node, quint32 pid);
+    QList<int> collectDependents(int node, bool runningOnly) const;
+
+    QList<Node> _nodes;
+    QHash<QString, int> _index;
+    QHash<quint32, QList<int>> _byProcess;
+    quint64 _generation = 0;
+};
@@ -0,0 +1,171 @@
+﻿#include "ServiceOperationQueue.h"
+#include <QElapsedTimer>
+#include <QThread>
+
+static bool isPendingStatus(ServiceStatus status)
+{
+    return status == ssStartPending || status == ssStopPending || status == ssContinuePending || status == ssPausePending;
+}
+
+ServiceOperationQueue::ServiceOperationQueue(std::unique_ptr<IServiceControl> control, QObject* parent)
+    : QObject(parent), _control(std::move(control))
+{
+    _pool.setMaxThreadCount(MAX_PARALLEL_OPERATIONS);
+}
+
+ServiceOperationQueue::~ServiceOperationQueue()
+{
+    // Опрос прерывается на ближайшем шаге, команды, уже отправленные службам, не отменяются
+    _stopping.store(true, std::memory_order_relaxed);
+    _pool.clear();
+    _pool.waitForDone();
+}
+
+int ServiceOperationQueue::enqueue(const QStringList& serviceNames, ServiceOperation operation)
+{
+    return enqueueStages({ serviceNames }, operation);
+}
+
+int ServiceOperationQueue::enqueueStages(const QList<QStringList>& stages, ServiceOperation operation)
+{
+    Batch batch;
+    batch.operation = operation;
+    QSet<QString> queued;
+    for (const QStringList& stage : stages)
+    {
+        QStringList names;
+        for (const QString& serviceName : stage)
+        {
+            if (!_busy.contains(serviceName) && !queued.contains(serviceName))
+            {
+                queued.insert(serviceName);
+                names.append(serviceName);
+            }
+        }
+        if (!names.isEmpty())
+        {
+            batch.stages.append(names);
+            batch.total += names.size();
+        }
+    }
+    if (batch.total == 0)
+    {
+        return 0;
+    }
+
+    // Службы последующих этапов считаются занятыми сразу, чтобы их не поставили повторно
+    _busy.unite(queued);
+    quint64 batchId = _nextBatchId++;
+    _batches.insert(batchId, batch);
+    startStage(batchId);
+    return batch.total;
+}
+
+void ServiceOperationQueue::startStage(quint64 batchId)
+{
+    Batch& batch = _batches[batchId];
+    QStringList names = batch.stages.takeFirst();
+    batch.remaining = names.size();
+    ServiceOperation operation = batch.operation;
+
+    for (const QString& serviceName : names)
+    {
+        _pool.start([this, batchId, serviceName, operation]()
+            {
+            run(batchId, serviceName, operation);
+        });
+    }
+}
+
+bool ServiceOperationQueue::isBusy(const QString& serviceName) const
+{
+    return _busy.contains(serviceName);
+}
+
+void ServiceOperationQueue::run(quint64 batchId, const QString& serviceName, ServiceOperation operation)
+{
+    const ServiceStatus target = operation == soStart ? ssRunning : ssStopped;
+    ServiceStatus status = ssUnknown;
+
+    // Ошибка команды не окончательна: служба могла уже быть в нужном состоянии
+    bool sent = operation == soStart ? _control->startService(serviceName) : _control->stopService(serviceName);
+
+    bool success = false;
+    bool sawPending = false;
+    ServiceStatus reported = ssUnknown;
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    while (!_stopping.load(std::memory_order_relaxed))
+    {
+        if (_control->queryStatus(serviceName, status))
+        {
+            if (status != reported)
+            {
+                reported = status;
+                QMetaObject::invokeMethod(this, [this, serviceName, status]()
+                    {
+                    emit statusChanged(serviceName, status);
+                }, Qt::QueuedConnection);
+            }
+
+            if (status == target)
+            {
+                success = true;
+                break;
+            }
+            sawPending = sawPending || isPendingStatus(status);
+
+            // Служба прошла через переходное состояние и остановилась не там, где нужно, или команда не ушла вовсе
+            if (!isPendingStatus(status) && (sawPending || !sent))
+            {
+                break;
+            }
+        }
+        else if (!sent)
+        {
+            break;
+        }
+
+        if (elapsed.hasExpired(OPERATION_TIMEOUT_MS))
+        {
+            break;
+        }
+        QThread::msleep(POLL_INTERVAL_MS);
+    }
+
+    QMetaObject::invokeMethod(this, [this, batchId, serviceName, success, status]()
+        {
+        finish(batchId, serviceName, success, status);
+    }, Qt::QueuedConnection);
+}
+
+void ServiceOperationQueue::finish(quint64 batchId, const QString& serviceName, bool success, ServiceStatus status)
+{
+    _busy.remove(serviceName);
+    emit operationFinished(serviceName, success, status);
+
+    auto it = _batches.find(batchId);
+    if (it == _batches.end())
+    {
+        return;
+    }
+    if (!success)
+    {
+        it->failed.append(serviceName);
+    }
+    if (--it->remaining > 0)
+    {
+        return;
+    }
+
+    // Этап завершён: следующий запускается, даже если часть служб этого не дошла до нужного состояния
+    if (!it->stages.isEmpty())
+    {
+        startStage(batchId);
+        return;
+    }
+    Batch batch = *it;
+    _batches.erase(it);
+    emit batchFinished(batch.operation, batch.total, batch.failed);
+}
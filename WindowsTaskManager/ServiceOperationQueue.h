@@ -0,0 +1,61 @@
+﻿#pragma once
+
+#include <QObject>
+#include <QThreadPool>
+#include <QStringList>
+#include <QHash>
+#include <QSet>
+#include <atomic>
+#include <memory>
+#include "IServiceControl.h"
+
+enum ServiceOperation { soStart, soStop };
+
+// Запуск и остановка служб в пуле потоков: после команды состояние опрашивается до конечного или до таймаута.
+// Все сигналы испускаются в потоке владельца очереди
+class ServiceOperationQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int MAX_PARALLEL_OPERATIONS = 4;
+    static constexpr int POLL_INTERVAL_MS = 250;
+    static constexpr qint64 OPERATION_TIMEOUT_MS = 30000;
+
+    ServiceOperationQueue(std::unique_ptr<IServiceControl> control, QObject* parent = nullptr);
+    ~ServiceOperationQueue() override;
+
+    // Службы, над которыми уже идёт операция, пропускаются. Возвращает число поставленных операций
+    int enqueue(const QStringList& serviceNames, ServiceOperation operation);
+    // Этапы выполняются по очереди, службы внутри этапа - параллельно (например, сначала зависимые, потом сама служба)
+    int enqueueStages(const QList<QStringList>& stages, ServiceOperation operation);
+    bool isBusy(const QString& serviceName) const;
+
+signals:
+    void statusChanged(const QString& serviceName, ServiceStatus status);
+    void operationFinished(const QString& serviceName, bool success, ServiceStatus status);
+    // Пакет завершён целиком: перечислены службы, не дошедшие до нужного состояния
+    void batchFinished(ServiceOperation operation, int total, const QStringList& failed);
+
+private:
+    struct Batch
+    {
+        ServiceOperation operation = soStart;
+        int total = 0;
+        int remaining = 0;
+        QStringList failed;
+        QList<QStringList> stages;
+    };
+
+    void startStage(quint64 batchId);
+    void run(quint64 batchId, const QString& serviceName, ServiceOperation operation);
+    void finish(quint64 batchId, const QString& serviceName, bool success, ServiceStatus status);
+
+    std::unique_ptr<IServiceControl> _control;
+    QThreadPool _pool;
+    std::atomic<bool> _stopping{ false };
+
+    QSet<QString> _busy;
+    QHash<quint64, Batch> _batches;
+    quint64 _nextBatchId = 1;
+};
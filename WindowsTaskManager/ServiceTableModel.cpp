@@ -1,4 +1,33 @@
 ﻿#include "ServiceTableModel.h"
+#include <QSet>
+#include <algorithm>
+
+const int COLUMNS_COUNT = 4;
+
+enum ServiceTableColumns { stcName, stcDescription, stcStatus, stcStartType };
+
+// Порядок сортировки по состоянию: работающие, затем переходные, затем остановленные
+static const int STATUS_SORT_ORDER[] = { 0, 6, 5, 1, 4, 2, 3, 7 };
+
+// Столбцы, в которых значения разошлись; имя меняется вместе с подсказкой (путь и зависимости)
+static bool changedColumns(const ServiceInfo& before, const ServiceInfo& after, int& left, int& right)
+{
+    left = COLUMNS_COUNT;
+    right = -1;
+    auto mark = [&](int column, bool changed)
+        {
+        if (changed)
+        {
+            left = std::min(left, column);
+            right = std::max(right, column);
+        }
+    };
+    mark(stcName, before.binaryPath != after.binaryPath || before.dependencies != after.dependencies);
+    mark(stcDescription, before.description != after.description);
+    mark(stcStatus, before.status != after.status);
+    mark(stcStartType, before.startType != after.startType);
+    return right >= 0;
+}
 
 ServiceTableModel::ServiceTableModel(QObject* parent)
     : QAbstractTableModel(parent) 
@@ -12,7 +41,7 @@ int ServiceTableModel::rowCount(const QModelIndex& parent) const
 
 int ServiceTableModel::columnCount(const QModelIndex& parent) const
 {
-    return 3; // Имя, Описание, Состояние
+    return COLUMNS_COUNT; // Имя, Описание, Состояние, Тип запуска
 }
 
 QVariant ServiceTableModel::data(const QModelIndex& index, int role) const 
@@ -28,27 +57,42 @@ QVariant ServiceTableModel::data(const QModelIndex& index, int role) const
     {
         switch (index.column())
         {
-        case 0:
+        case stcName:
             return svc.name;
-        case 1:
+        case stcDescription:
             return svc.description.isEmpty() ? "" : svc.description;
-        case 2:
+        case stcStatus:
             return ServiceStatusString[svc.status];
+        case stcStartType:
+            return ServiceStartTypeString[svc.startType];
         default:
             return QVariant();
         }
     }
 
+    if (role == Qt::ToolTipRole && index.column() == stcName && !(svc.binaryPath.isEmpty() && svc.dependencies.isEmpty()))
+    {
+        QString toolTip = svc.binaryPath;
+        if (!svc.dependencies.isEmpty())
+        {
+            toolTip += QString(toolTip.isEmpty() ? "" : "\n") + "Зависит от: " + svc.dependencies.join(", ");
+        }
+        return toolTip;
+    }
+
+    // Ключи сортировки: перечисления сравниваются как числа, а не как локализованные строки
     if (role == Qt::UserRole)
     {
         switch (index.column()) 
         {
-        case 0:
+        case stcName:
             return svc.name;
-        case 1:
+        case stcDescription:
             return svc.description.isEmpty() ? "" : svc.description;
-        case 2:
-            return ServiceStatusString[svc.status];
+        case stcStatus:
+            return STATUS_SORT_ORDER[svc.status];
+        case stcStartType:
+            return static_cast<int>(svc.startType);
         default:
             return QVariant();
         }
@@ -63,12 +107,14 @@ QVariant ServiceTableModel::headerData(int section, Qt::Orientation orientation,
     {
         switch (section)
         {
-        case 0:
+        case stcName:
             return "Name";
-        case 1:
+        case stcDescription:
             return "Description";
-        case 2:
+        case stcStatus:
             return "Status";
+        case stcStartType:
+            return "Startup type";
         default:
             return QVariant();
         }
@@ -76,9 +122,126 @@ QVariant ServiceTableModel::headerData(int section, Qt::Orientation orientation,
     return QAbstractTableModel::headerData(section, orientation, role);
 }
 
+void ServiceTableModel::reindexFrom(int row)
+{
+    for (int i = row; i < _services.size(); i++)
+    {
+        _rows[_services[i].name] = i;
+    }
+}
+
 void ServiceTableModel::updateData(const QList<ServiceInfo>& data)
 {
-    beginResetModel();
-    _services = data;
-    endResetModel();
-}
\ No newline at end of file
+    QSet<QString> names;
+    names.reserve(data.size());
+    for (const auto& svc : data)
+    {
+        names.insert(svc.name);
+    }
+
+    // Удалённые: строки удаляются диапазонами подряд идущих индексов от конца к началу
+    int firstRemoved = -1;
+    for (int last = _services.size() - 1; last >= 0;)
+    {
+        if (names.contains(_services[last].name))
+        {
+            last--;
+            continue;
+        }
+
+        int first = last;
+        while (first > 0 && !names.contains(_services[first - 1].name))
+        {
+            first--;
+        }
+        for (int row = first; row <= last; row++)
+        {
+            _rows.remove(_services[row].name);
+        }
+
+        beginRemoveRows(QModelIndex(), first, last);
+        _services.remove(first, last - first + 1);
+        endRemoveRows();
+
+        firstRemoved = first;
+        last = first - 1;
+    }
+    // Номера строк сдвинулись только после самой первой удалённой
+    if (firstRemoved >= 0)
+    {
+        reindexFrom(firstRemoved);
+    }
+
+    // Изменённые: dataChanged только по разошедшимся столбцам, соседние строки объединяются в один диапазон
+    QList<ServiceInfo> added;
+    int runFirst = -1;
+    int runLast = -1;
+    int runLeft = COLUMNS_COUNT;
+    int runRight = -1;
+    auto flushRun = [&]()
+        {
+        if (runFirst >= 0)
+        {
+            emit dataChanged(index(runFirst, runLeft), index(runLast, runRight));
+        }
+        runFirst = -1;
+    };
+
+    for (const auto& svc : data)
+    {
+        int row = _rows.value(svc.name, -1);
+        if (row < 0)
+        {
+            added.append(svc);
+            continue;
+        }
+
+        int left, right;
+        bool changed = changedColumns(_services[row], svc, left, right);
+        // PID не отображается, но хранится актуальным для связи с процессами
+        _services[row] = svc;
+        if (!changed)
+        {
+            continue;
+        }
+
+        if (runFirst >= 0 && row == runLast + 1)
+        {
+            runLast = row;
+            runLeft = std::min(runLeft, left);
+            runRight = std::max(runRight, right);
+        }
+        else
+        {
+            flushRun();
+            runFirst = row;
+            runLast = row;
+            runLeft = left;
+            runRight = right;
+        }
+    }
+    flushRun();
+
+    // Новые: добавляются в конец одной вставкой, место в порядке сортировки определяет прокси
+    if (!added.isEmpty())
+    {
+        int first = _services.size();
+        beginInsertRows(QModelIndex(), first, first + added.size() - 1);
+        _services.append(added);
+        endInsertRows();
+        reindexFrom(first);
+    }
+}
+
+void ServiceTableModel::setServiceStatus(const QString& serviceName, ServiceStatus status)
+{
+    int row = _rows.value(serviceName, -1);
+    if (row < 0 || _services[row].status == status)
+    {
+        return;
+    }
+
+    _services[row].status = status;
+    QModelIndex statusIndex = index(row, stcStatus);
+    emit dataChanged(statusIndex, statusIndex);
+}
@@ -2,8 +2,10 @@
 
 #include <QAbstractTableModel>
 #include <QList>
+#include <QHash>
 #include "IServiceMonitor.h"
 
+// Таблица служб: обновление сопоставляет строки по имени службы и затрагивает только изменившиеся
 class ServiceTableModel : public QAbstractTableModel 
 {
     Q_OBJECT
@@ -17,7 +19,11 @@ public:
     QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
 
     void updateData(const QList<ServiceInfo>& data);
+    void setServiceStatus(const QString& serviceName, ServiceStatus status);
 
 private:
     QList<ServiceInfo> _services;
+    QHash<QString, int> _rows;
+
+    void reindexFrom(int row);
 };
\ No newline at end of file
@@ -0,0 +1,340 @@
+﻿#include "SpanTracer.h"
+#include <QFile>
+#include <QThread>
+#include <QMutexLocker>
+#include <chrono>
+#include <algorithm>
+
+std::atomic<bool> SpanTracer::_enabled{ false };
+
+ThreadTraceBuffer::ThreadTraceBuffer(quint32 trackId, const QString& threadName)
+    : _trackId(trackId), _threadName(threadName), _events(new TraceEvent[CAPACITY])
+{
+}
+
+void ThreadTraceBuffer::append(const TraceEvent& event)
+{
+    quint64 index = _writeIndex.load(std::memory_order_relaxed);
+    // Отметка о начале записи видна читателю раньше любых байтов новой ячейки
+    _claimIndex.store(index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    _events[index % CAPACITY] = event;
+    _writeIndex.store(index + 1, std::memory_order_release);
+}
+
+QList<TraceEvent> ThreadTraceBuffer::events() const
+{
+    QList<TraceEvent> result;
+
+    quint64 end = _writeIndex.load(std::memory_order_acquire);
+    quint64 begin = std::max(_readFrom.load(std::memory_order_relaxed), end > CAPACITY ? end - CAPACITY : 0);
+    result.reserve(static_cast<qsizetype>(end - begin));
+    for (quint64 i = begin; i < end; i++)
+    {
+        result.append(_events[i % CAPACITY]);
+    }
+
+    // Пока шло копирование, поток-владелец мог уйти на новый круг: ячейки событий старше claimed - CAPACITY
+    // могли быть перезаписаны частично, такие события отбрасываются
+    std::atomic_thread_fence(std::memory_order_acquire);
+    quint64 claimed = _claimIndex.load(std::memory_order_relaxed);
+    quint64 firstIntact = claimed > CAPACITY ? claimed - CAPACITY : 0;
+    if (firstIntact > begin)
+    {
+        result.remove(0, static_cast<qsizetype>(std::min(firstIntact, end) - begin));
+    }
+
+    return result;
+}
+
+void ThreadTraceBuffer::clear()
+{
+    _readFrom.store(_writeIndex.load(std::memory_order_acquire), std::memory_order_relaxed);
+}
+
+quint32 ThreadTraceBuffer::trackId() const
+{
+    return _trackId;
+}
+
+QString ThreadTraceBuffer::threadName() const
+{
+    return _threadName;
+}
+
+SpanTracer& SpanTracer::instance()
+{
+    static SpanTracer tracer;
+    return tracer;
+}
+
+void SpanTracer::setEnabled(bool enabled)
+{
+    _enabled.store(enabled, std::memory_order_relaxed);
+}
+
+quint64 SpanTracer::nowNs()
+{
+    static const auto epoch = std::chrono::steady_clock::now();
+    return static_cast<quint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+}
+
+quint64 SpanTracer::nextFlowId()
+{
+    return _flowCounter.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+ThreadTraceBuffer* SpanTracer::currentBuffer()
+{
+    // Буфер создаётся при первом событии потока, дальше запись идёт без блокировок
+    thread_local ThreadTraceBuffer* buffer = nullptr;
+    if (!buffer)
+    {
+        QMutexLocker locker(&_buffersMutex);
+        quint32 trackId = static_cast<quint32>(_buffers.size()) + 1;
+        QString threadName = QThread::currentThread()->objectName();
+        if (threadName.isEmpty())
+        {
+            threadName = QString("thread %1").arg(trackId);
+        }
+        _buffers.push_back(std::make_unique<ThreadTraceBuffer>(trackId, threadName));
+        buffer = _buffers.back().get();
+    }
+    return buffer;
+}
+
+void SpanTracer::recordSpan(const char* name, quint64 startNs, quint64 durationNs)
+{
+    TraceEvent event;
+    event.name = name;
+    event.startNs = startNs;
+    event.durationNs = durationNs;
+    event.phase = tepComplete;
+    currentBuffer()->append(event);
+}
+
+void SpanTracer::recordFlow(const char* name, quint64 flowId, TraceEventPhase phase)
+{
+    TraceEvent event;
+    event.name = name;
+    event.startNs = nowNs();
+    event.flowId = flowId;
+    event.phase = phase;
+    currentBuffer()->append(event);
+}
+
+static QByteArray jsonEscaped(const char* text)
+{
+    QByteArray escaped;
+    for (const char* c = text; *c; c++)
+    {
+        if (*c == '"' || *c == '\\')
+        {
+            escaped.append('\\');
+        }
+        escaped.append(*c);
+    }
+    return escaped;
+}
+
+QByteArray SpanTracer::toChromeJson() const
+{
+    QByteArray json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    auto appendEvent = [&](const QByteArray& event)
+        {
+        if (!first)
+        {
+            json.append(",\n");
+        }
+        json.append(event);
+        first = false;
+    };
+
+    QMutexLocker locker(&_buffersMutex);
+    for (const auto& buffer : _buffers)
+    {
+        QByteArray tid = QByteArray::number(buffer->trackId());
+        appendEvent("{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" + tid +
+            ",\"args\":{\"name\":\"" + jsonEscaped(buffer->threadName().toUtf8().constData()) + "\"}}");
+
+        for (const auto& event : buffer->events())
+        {
+            // Chrome ожидает микросекунды, дробная часть сохраняет точность до наносекунд
+            QByteArray ts = QByteArray::number(event.startNs / 1000.0, 'f', 3);
+            QByteArray name = jsonEscaped(event.name);
+            switch (event.phase)
+            {
+            case tepComplete:
+                appendEvent("{\"ph\":\"X\",\"cat\":\"wintop\",\"name\":\"" + name + "\",\"pid\":1,\"tid\":" + tid +
+                    ",\"ts\":" + ts + ",\"dur\":" + QByteArray::number(event.durationNs / 1000.0, 'f', 3) + "}");
+                break;
+            case tepFlowBegin:
+                appendEvent("{\"ph\":\"s\",\"cat\":\"flow\",\"name\":\"" + name + "\",\"pid\":1,\"tid\":" + tid +
+                    ",\"ts\":" + ts + ",\"id\":" + QByteArray::number(event.flowId) + "}");
+                break;
+            case tepFlowEnd:
+                appendEvent("{\"ph\":\"f\",\"bp\":\"e\",\"cat\":\"flow\",\"name\":\"" + name + "\",\"pid\":1,\"tid\":" + tid +
+                    ",\"ts\":" + ts + ",\"id\":" + QByteArray::number(event.flowId) + "}");
+                break;
+            }
+        }
+    }
+
+    json.append("]}");
+    return json;
+}
+
+// Минимальный кодировщик protobuf, достаточный для формата trace.proto
+static void appendVarint(QByteArray& out, quint64 value)
+{
+    while (value >= 0x80)
+    {
+        out.append(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.append(static_cast<char>(value));
+}
+
+static void appendVarintField(QByteArray& out, quint32 field, quint64 value)
+{
+    appendVarint(out, (static_cast<quint64>(field) << 3) | 0);
+    appendVarint(out, value);
+}
+
+static void appendFixed64Field(QByteArray& out, quint32 field, quint64 value)
+{
+    appendVarint(out, (static_cast<quint64>(field) << 3) | 1);
+    for (int i = 0; i < 8; i++)
+    {
+        out.append(static_cast<char>((value >> (i * 8)) & 0xFF));
+    }
+}
+
+static void appendBytesField(QByteArray& out, quint32 field, const QByteArray& bytes)
+{
+    appendVarint(out, (static_cast<quint64>(field) << 3) | 2);
+    appendVarint(out, static_cast<quint64>(bytes.size()));
+    out.append(bytes);
+}
+
+// Номера полей из protos/perfetto/trace
+enum PerfettoField : quint32
+{
+    pfTracePacket = 1,
+    pfPacketTimestamp = 8,
+    pfPacketSequenceId = 10,
+    pfPacketTrackEvent = 11,
+    pfPacketTrackDescriptor = 60,
+    pfTrackUuid = 1,
+    pfTrackName = 2,
+    pfTrackThread = 4,
+    pfThreadPid = 1,
+    pfThreadTid = 2,
+    pfThreadName = 5,
+    pfEventType = 9,
+    pfEventTrackUuid = 11,
+    pfEventName = 23,
+    pfEventFlowIds = 47,
+    pfEventTerminatingFlowIds = 48
+};
+
+enum PerfettoEventType : quint64 { petSliceBegin = 1, petSliceEnd = 2, petInstant = 3 };
+
+static const quint32 PERFETTO_SEQUENCE_ID = 1;
+static const quint32 PERFETTO_PID = 1;
+
+static void appendTrackEventPacket(QByteArray& trace, quint64 timestampNs, quint64 trackUuid, quint64 type, const char* name, quint64 flowId, bool terminatingFlow)
+{
+    QByteArray trackEvent;
+    appendVarintField(trackEvent, pfEventType, type);
+    appendVarintField(trackEvent, pfEventTrackUuid, trackUuid);
+    if (name)
+    {
+        appendBytesField(trackEvent, pfEventName, QByteArray(name));
+    }
+    if (flowId != 0)
+    {
+        appendFixed64Field(trackEvent, terminatingFlow ? pfEventTerminatingFlowIds : pfEventFlowIds, flowId);
+    }
+
+    QByteArray packet;
+    appendVarintField(packet, pfPacketTimestamp, timestampNs);
+    appendVarintField(packet, pfPacketSequenceId, PERFETTO_SEQUENCE_ID);
+    appendBytesField(packet, pfPacketTrackEvent, trackEvent);
+    appendBytesField(trace, pfTracePacket, packet);
+}
+
+QByteArray SpanTracer::toPerfetto() const
+{
+    QByteArray trace;
+
+    QMutexLocker locker(&_buffersMutex);
+    for (const auto& buffer : _buffers)
+    {
+        quint64 trackUuid = buffer->trackId();
+
+        QByteArray thread;
+        appendVarintField(thread, pfThreadPid, PERFETTO_PID);
+        appendVarintField(thread, pfThreadTid, buffer->trackId());
+        appendBytesField(thread, pfThreadName, buffer->threadName().toUtf8());
+
+        QByteArray descriptor;
+        appendVarintField(descriptor, pfTrackUuid, trackUuid);
+        appendBytesField(descriptor, pfTrackName, buffer->threadName().toUtf8());
+        appendBytesField(descriptor, pfTrackThread, thread);
+
+        QByteArray packet;
+        appendVarintField(packet, pfPacketSequenceId, PERFETTO_SEQUENCE_ID);
+        appendBytesField(packet, pfPacketTrackDescriptor, descriptor);
+        appendBytesField(trace, pfTracePacket, packet);
+
+        for (const auto& event : buffer->events())
+        {
+            switch (event.phase)
+            {
+            case tepComplete:
+                appendTrackEventPacket(trace, event.startNs, trackUuid, petSliceBegin, event.name, 0, false);
+                appendTrackEventPacket(trace, event.startNs + event.durationNs, trackUuid, petSliceEnd, nullptr, 0, false);
+                break;
+            case tepFlowBegin:
+                appendTrackEventPacket(trace, event.startNs, trackUuid, petInstant, event.name, event.flowId, false);
+                break;
+            case tepFlowEnd:
+                appendTrackEventPacket(trace, event.startNs, trackUuid, petInstant, event.name, event.flowId, true);
+                break;
+            }
+        }
+    }
+
+    return trace;
+}
+
+bool SpanTracer::writeChromeJson(const QString& filePath) const
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        return false;
+    }
+    return file.write(toChromeJson()) >= 0;
+}
+
+bool SpanTracer::writePerfetto(const QString& filePath) const
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        return false;
+    }
+    return file.write(toPerfetto()) >= 0;
+}
+
+void SpanTracer::clear()
+{
+    QMutexLocker locker(&_buffersMutex);
+    for (const auto& buffer : _buffers)
+    {
+        buffer->clear();
+    }
+}
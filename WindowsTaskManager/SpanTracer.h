@@ -0,0 +1,115 @@
+﻿#pragma once
+
+#include <QString>
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+enum TraceEventPhase : quint8 { tepComplete, tepFlowBegin, tepFlowEnd };
+
+struct TraceEvent
+{
+	const char* name = nullptr;
+	quint64 startNs = 0;
+	quint64 durationNs = 0;
+	quint64 flowId = 0;
+	TraceEventPhase phase = tepComplete;
+};
+
+// Кольцевой буфер событий одного потока. Пишет только поток-владелец, читает сброс трассы из другого потока
+// без остановки записи: как в seqlock, после копирования проверяется, какие ячейки за это время начали перезаписываться
+class ThreadTraceBuffer
+{
+public:
+	static constexpr quint64 CAPACITY = 16384;
+
+	ThreadTraceBuffer(quint32 trackId, const QString& threadName);
+
+	void append(const TraceEvent& event);
+	QList<TraceEvent> events() const;
+	void clear();
+
+	quint32 trackId() const;
+	QString threadName() const;
+
+private:
+	quint32 _trackId;
+	QString _threadName;
+	std::unique_ptr<TraceEvent[]> _events;
+	// Число опубликованных событий и число начатых записей: между ними не больше одной ячейки в процессе записи
+	std::atomic<quint64> _writeIndex{ 0 };
+	std::atomic<quint64> _claimIndex{ 0 };
+	std::atomic<quint64> _readFrom{ 0 };
+};
+
+// Трассировка внутренних интервалов с выгрузкой в Chrome JSON (chrome://tracing) и Perfetto protobuf (ui.perfetto.dev)
+class SpanTracer
+{
+public:
+	static SpanTracer& instance();
+
+	static bool isEnabled() { return _enabled.load(std::memory_order_relaxed); }
+	void setEnabled(bool enabled);
+
+	static quint64 nowNs();
+	quint64 nextFlowId();
+
+	void recordSpan(const char* name, quint64 startNs, quint64 durationNs);
+	void recordFlow(const char* name, quint64 flowId, TraceEventPhase phase);
+
+	QByteArray toChromeJson() const;
+	QByteArray toPerfetto() const;
+	bool writeChromeJson(const QString& filePath) const;
+	bool writePerfetto(const QString& filePath) const;
+	void clear();
+
+private:
+	SpanTracer() = default;
+
+	ThreadTraceBuffer* currentBuffer();
+
+	static std::atomic<bool> _enabled;
+	std::atomic<quint64> _flowCounter{ 0 };
+
+	mutable QMutex _buffersMutex;
+	std::vector<std::unique_ptr<ThreadTraceBuffer>> _buffers;
+};
+
+class ScopedTraceSpan
+{
+public:
+	explicit ScopedTraceSpan(const char* name)
+		: _name(SpanTracer::isEnabled() ? name : nullptr), _startNs(_name ? SpanTracer::nowNs() : 0)
+	{
+	}
+
+	~ScopedTraceSpan()
+	{
+		if (_name)
+		{
+			SpanTracer::instance().recordSpan(_name, _startNs, SpanTracer::nowNs() - _startNs);
+		}
+	}
+
+	ScopedTraceSpan(const ScopedTraceSpan&) = delete;
+	ScopedTraceSpan& operator=(const ScopedTraceSpan&) = delete;
+
+private:
+	const char* _name;
+	quint64 _startNs;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+// Имя должно быть строковым литералом: в буфер сохраняется только указатель
+#define TRACE_SCOPE(spanName) ScopedTraceSpan TRACE_CONCAT(_traceSpan, __LINE__)(spanName)
+
+#define TRACE_FLOW_BEGIN(flowName, flowId) \
+	do { if (SpanTracer::isEnabled()) SpanTracer::instance().recordFlow(flowName, flowId, tepFlowBegin); } while (0)
+
+#define TRACE_FLOW_END(flowName, flowId) \
+	do { if (SpanTracer::isEnabled()) SpanTracer::instance().recordFlow(flowName, flowId, tepFlowEnd); } while (0)
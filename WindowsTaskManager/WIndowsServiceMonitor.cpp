@@ -1,81 +1,298 @@
 #include "WIndowsServiceMonitor.h"
+#include <QSet>
+#include <algorithm>
 
-WindowsServiceMonitor::WindowsServiceMonitor() 
+WindowsServiceMonitor::WindowsServiceMonitor()
 {
+    _scm = OpenSCManagerW(NULL, NULL, SC_MANAGER_CONNECT | SC_MANAGER_ENUMERATE_SERVICE);
+    if (!_scm)
+    {
+        return;
+    }
+
+    //       ,       
+    if (SubscribeServiceChangeNotifications(_scm, SC_EVENT_DATABASE_CHANGE, onDatabaseChange, this, &_databaseSubscription) != ERROR_SUCCESS)
+    {
+        _databaseSubscription = nullptr;
+    }
 }
 
-WindowsServiceMonitor::~WindowsServiceMonitor() 
+WindowsServiceMonitor::~WindowsServiceMonitor()
 {
+    if (_databaseSubscription)
+    {
+        UnsubscribeServiceChangeNotifications(_databaseSubscription);
+    }
+    for (ServiceEntry* entry : _entries)
+    {
+        closeEntry(entry);
+    }
+    if (_scm)
+    {
+        CloseServiceHandle(_scm);
+    }
 }
 
-QList<ServiceInfo> WindowsServiceMonitor::getServices() 
+void CALLBACK WindowsServiceMonitor::onDatabaseChange(DWORD notification, PVOID context)
 {
-    QList<ServiceInfo> services;
+    static_cast<WindowsServiceMonitor*>(context)->_databaseChanged.store(true, std::memory_order_release);
+}
 
-    SC_HANDLE hSCM = OpenSCManager(NULL, NULL, SC_MANAGER_ENUMERATE_SERVICE);
-    if (!hSCM) 
+void CALLBACK WindowsServiceMonitor::onStatusChange(DWORD notification, PVOID context)
+{
+    static_cast<ServiceEntry*>(context)->statusChanged.store(true, std::memory_order_release);
+}
+
+QList<ServiceInfo> WindowsServiceMonitor::getServices()
+{
+    QList<ServiceInfo> services;
+    if (!_scm)
     {
         return services;
     }
 
-    DWORD bytesNeeded = 0;
-    DWORD serviceCount = 0;
+    if (_databaseChanged.exchange(false, std::memory_order_acq_rel) || _pollingRequired)
+    {
+        if (!enumerateServices())
+        {
+            _databaseChanged.store(true, std::memory_order_release);
+        }
+    }
+    else
+    {
+        //   ,      
+        for (ServiceEntry* entry : _order)
+        {
+            if (entry->statusChanged.exchange(false, std::memory_order_acq_rel))
+            {
+                refreshStatus(*entry);
+            }
+        }
+    }
+
+    services.reserve(static_cast<qsizetype>(_order.size()));
+    int configRefreshes = 0;
+    for (ServiceEntry* entry : _order)
+    {
+        // ,       :    ,  -  ,   
+        if (!entry->configAge.isValid())
+        {
+            refreshConfig(*entry);
+        }
+        else if (configRefreshes < CONFIG_REFRESHES_PER_TICK && entry->configAge.hasExpired(CONFIG_REFRESH_INTERVAL_MS))
+        {
+            refreshConfig(*entry);
+            configRefreshes++;
+        }
+        services.append(entry->info);
+    }
+
+    return services;
+}
+
+bool WindowsServiceMonitor::enumerateServices()
+{
+    //    ,    ,    
+    for (ServiceEntry* entry : _order)
+    {
+        entry->statusChanged.store(false, std::memory_order_relaxed);
+    }
+
+    std::vector<ServiceEntry*> order;
+    order.reserve(_order.size());
+    QSet<QString> seen;
     DWORD resumeHandle = 0;
 
-    //   
-    BOOL result = EnumServicesStatusW(hSCM, SERVICE_WIN32 | SERVICE_DRIVER, SERVICE_STATE_ALL, NULL, 0, &bytesNeeded, &serviceCount, 0);
-    if (result != ERROR_SUCCESS)
+    for (;;)
     {
-        return services;
+        DWORD bytesNeeded = 0;
+        DWORD serviceCount = 0;
+        BOOL result = EnumServicesStatusExW(_scm, SC_ENUM_PROCESS_INFO, SERVICE_WIN32, SERVICE_STATE_ALL,
+            _enumBuffer.empty() ? NULL : _enumBuffer.data(), static_cast<DWORD>(_enumBuffer.size()),
+            &bytesNeeded, &serviceCount, &resumeHandle, NULL);
+        if (!result && GetLastError() != ERROR_MORE_DATA)
+        {
+            return false;
+        }
+
+        auto* statuses = reinterpret_cast<ENUM_SERVICE_STATUS_PROCESSW*>(_enumBuffer.data());
+        for (DWORD i = 0; i < serviceCount; i++)
+        {
+            const ENUM_SERVICE_STATUS_PROCESSW& svc = statuses[i];
+            QString name = QString::fromWCharArray(svc.lpServiceName);
+
+            ServiceEntry* entry = _entries.value(name, nullptr);
+            if (!entry)
+            {
+                entry = openEntry(name);
+            }
+            entry->info.status = getStatusString(svc.ServiceStatusProcess.dwCurrentState);
+            entry->info.processId = svc.ServiceStatusProcess.dwProcessId;
+
+            order.push_back(entry);
+            seen.insert(name);
+        }
+
+        if (result)
+        {
+            break;
+        }
+
+        //  :    ,      
+        if (_enumBuffer.size() < bytesNeeded)
+        {
+            _enumBuffer.resize(bytesNeeded);
+        }
+    }
+
+    for (auto it = _entries.begin(); it != _entries.end();)
+    {
+        if (!seen.contains(it.key()))
+        {
+            closeEntry(it.value());
+            it = _entries.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    _order = std::move(order);
+
+    //       ,     
+    _pollingRequired = !_databaseSubscription;
+    for (ServiceEntry* entry : _order)
+    {
+        if (!entry->subscription)
+        {
+            _pollingRequired = true;
+            break;
+        }
+    }
+
+    return true;
+}
+
+WindowsServiceMonitor::ServiceEntry* WindowsServiceMonitor::openEntry(const QString& name)
+{
+    auto* entry = new ServiceEntry();
+    entry->info.name = name;
+    entry->info.status = ServiceStatus::ssUnknown;
+
+    //   :    ,    
+    entry->handle = OpenServiceW(_scm, reinterpret_cast<LPCWSTR>(name.utf16()), SERVICE_QUERY_STATUS | SERVICE_QUERY_CONFIG);
+    if (!entry->handle)
+    {
+        entry->handle = OpenServiceW(_scm, reinterpret_cast<LPCWSTR>(name.utf16()), SERVICE_QUERY_STATUS);
+    }
+    if (entry->handle)
+    {
+        if (SubscribeServiceChangeNotifications(entry->handle, SC_EVENT_STATUS_CHANGE, onStatusChange, entry, &entry->subscription) != ERROR_SUCCESS)
+        {
+            entry->subscription = nullptr;
+        }
+    }
+
+    _entries.insert(name, entry);
+    return entry;
+}
+
+void WindowsServiceMonitor::closeEntry(ServiceEntry* entry)
+{
+    //      ,     
+    if (entry->subscription)
+    {
+        UnsubscribeServiceChangeNotifications(entry->subscription);
+    }
+    if (entry->handle)
+    {
+        CloseServiceHandle(entry->handle);
     }
+    delete entry;
+}
 
-    if (bytesNeeded > 0) 
+void WindowsServiceMonitor::refreshStatus(ServiceEntry& entry)
+{
+    SERVICE_STATUS_PROCESS status;
+    DWORD bytesNeeded = 0;
+    if (QueryServiceStatusEx(entry.handle, SC_STATUS_PROCESS_INFO, reinterpret_cast<LPBYTE>(&status), sizeof(status), &bytesNeeded))
     {
-        auto* buffer = (LPENUM_SERVICE_STATUSW)malloc(bytesNeeded);
-        if (buffer) 
+        entry.info.status = getStatusString(status.dwCurrentState);
+        entry.info.processId = status.dwProcessId;
+    }
+}
+
+void WindowsServiceMonitor::refreshConfig(ServiceEntry& entry)
+{
+    entry.configAge.start();
+    if (!entry.handle)
+    {
+        return;
+    }
+
+    //          ERROR_INSUFFICIENT_BUFFER    
+    DWORD bytesNeeded = 0;
+    if (!QueryServiceConfigW(entry.handle, NULL, 0, &bytesNeeded) && GetLastError() == ERROR_INSUFFICIENT_BUFFER)
+    {
+        _configBuffer.resize(std::max<size_t>(_configBuffer.size(), bytesNeeded));
+        auto* config = reinterpret_cast<QUERY_SERVICE_CONFIGW*>(_configBuffer.data());
+        if (QueryServiceConfigW(entry.handle, config, static_cast<DWORD>(_configBuffer.size()), &bytesNeeded))
         {
-            if (EnumServicesStatusW(hSCM, SERVICE_WIN32, SERVICE_STATE_ALL, buffer, bytesNeeded, &bytesNeeded, &serviceCount, 0)) 
+            entry.info.binaryPath = config->lpBinaryPathName ? QString::fromWCharArray(config->lpBinaryPathName) : QString();
+
+            //   -       ;    (  "+") 
+            entry.info.dependencies.clear();
+            for (LPCWSTR dependency = config->lpDependencies; dependency && *dependency; dependency += wcslen(dependency) + 1)
             {
-                for (DWORD i = 0; i < serviceCount; i++) 
+                if (*dependency != SC_GROUP_IDENTIFIERW)
                 {
-                    ENUM_SERVICE_STATUSW& svc = buffer[i];
-
-                    ServiceInfo info;
-                    info.name = QString::fromWCharArray(svc.lpServiceName);
-                    info.status = getStatusString(svc.ServiceStatus.dwCurrentState);
-                    // 
-                    SC_HANDLE hSvc = OpenServiceW(hSCM, svc.lpServiceName, SERVICE_QUERY_CONFIG);
-                    if (hSvc) 
-                    {
-                        DWORD descriptionSize = 0;
-                        BOOL result = QueryServiceConfig2W(hSvc, SERVICE_CONFIG_DESCRIPTION, NULL, 0, &descriptionSize);
-                        if ((result == ERROR_SUCCESS) && (descriptionSize > 0))
-                        {
-                            SERVICE_DESCRIPTION* descriptionBuffer = (SERVICE_DESCRIPTION*)malloc(descriptionSize);
-                            if (descriptionBuffer) 
-                            {
-                                if (QueryServiceConfig2W(hSvc, SERVICE_CONFIG_DESCRIPTION, (LPBYTE)descriptionBuffer, descriptionSize, &descriptionSize)) 
-                                {
-                                    if (descriptionBuffer) 
-                                    {
-                                        info.description = QString::fromWCharArray(descriptionBuffer->lpDescription);
-                                    }
-                                }
-                                free(descriptionBuffer);
-                            }
-                        }
-                        CloseServiceHandle(hSvc);
-                    }
-
-                    services.append(info);
+                    entry.info.dependencies.append(QString::fromWCharArray(dependency));
                 }
             }
-            free(buffer);
+            switch (config->dwStartType)
+            {
+            case SERVICE_BOOT_START:
+                entry.info.startType = sstBoot;
+                break;
+            case SERVICE_SYSTEM_START:
+                entry.info.startType = sstSystem;
+                break;
+            case SERVICE_AUTO_START:
+                entry.info.startType = sstAutomatic;
+                break;
+            case SERVICE_DEMAND_START:
+                entry.info.startType = sstManual;
+                break;
+            case SERVICE_DISABLED:
+                entry.info.startType = sstDisabled;
+                break;
+            default:
+                entry.info.startType = sstUnknown;
+                break;
+            }
         }
     }
 
-    CloseServiceHandle(hSCM);
-    return services;
+    if (entry.info.startType == sstAutomatic)
+    {
+        SERVICE_DELAYED_AUTO_START_INFO delayedInfo = {};
+        if (QueryServiceConfig2W(entry.handle, SERVICE_CONFIG_DELAYED_AUTO_START_INFO, reinterpret_cast<LPBYTE>(&delayedInfo), sizeof(delayedInfo), &bytesNeeded) &&
+            delayedInfo.fDelayedAutostart)
+        {
+            entry.info.startType = sstAutomaticDelayed;
+        }
+    }
+
+    bytesNeeded = 0;
+    if (!QueryServiceConfig2W(entry.handle, SERVICE_CONFIG_DESCRIPTION, NULL, 0, &bytesNeeded) && GetLastError() == ERROR_INSUFFICIENT_BUFFER)
+    {
+        _configBuffer.resize(std::max<size_t>(_configBuffer.size(), bytesNeeded));
+        auto* description = reinterpret_cast<SERVICE_DESCRIPTIONW*>(_configBuffer.data());
+        if (QueryServiceConfig2W(entry.handle, SERVICE_CONFIG_DESCRIPTION, _configBuffer.data(), static_cast<DWORD>(_configBuffer.size()), &bytesNeeded))
+        {
+            entry.info.description = description->lpDescription ? QString::fromWCharArray(description->lpDescription) : QString();
+        }
+    }
 }
 
 ServiceStatus WindowsServiceMonitor::getStatusString(DWORD state) 
@@ -1,16 +1,53 @@
-#pragma once
+﻿#pragma once
 
 #include <DataStructs.h>
 #include <IServiceMonitor.h>
 #include <Windows.h>
+#include <QHash>
+#include <QElapsedTimer>
+#include <atomic>
+#include <vector>
 
-class WindowsServiceMonitor : public IServiceMonitor 
+class WindowsServiceMonitor : public IServiceMonitor
 {
 public:
     WindowsServiceMonitor();
     ~WindowsServiceMonitor() override;
     QList<ServiceInfo> getServices() override;
 
+    static ServiceStatus getStatusString(DWORD state);
+
 private:
-    ServiceStatus getStatusString(DWORD state);
-};
\ No newline at end of file
+    // Срок, после которого неизменяемая часть конфигурации перечитывается, и предел таких перечитываний за такт
+    static constexpr qint64 CONFIG_REFRESH_INTERVAL_MS = 10 * 60 * 1000;
+    static constexpr int CONFIG_REFRESHES_PER_TICK = 8;
+
+    struct ServiceEntry
+    {
+        ServiceInfo info;
+        SC_HANDLE handle = nullptr;
+        PSC_NOTIFICATION_REGISTRATION subscription = nullptr;
+        // Выставляется из потока пула уведомлений SCM
+        std::atomic<bool> statusChanged{ false };
+        QElapsedTimer configAge;
+    };
+
+    static void CALLBACK onDatabaseChange(DWORD notification, PVOID context);
+    static void CALLBACK onStatusChange(DWORD notification, PVOID context);
+
+    bool enumerateServices();
+    ServiceEntry* openEntry(const QString& name);
+    void closeEntry(ServiceEntry* entry);
+    void refreshStatus(ServiceEntry& entry);
+    void refreshConfig(ServiceEntry& entry);
+
+    SC_HANDLE _scm = nullptr;
+    PSC_NOTIFICATION_REGISTRATION _databaseSubscription = nullptr;
+    std::atomic<bool> _databaseChanged{ true };
+    bool _pollingRequired = true;
+
+    QHash<QString, ServiceEntry*> _entries;
+    std::vector<ServiceEntry*> _order;
+    std::vector<BYTE> _enumBuffer;
+    std::vector<BYTE> _configBuffer;
+};
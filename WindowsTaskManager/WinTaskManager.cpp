@@ -1,36 +1,124 @@
 ﻿#include "WinTaskManager.h"
-#include "WindowsSystemMonitor.h"
-#include "WindowsProcessControl.h"
 #include "WindowsProcessTreeBuilder.h"
-#include "WindowsDiskMonitor.h"
-#include "WindowsNetworkMonitor.h"
-#include <WindowsGPUMonitor.h>
-#include <WindowsServiceMonitor.h>
+#ifdef Q_OS_WIN
+#include "WindowsProcessControl.h"
 #include "WindowsServiceControl.h"
+#else
+#include "LinuxProcessControl.h"
+#include "LinuxServiceControl.h"
+#endif
 #include "ProcessTableProxyModel.h"
+#include "ProfiledChartView.h"
+#include "SelfProfiler.h"
+#include <QShortcut>
+#include <QClipboard>
+#include <QPushButton>
+#include <QCheckBox>
+#include <QFileDialog>
 
 WinTaskManager::WinTaskManager(QWidget *parent)
     : QMainWindow(parent)
 {
-    _serviceControl = std::make_unique<WindowsServiceControl>();
+#ifdef Q_OS_WIN
+    _serviceOperations = new ServiceOperationQueue(std::make_unique<WindowsServiceControl>(), this);
     _processControl = std::make_unique<WindowsProcessControl>();
+#else
+    _serviceOperations = new ServiceOperationQueue(std::make_unique<LinuxServiceControl>(), this);
+    _processControl = std::make_unique<LinuxProcessControl>();
+#endif
     _treeBuilder = std::make_unique<WindowsProcessTreeBuilder>();
 
     _dataThread = new QThread();
+    _dataThread->setObjectName("DataUpdater");
+    QThread::currentThread()->setObjectName("GUI");
     _dataUpdater = new DataUpdater(1000);
     _dataUpdater->moveToThread(_dataThread);
     connect(_dataThread, &QThread::started, _dataUpdater, &DataUpdater::update);
+    connect(_dataThread, &QThread::started, _dataUpdater, &DataUpdater::start);
     connect(_dataUpdater, &DataUpdater::dataReady, this, &WinTaskManager::onDataReady);
+    connect(_dataUpdater, &DataUpdater::backgroundHistoryReady, this, &WinTaskManager::onBackgroundHistoryReady);
+    connect(_dataUpdater, &DataUpdater::networkBurstReady, this, &WinTaskManager::onNetworkBurstReady);
 
     setupUI();
+    updateDataSubscriptions();
 
     _dataThread->start();
-    _dataUpdater->start();
 }
 
 WinTaskManager::~WinTaskManager()
 {}
 
+void WinTaskManager::changeEvent(QEvent* event)
+{
+    QMainWindow::changeEvent(event);
+    if (event->type() == QEvent::WindowStateChange)
+    {
+        updateDataSubscriptions();
+        QMetaObject::invokeMethod(_dataUpdater, "setBackgroundMode", Qt::QueuedConnection, Q_ARG(bool, isMinimized()));
+
+        // Скрываем после обработки события, иначе оконная система может вернуть окно на панель задач
+        if (isMinimized() && _trayIcon)
+        {
+            QTimer::singleShot(0, this, &QWidget::hide);
+        }
+    }
+}
+
+void WinTaskManager::updateDataSubscriptions()
+{
+    quint32 wanted = 0;
+    if (!isMinimized())
+    {
+        // История графиков GPU копится на любой вкладке, как и у остальных графиков производительности
+        wanted |= dcGPU;
+
+        QWidget* currentWidget = _tabWidget->currentWidget();
+        if (currentWidget == _processesTab || currentWidget == _treeTab)
+        {
+            // Службы нужны для подсказок процессов-хостов; после перехода на уведомления SCM их сбор почти бесплатен
+            wanted |= dcProcessList | dcProcessIO | dcProcessNetwork | dcServices;
+        }
+        else if (currentWidget == _servicesTab)
+        {
+            wanted |= dcServices;
+        }
+        else if (currentWidget == _connectionsTab)
+        {
+            wanted |= dcConnections;
+        }
+        else if (currentWidget == _performanceTab && _performanceStack->currentWidget() == _cpuPerformancePage)
+        {
+            wanted |= dcCpuCores;
+        }
+        else if (currentWidget == _performanceTab && _performanceStack->currentWidget() == _networkPerformancePage)
+        {
+            wanted |= dcNetworkBurst;
+        }
+    }
+
+    _dataUpdater->subscribe(wanted & ~_dataSubscriptions);
+    _dataUpdater->unsubscribe(_dataSubscriptions & ~wanted);
+    _dataSubscriptions = wanted;
+}
+
+void WinTaskManager::updateProcessDetailFields()
+{
+    quint32 fields = 0;
+    for (int column = 0; column < _processModel->columnCount(); column++)
+    {
+        if (ProcessTableModel::isExtendedColumn(column) && !_processTableView->isColumnHidden(column))
+        {
+            fields |= ProcessTableModel::columnDetailField(column);
+        }
+    }
+    if (fields == _processDetailFields)
+    {
+        return;
+    }
+    _processDetailFields = fields;
+    QMetaObject::invokeMethod(_dataUpdater, "setProcessDetailFields", Qt::QueuedConnection, Q_ARG(quint32, fields));
+}
+
 void WinTaskManager::setupUI()
 {
     setupStyles();
@@ -48,6 +136,7 @@ void WinTaskManager::setupUI()
     // Сортировка
     _processModel = new ProcessTableModel(this);
     _processModel->setProcessControl(_processControl.get());
+    _processModel->setServiceGraph(&_serviceGraph);
 
     _proxyModel = new ProcessTableProxyModel(this);
     _proxyModel->setSourceModel(_processModel);
@@ -57,6 +146,30 @@ void WinTaskManager::setupUI()
     _processTableView->setSortingEnabled(true);
     _processTableView->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
 
+    // Дополнительные колонки скрыты, пока их не включат в контекстном меню заголовка
+    QHeaderView* processHeader = _processTableView->horizontalHeader();
+    processHeader->setContextMenuPolicy(Qt::CustomContextMenu);
+    _processColumnsMenu = new QMenu(this);
+    for (int column = 0; column < _processModel->columnCount(); column++)
+    {
+        if (!ProcessTableModel::isExtendedColumn(column))
+        {
+            continue;
+        }
+        _processTableView->setColumnHidden(column, true);
+        QAction* columnAction = _processColumnsMenu->addAction(_processModel->headerData(column, Qt::Horizontal).toString());
+        columnAction->setCheckable(true);
+        connect(columnAction, &QAction::toggled, this, [this, column](bool checked)
+            {
+            _processTableView->setColumnHidden(column, !checked);
+            updateProcessDetailFields();
+        });
+    }
+    connect(processHeader, &QHeaderView::customContextMenuRequested, this, [this, processHeader](const QPoint& pos)
+        {
+        _processColumnsMenu->exec(processHeader->mapToGlobal(pos));
+    });
+
     connect(_filterLineEdit, &QLineEdit::textChanged, this, &WinTaskManager::onFilterLineEditTextChanged);
 
     processLayout->addWidget(_filterLineEdit);
@@ -72,14 +185,60 @@ void WinTaskManager::setupUI()
 
     setUpServicesTab();
 
+    setUpConnectionsTab();
+
     // === Add Tabs ===
     _tabWidget->addTab(_processesTab, "Процессы");
     _tabWidget->addTab(_treeTab, "Дерево процессов");
     _tabWidget->addTab(_performanceTab, "Производительность");
     _tabWidget->addTab(_servicesTab, "Службы");
+    _tabWidget->addTab(_connectionsTab, "Соединения");
+
+    connect(_tabWidget, &QTabWidget::currentChanged, this, &WinTaskManager::renderPerformanceCharts);
+    connect(_tabWidget, &QTabWidget::currentChanged, this, &WinTaskManager::updateDataSubscriptions);
+    connect(_performanceStack, &QStackedWidget::currentChanged, this, &WinTaskManager::updateDataSubscriptions);
 
     setCentralWidget(_tabWidget);
     setWindowTitle("WinTaskManager");
+    setWindowIcon(QIcon(":/WinTop/WinTop.ico"));
+
+    setUpTrayIcon();
+}
+
+void WinTaskManager::setUpTrayIcon()
+{
+    if (!QSystemTrayIcon::isSystemTrayAvailable())
+    {
+        return;
+    }
+
+    _trayMenu = new QMenu(this);
+    auto* restoreAction = new QAction("Открыть", this);
+    auto* quitAction = new QAction("Выход", this);
+    _trayMenu->addAction(restoreAction);
+    _trayMenu->addAction(quitAction);
+
+    _trayIcon = new QSystemTrayIcon(windowIcon(), this);
+    _trayIcon->setToolTip("WinTaskManager");
+    _trayIcon->setContextMenu(_trayMenu);
+
+    connect(restoreAction, &QAction::triggered, this, &WinTaskManager::restoreFromTray);
+    connect(quitAction, &QAction::triggered, qApp, &QApplication::quit);
+    connect(_trayIcon, &QSystemTrayIcon::activated, this, [this](QSystemTrayIcon::ActivationReason reason)
+        {
+        if (reason == QSystemTrayIcon::Trigger || reason == QSystemTrayIcon::DoubleClick)
+        {
+            restoreFromTray();
+        }
+    });
+
+    _trayIcon->show();
+}
+
+void WinTaskManager::restoreFromTray()
+{
+    showNormal();
+    activateWindow();
 }
 
 void WinTaskManager::onProcessContextMenu(const QPoint& pos)
@@ -183,6 +342,7 @@ void WinTaskManager::setUpProcessTree()
     _processTreeModel = new ProcessTreeModel(this);
     _processTreeModel->setTreeBuilder(std::move(_treeBuilder));
     _processTreeModel->setProcessControl(_processControl.get());
+    _processTreeModel->setServiceGraph(&_serviceGraph);
     _treeProxyModel = new QSortFilterProxyModel(this);
     _treeProxyModel->setSourceModel(_processTreeModel);
     _treeProxyModel->setSortRole(Qt::UserRole);
@@ -226,7 +386,24 @@ void WinTaskManager::setUpPerformanceTab()
     gpuItem->setText(0, "GPU");
     gpuItem->setData(0, Qt::UserRole, "gpu");
 
-    perfLayout->addWidget(_performanceTree);
+    // Скрытая страница самоизмерения, показывается по Ctrl+Shift+P
+    _selfItem = new QTreeWidgetItem(_performanceTree);
+    _selfItem->setText(0, "Self");
+    _selfItem->setData(0, Qt::UserRole, "self");
+    _selfItem->setHidden(true);
+
+    // Окно графиков: история хранится за час, на экран выводится выбранный интервал
+    _chartWindowCombo = new QComboBox();
+    _chartWindowCombo->setMaximumWidth(150);
+    _chartWindowCombo->addItem("100 секунд", 100);
+    _chartWindowCombo->addItem("5 минут", 300);
+    _chartWindowCombo->addItem("15 минут", 900);
+    _chartWindowCombo->addItem("1 час", 3600);
+
+    auto* sideLayout = new QVBoxLayout();
+    sideLayout->addWidget(_performanceTree);
+    sideLayout->addWidget(_chartWindowCombo);
+    perfLayout->addLayout(sideLayout);
 
     // Основная область (графики)
     _performanceStack = new QStackedWidget();
@@ -260,16 +437,22 @@ void WinTaskManager::setUpPerformanceTab()
     _diskSeriesWrite->attachAxis(_diskAxisX);
     _diskSeriesWrite->attachAxis(_diskAxisY);
 
-    _diskChartView = new QChartView(_diskChart);
+    _diskChartView = new ProfiledChartView(_diskChart, "paint.diskChart");
     _diskChartView->setRenderHint(QPainter::Antialiasing);
 
     diskPerfLayout->addWidget(_diskChartView);
 
+    // Графики по физическим дискам в две колонки
+    _physicalDiskChartsLayout = new QGridLayout();
+    diskPerfLayout->addLayout(_physicalDiskChartsLayout);
+
     // === Информация о диске (внизу) ===
     _diskInfoTree = new QTreeWidget();
     _diskInfoTree->setHeaderHidden(true);
     _diskInfoTree->setRootIsDecorated(false); // убираем иконки
 
+    _diskInfoPanel.setTree(_diskInfoTree);
+
     _diskInfoScroll = new QScrollArea();
     _diskInfoScroll->setWidget(_diskInfoTree);
     _diskInfoScroll->setWidgetResizable(true);
@@ -283,6 +466,8 @@ void WinTaskManager::setUpPerformanceTab()
     
     setUpGPUPerformanceTab();
 
+    setUpSelfPerformanceTab();
+
     perfLayout->addWidget(_performanceStack);
 
     connect(_performanceTree, &QTreeWidget::currentItemChanged, this, [this](QTreeWidgetItem* current, QTreeWidgetItem* previous)
@@ -298,6 +483,15 @@ void WinTaskManager::setUpPerformanceTab()
         }
     });
 
+    connect(_chartWindowCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int index)
+        {
+        _chartWindow = _chartWindowCombo->itemData(index).toInt();
+        _cpuCoreGrid->setSampleWindow(_chartWindow);
+        renderPerformanceCharts();
+    });
+
+    connect(_performanceStack, &QStackedWidget::currentChanged, this, &WinTaskManager::renderPerformanceCharts);
+
     _performanceTree->setCurrentItem(_performanceTree->topLevelItem(0));
 
 }
@@ -319,62 +513,165 @@ void WinTaskManager::setUpServicesTab()
     // Настройка таблицы
     _servicesTableView->setAlternatingRowColors(true);
     _servicesTableView->setSortingEnabled(true);
+    _servicesTableView->setSelectionBehavior(QAbstractItemView::SelectRows);
     _servicesTableView->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeMode::Interactive);
 
     // === Контекстное меню для служб ===
     _serviceContextMenu = new QMenu(this);
     _startServiceAction = new QAction("Запустить службу", this);
     _stopServiceAction = new QAction("Остановить службу", this);
+    _goToServiceProcessAction = new QAction("Перейти к процессу", this);
 
     _serviceContextMenu->addAction(_startServiceAction);
     _serviceContextMenu->addAction(_stopServiceAction);
+    _serviceContextMenu->addSeparator();
+    _serviceContextMenu->addAction(_goToServiceProcessAction);
 
     _servicesTableView->setContextMenuPolicy(Qt::CustomContextMenu);
     connect(_servicesTableView, &QTableView::customContextMenuRequested,
         this, &WinTaskManager::onServiceContextMenu);
 
+    // Команды выполняются в пуле потоков, GUI не ждёт ни отправки, ни перехода службы в конечное состояние
     connect(_startServiceAction, &QAction::triggered, this, [this]()
         {
-        if (!_selectedServiceName.isEmpty()) 
+        _serviceOperations->enqueue(_selectedServiceNames, soStart);
+        });
+
+    connect(_stopServiceAction, &QAction::triggered, this, [this]() 
         {
-            if (_serviceControl.get()->startService(_selectedServiceName)) 
+        // Работающие зависимые службы останавливаются раньше выбранных, иначе SCM откажет в остановке
+        QList<QStringList> stages = _serviceGraph.stopOrder(_selectedServiceNames);
+        QStringList dependents;
+        for (const auto& stage : stages)
+        {
+            for (const QString& serviceName : stage)
             {
-                QMessageBox::information(this, "Успешно", "Служба запущена.");
+                if (!_selectedServiceNames.contains(serviceName, Qt::CaseInsensitive))
+                {
+                    dependents.append(serviceName);
+                }
             }
-            else 
+        }
+
+        if (!dependents.isEmpty())
+        {
+            QMessageBox::StandardButton reply = QMessageBox::question(this, "Подтверждение",
+                QString("От выбранных служб зависят работающие службы, они тоже будут остановлены:\n%1\n\nПродолжить?")
+                .arg(dependents.join('\n')),
+                QMessageBox::Yes | QMessageBox::No);
+            if (reply != QMessageBox::Yes)
             {
-                QMessageBox::critical(this, "Ошибка", "Не удалось запустить службу.");
+                return;
             }
         }
+        _serviceOperations->enqueueStages(stages, soStop);
         });
 
-    connect(_stopServiceAction, &QAction::triggered, this, [this]() 
+    connect(_goToServiceProcessAction, &QAction::triggered, this, [this]()
         {
-        if (!_selectedServiceName.isEmpty()) 
+        quint32 pid = _serviceGraph.processId(_selectedServiceNames.value(0));
+        _tabWidget->setCurrentWidget(_processesTab);
+
+        int row = _processModel->rowOfProcess(pid);
+        QModelIndex proxyIndex = row < 0 ? QModelIndex() : _proxyModel->mapFromSource(_processModel->index(row, 0));
+        if (proxyIndex.isValid())
         {
-            if (_serviceControl.get()->stopService(_selectedServiceName)) 
-            {
-                QMessageBox::information(this, "Успешно", "Служба остановлена.");
-            }
-            else 
-            {
-                QMessageBox::critical(this, "Ошибка", "Не удалось остановить службу.");
-            }
+            _processTableView->selectRow(proxyIndex.row());
+            _processTableView->scrollTo(proxyIndex);
         }
         });
 
+    // Строка обновляется по ходу операции, не дожидаясь очередного такта сбора данных
+    connect(_serviceOperations, &ServiceOperationQueue::statusChanged, _servicesModel, &ServiceTableModel::setServiceStatus);
+    connect(_serviceOperations, &ServiceOperationQueue::batchFinished, this, [this](ServiceOperation operation, int total, const QStringList& failed)
+        {
+        if (failed.isEmpty())
+        {
+            return;
+        }
+        QString action = operation == soStart ? "запустить" : "остановить";
+        QMessageBox::critical(this, "Ошибка", QString("Не удалось %1 службы (%2 из %3):\n%4")
+            .arg(action).arg(failed.size()).arg(total).arg(failed.join('\n')));
+        });
+
     servicesLayout->addWidget(_servicesTableView);
 }
 
+void WinTaskManager::setUpConnectionsTab()
+{
+    _connectionsTab = new QWidget();
+    auto* connectionsLayout = new QVBoxLayout(_connectionsTab);
+
+    _connectionsSummaryLabel = new QLabel();
+
+    _connectionsTableView = new QTableView();
+    _connectionsModel = new ConnectionTableModel(this);
+
+    _connectionsProxyModel = new QSortFilterProxyModel(this);
+    _connectionsProxyModel->setSourceModel(_connectionsModel);
+    _connectionsProxyModel->setSortRole(Qt::UserRole);
+    // Строки приходят вставками и удалениями, прокси досортировывает их сам
+    _connectionsProxyModel->setDynamicSortFilter(true);
+
+    _connectionsTableView->setModel(_connectionsProxyModel);
+    _connectionsTableView->setAlternatingRowColors(true);
+    _connectionsTableView->setSortingEnabled(true);
+    _connectionsTableView->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeMode::Interactive);
+    _connectionsTableView->horizontalHeader()->setStretchLastSection(true);
+
+    connectionsLayout->addWidget(_connectionsSummaryLabel);
+    connectionsLayout->addWidget(_connectionsTableView);
+
+    updateConnectionsSummary();
+}
+
+void WinTaskManager::updateConnectionsSummary()
+{
+    int tcpCount = _connectionsModel->rowCount() - _connectionsModel->stateCount(csNone);
+    _connectionsSummaryLabel->setText(QString("TCP: %1 (установлено: %2, прослушивание: %3, TIME_WAIT: %4, CLOSE_WAIT: %5)   UDP: %6")
+        .arg(tcpCount)
+        .arg(_connectionsModel->stateCount(csEstablished))
+        .arg(_connectionsModel->stateCount(csListen))
+        .arg(_connectionsModel->stateCount(csTimeWait))
+        .arg(_connectionsModel->stateCount(csCloseWait))
+        .arg(_connectionsModel->stateCount(csNone)));
+}
+
 void WinTaskManager::setUpNetworkPerformanceTab()
 {
     // === Страница сети ===
     _networkPerformancePage = new QWidget();
     auto* networkPerfLayout = new QVBoxLayout(_networkPerformancePage);
 
-    // Выпадающий список
+    // Выпадающий список и фильтр по типам адаптеров (Ethernet и Wi-Fi показываются всегда)
+    auto* adapterLayout = new QHBoxLayout();
     _networkAdapterCombo = new QComboBox();
-    networkPerfLayout->addWidget(_networkAdapterCombo);
+    adapterLayout->addWidget(_networkAdapterCombo, 1);
+
+    const QList<QPair<QString, NetworkAdapterType>> adapterFilters = {
+        { "Виртуальные", natVirtual }, { "Туннели", natTunnel }, { "Loopback", natLoopback }, { "Прочие", natOther } };
+    for (const auto& filter : adapterFilters)
+    {
+        auto* filterCheckBox = new QCheckBox(filter.first);
+        filterCheckBox->setChecked(_networkAdapterFilter & filter.second);
+        adapterLayout->addWidget(filterCheckBox);
+
+        NetworkAdapterType type = filter.second;
+        connect(filterCheckBox, &QCheckBox::toggled, this, [this, type](bool checked)
+            {
+            if (checked)
+            {
+                _networkAdapterFilter |= type;
+            }
+            else
+            {
+                _networkAdapterFilter &= ~static_cast<quint32>(type);
+            }
+            QMetaObject::invokeMethod(_dataUpdater, "setNetworkAdapterFilter", Qt::QueuedConnection, Q_ARG(quint32, _networkAdapterFilter));
+            _networkAdapterListDirty = true;
+        });
+    }
+    networkPerfLayout->addLayout(adapterLayout);
 
     // График
     _networkChart = new QChart();
@@ -382,8 +679,17 @@ void WinTaskManager::setUpNetworkPerformanceTab()
     _networkSeriesRecv->setName("Приём");
     _networkSeriesSent = new QLineSeries();
     _networkSeriesSent->setName("Отправка");
+    _networkSeriesRecvPeak = new QLineSeries();
+    _networkSeriesRecvPeak->setName("Пик приёма");
+    _networkSeriesSentPeak = new QLineSeries();
+    _networkSeriesSentPeak->setName("Пик отправки");
     _networkChart->addSeries(_networkSeriesRecv);
     _networkChart->addSeries(_networkSeriesSent);
+    _networkChart->addSeries(_networkSeriesRecvPeak);
+    _networkChart->addSeries(_networkSeriesSentPeak);
+    // Пики - пунктиром того же цвета, что и средняя скорость
+    _networkSeriesRecvPeak->setPen(QPen(_networkSeriesRecv->color(), 1, Qt::DashLine));
+    _networkSeriesSentPeak->setPen(QPen(_networkSeriesSent->color(), 1, Qt::DashLine));
     _networkChart->legend()->show();
 
     _networkAxisX = new QValueAxis;
@@ -396,8 +702,12 @@ void WinTaskManager::setUpNetworkPerformanceTab()
     _networkSeriesRecv->attachAxis(_networkAxisY);
     _networkSeriesSent->attachAxis(_networkAxisX);
     _networkSeriesSent->attachAxis(_networkAxisY);
+    _networkSeriesRecvPeak->attachAxis(_networkAxisX);
+    _networkSeriesRecvPeak->attachAxis(_networkAxisY);
+    _networkSeriesSentPeak->attachAxis(_networkAxisX);
+    _networkSeriesSentPeak->attachAxis(_networkAxisY);
 
-    _networkChartView = new QChartView(_networkChart);
+    _networkChartView = new ProfiledChartView(_networkChart, "paint.networkChart");
     _networkChartView->setRenderHint(QPainter::Antialiasing);
 
     networkPerfLayout->addWidget(_networkChartView);
@@ -407,6 +717,8 @@ void WinTaskManager::setUpNetworkPerformanceTab()
     _networkInfoTree->setHeaderHidden(true);
     _networkInfoTree->setRootIsDecorated(false);
 
+    _networkInfoPanel.setTree(_networkInfoTree);
+
     _networkInfoScroll = new QScrollArea();
     _networkInfoScroll->setWidget(_networkInfoTree);
     _networkInfoScroll->setWidgetResizable(true);
@@ -444,14 +756,18 @@ void WinTaskManager::setUpNetworkPerformanceTab()
             {
                 _performanceStack->setCurrentWidget(_memoryPerformancePage);
             }
+            else if (resource == "self")
+            {
+                _performanceStack->setCurrentWidget(_selfPerformancePage);
+                updateSelfPerformancePage();
+            }
         }
     });
 
     connect(_networkAdapterCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int index) 
         {
         // Очищаем графики при смене адаптера
-        _networkSeriesRecv->clear();
-        _networkSeriesSent->clear();
+        resetNetworkChart();
     });
 }
 
@@ -471,7 +787,7 @@ void WinTaskManager::setUpGPUPerformanceTab()
     _gpuChart->addAxis(_gpuAxisX, Qt::AlignBottom);
     _gpuChart->addAxis(_gpuAxisY, Qt::AlignLeft);
 
-    _gpuChartView = new QChartView(_gpuChart);
+    _gpuChartView = new ProfiledChartView(_gpuChart, "paint.gpuChart");
     _gpuChartView->setRenderHint(QPainter::Antialiasing);
 
     gpuPerfLayout->addWidget(_gpuChartView);
@@ -481,6 +797,8 @@ void WinTaskManager::setUpGPUPerformanceTab()
     _gpuInfoTree->setHeaderHidden(true);
     _gpuInfoTree->setRootIsDecorated(false);
 
+    _gpuInfoPanel.setTree(_gpuInfoTree);
+
     _gpuInfoScroll = new QScrollArea();
     _gpuInfoScroll->setWidget(_gpuInfoTree);
     _gpuInfoScroll->setWidgetResizable(true);
@@ -511,16 +829,24 @@ void WinTaskManager::setUpCPUPerformanceTab()
     _cpuSeries->attachAxis(_cpuAxisX);
     _cpuSeries->attachAxis(_cpuAxisY);
 
-    _cpuChartView = new QChartView(_cpuChart);
+    _cpuChartView = new ProfiledChartView(_cpuChart, "paint.cpuChart");
     _cpuChartView->setRenderHint(QPainter::Antialiasing);
 
-    cpuPerfLayout->addWidget(_cpuChartView);
+    cpuPerfLayout->addWidget(_cpuChartView, 2);
+
+    // Загрузка логических процессоров
+    _cpuCoreGrid = new CpuCoreGridWidget();
+    _cpuCoreGrid->setHistories(&_cpuCoreHistories);
+    _cpuCoreGrid->setSampleWindow(_chartWindow);
+    cpuPerfLayout->addWidget(_cpuCoreGrid, 3);
 
     // Информация о CPU (внизу) 
     _cpuInfoTree = new QTreeWidget();
     _cpuInfoTree->setHeaderHidden(true);
     _cpuInfoTree->setRootIsDecorated(false);
 
+    _cpuInfoPanel.setTree(_cpuInfoTree);
+
     _cpuInfoScroll = new QScrollArea();
     _cpuInfoScroll->setWidget(_cpuInfoTree);
     _cpuInfoScroll->setWidgetResizable(true);
@@ -552,7 +878,7 @@ void WinTaskManager::setUpMemoryPerformanceTab()
     _memorySeriesUsed->attachAxis(_memoryAxisX);
     _memorySeriesUsed->attachAxis(_memoryAxisY);
 
-    _memoryChartView = new QChartView(_memoryChart);
+    _memoryChartView = new ProfiledChartView(_memoryChart, "paint.memoryChart");
     _memoryChartView->setRenderHint(QPainter::Antialiasing);
 
     memoryPerfLayout->addWidget(_memoryChartView);
@@ -562,6 +888,8 @@ void WinTaskManager::setUpMemoryPerformanceTab()
     _memoryInfoTree->setHeaderHidden(true);
     _memoryInfoTree->setRootIsDecorated(false);
 
+    _memoryInfoPanel.setTree(_memoryInfoTree);
+
     _memoryInfoScroll = new QScrollArea();
     _memoryInfoScroll->setWidget(_memoryInfoTree);
     _memoryInfoScroll->setWidgetResizable(true);
@@ -572,72 +900,221 @@ void WinTaskManager::setUpMemoryPerformanceTab()
     _performanceStack->addWidget(_memoryPerformancePage);
 }
 
+void WinTaskManager::setUpSelfPerformanceTab()
+{
+    _selfPerformancePage = new QWidget();
+    auto* selfPerfLayout = new QVBoxLayout(_selfPerformancePage);
+
+    // Таблица этапов: время стены и процессорное время в микросекундах
+    _selfStatsTree = new QTreeWidget();
+    _selfStatsTree->setRootIsDecorated(false);
+    _selfStatsTree->setAlternatingRowColors(true);
+    _selfStatsTree->setHeaderLabels({ "Этап", "Вызовов", "Стена p50, мкс", "Стена p99, мкс", "Стена max, мкс", "ЦП p50, мкс", "ЦП p99, мкс", "ЦП max, мкс", "ЦП всего, мс" });
+    _selfStatsTree->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+    // Загрузка ЦП процессом в долях от всех логических процессоров, как в диспетчере задач
+    _selfCpuLabel = new QLabel();
+    selfPerfLayout->addWidget(_selfCpuLabel);
+
+    selfPerfLayout->addWidget(_selfStatsTree);
+
+    auto* buttonsLayout = new QHBoxLayout();
+    auto* traceCheckBox = new QCheckBox("Трассировка");
+    auto* saveTraceButton = new QPushButton("Сохранить трассу...");
+    buttonsLayout->addWidget(traceCheckBox);
+    buttonsLayout->addWidget(saveTraceButton);
+    auto* copyButton = new QPushButton("Копировать отчёт");
+    auto* resetButton = new QPushButton("Сбросить");
+    buttonsLayout->addStretch();
+    buttonsLayout->addWidget(copyButton);
+    buttonsLayout->addWidget(resetButton);
+    selfPerfLayout->addLayout(buttonsLayout);
+
+    connect(copyButton, &QPushButton::clicked, this, []()
+        {
+        QApplication::clipboard()->setText(SelfProfiler::instance().dump());
+    });
+
+    connect(traceCheckBox, &QCheckBox::toggled, this, [](bool checked)
+        {
+        SpanTracer::instance().setEnabled(checked);
+    });
+
+    // Формат выбирается по расширению: .json для chrome://tracing, .perfetto-trace для ui.perfetto.dev
+    connect(saveTraceButton, &QPushButton::clicked, this, [this]()
+        {
+        QString filePath = QFileDialog::getSaveFileName(this, "Сохранить трассу", "wintop.json",
+            "Chrome JSON (*.json);;Perfetto (*.perfetto-trace)");
+        if (filePath.isEmpty())
+        {
+            return;
+        }
+
+        bool saved = filePath.endsWith(".perfetto-trace")
+            ? SpanTracer::instance().writePerfetto(filePath)
+            : SpanTracer::instance().writeChromeJson(filePath);
+        if (!saved)
+        {
+            QMessageBox::critical(this, "Ошибка", "Не удалось сохранить трассу.");
+        }
+    });
+
+    connect(resetButton, &QPushButton::clicked, this, [this]()
+        {
+        SelfProfiler::instance().reset();
+        updateSelfPerformancePage();
+    });
+
+    auto* toggleShortcut = new QShortcut(QKeySequence("Ctrl+Shift+P"), this);
+    connect(toggleShortcut, &QShortcut::activated, this, [this]()
+        {
+        _selfItem->setHidden(!_selfItem->isHidden());
+        if (!_selfItem->isHidden())
+        {
+            _tabWidget->setCurrentWidget(_performanceTab);
+            _performanceTree->setCurrentItem(_selfItem);
+        }
+    });
+
+    _performanceStack->addWidget(_selfPerformancePage);
+}
+
+void WinTaskManager::updateSelfPerformancePage()
+{
+    _selfCpuLabel->setText(QString("Загрузка ЦП приложением: %1% (в фоновом режиме: %2%)")
+        .arg(_selfCpuUsage, 0, 'f', 3)
+        .arg(_backgroundSelfCpuUsage, 0, 'f', 3));
+
+    QList<StageStats> stages = SelfProfiler::instance().snapshot();
+
+    // Набор этапов только растёт, поэтому строки создаются один раз и дальше обновляются на месте
+    while (_selfStatsTree->topLevelItemCount() < stages.size())
+    {
+        new QTreeWidgetItem(_selfStatsTree);
+    }
+
+    for (int i = 0; i < stages.size(); i++)
+    {
+        const StageStats& stats = stages[i];
+        QTreeWidgetItem* item = _selfStatsTree->topLevelItem(i);
+        item->setText(0, stats.name);
+        item->setText(1, QString::number(stats.count));
+        item->setText(2, QString::number(stats.wallP50Us, 'f', 0));
+        item->setText(3, QString::number(stats.wallP99Us, 'f', 0));
+        item->setText(4, QString::number(stats.wallMaxUs));
+        item->setText(5, QString::number(stats.cpuP50Us, 'f', 0));
+        item->setText(6, QString::number(stats.cpuP99Us, 'f', 0));
+        item->setText(7, QString::number(stats.cpuMaxUs));
+        item->setText(8, QString::number(stats.cpuTotalUs / 1000.0, 'f', 1));
+    }
+}
+
 void WinTaskManager::updateNetworkAdapterList(const QList<NetworkInterfaceInfo>& networkInfo) 
 {
+    // Выбранный адаптер сохраняется, если он остался в списке, иначе смена выбора очистит графики
+    QString selectedAdapter = _networkAdapterCombo->currentData().toString();
 
+    _networkAdapterCombo->blockSignals(true);
     _networkAdapterCombo->clear();
-
     for (const auto& net : networkInfo) 
     {
-        // Добавляем только активные адаптеры
-        _networkAdapterCombo->addItem(QString("%1 (%2)").arg(net.description), net.name);
+        QString title = net.description == net.name ? net.name : QString("%1 (%2)").arg(net.description, net.name);
+        if (!net.isUp)
+        {
+            title += " - отключён";
+        }
+        _networkAdapterCombo->addItem(title, net.name);
+    }
+    int selectedIndex = _networkAdapterCombo->findData(selectedAdapter);
+    _networkAdapterCombo->setCurrentIndex(selectedIndex >= 0 ? selectedIndex : 0);
+    _networkAdapterCombo->blockSignals(false);
+
+    if (selectedIndex < 0)
+    {
+        resetNetworkChart();
     }
 }
 
-void WinTaskManager::updatePerformanceTab(const SystemInfo& info, const DisksInfo& disksInfo, const QList<NetworkInterfaceInfo>& networkInfo, const QList<GPUInfo>& gpuInfo)
+void WinTaskManager::resetNetworkChart()
 {
-    // Сохраняем состояния
-    QStringList diskExpanded = getExpandedItems(_diskInfoTree);
-    QStringList networkExpanded = getExpandedItems(_networkInfoTree);
-    QStringList gpuExpanded = getExpandedItems(_gpuInfoTree);
-    QStringList cpuExpanded = getExpandedItems(_cpuInfoTree);
-    QStringList memoryExpanded = getExpandedItems(_memoryInfoTree);
+    _networkRecvHistory.clear();
+    _networkSentHistory.clear();
+    _networkRecvPeakHistory.clear();
+    _networkSentPeakHistory.clear();
+    _networkSeriesRecv->clear();
+    _networkSeriesSent->clear();
+    _networkSeriesRecvPeak->clear();
+    _networkSeriesSentPeak->clear();
+
+    // Частые замеры идут только для адаптера на графике
+    _networkBurstAge = NETWORK_BURST_MAX_AGE + 1;
+    QMetaObject::invokeMethod(_dataUpdater, "setNetworkBurstInterface", Qt::QueuedConnection,
+        Q_ARG(QString, _networkAdapterCombo->currentData().toString()));
+}
 
-    // Обновляем данные диска
-    
-    // Обновляем график диска
-    static int diskX = 0;
-    double totalRead = disksInfo.readBytesPerSec, totalWrite = disksInfo.writeBytesPerSec;
-    _diskSeriesRead->append(diskX, totalRead / 1024 / 1024); // в МБ/с
-    _diskSeriesWrite->append(diskX, totalWrite / 1024 / 1024);
-    diskX++;
-    if (_diskSeriesRead->count() > 100)
+void WinTaskManager::onNetworkBurstReady(const NetworkBurstSample& sample)
+{
+    // Сводка могла уйти до смены адаптера
+    if (sample.interfaceName != _networkAdapterCombo->currentData().toString())
     {
-        _diskSeriesRead->removePoints(0, 1);
-        _diskSeriesWrite->removePoints(0, 1);
+        return;
     }
-    _diskAxisX->setRange(diskX - 100, diskX);
+    _lastNetworkBurst = sample;
+    _networkBurstAge = 0;
+}
+
+void WinTaskManager::updatePerformanceTab(const SystemInfo& info, const DisksInfo& disksInfo, const QList<NetworkInterfaceInfo>& networkInfo, const QList<GPUInfo>& gpuInfo, quint32 dataClasses)
+{
+    // Обновляем данные диска
+    
+    // Обновляем историю графика диска
+    _diskReadHistory.append(disksInfo.readBytesPerSec / 1024 / 1024); // в МБ/с
+    _diskWriteHistory.append(disksInfo.writeBytesPerSec / 1024 / 1024);
+    updatePhysicalDiskCharts(disksInfo.physicalDisks);
 
     // Обновляем информацию о диске
-    _diskInfoTree->clear();
-    auto* diskGroup = new QTreeWidgetItem(_diskInfoTree);
-    diskGroup->setText(0, "Диски");
-    for (const auto& disk : disksInfo.disks)
     {
-        auto* item = new QTreeWidgetItem(diskGroup);
-        diskGroup->setExpanded(true); 
-        item->setText(0, QString("%1: %2 ГБ / %3 ГБ")
-            .arg(disk.name)
-            .arg((disk.totalBytes - disk.freeBytes) / 1024.0 / 1024.0 / 1024.0, 0, 'f', 2)
-            .arg(disk.totalBytes / 1024.0 / 1024.0 / 1024.0, 0, 'f', 2));
-    }
+        SELF_PROFILE_SCOPE("info.disk");
+        _diskInfoPanel.beginUpdate();
+        _diskInfoPanel.setItem("disks", "Диски", QString(), true);
+        for (const auto& disk : disksInfo.disks)
+        {
+            _diskInfoPanel.setItem("disks/" + disk.name, QString("%1: %2 ГБ / %3 ГБ")
+                .arg(disk.name)
+                .arg((disk.totalBytes - disk.freeBytes) / 1024.0 / 1024.0 / 1024.0, 0, 'f', 2)
+                .arg(disk.totalBytes / 1024.0 / 1024.0 / 1024.0, 0, 'f', 2), "disks");
+        }
 
-    // Добавляем общую статистику
-    auto* totalReadItem = new QTreeWidgetItem(diskGroup);
-    totalReadItem->setText(0, QString("Всего прочитано: %1 МБ/с")
-        .arg(disksInfo.readBytesPerSec / 1024 / 1024, 0, 'f', 2));
+        // Общая статистика
+        _diskInfoPanel.setItem("disks/#read", QString("Всего прочитано: %1 МБ/с")
+            .arg(disksInfo.readBytesPerSec / 1024 / 1024, 0, 'f', 2), "disks");
+        _diskInfoPanel.setItem("disks/#write", QString("Всего записано: %1 МБ/с")
+            .arg(disksInfo.writeBytesPerSec / 1024 / 1024, 0, 'f', 2), "disks");
 
-    auto* totalWriteItem = new QTreeWidgetItem(diskGroup);
-    totalWriteItem->setText(0, QString("Всего записано: %1 МБ/с")
-        .arg(disksInfo.writeBytesPerSec / 1024 / 1024, 0, 'f', 2));
+        _diskInfoPanel.setItem("physical", "Физические диски", QString(), true);
+        for (const auto& disk : disksInfo.physicalDisks)
+        {
+            QString diskKey = "physical/" + disk.name;
+            _diskInfoPanel.setItem(diskKey, disk.name, "physical");
+            _diskInfoPanel.setItem(diskKey + "/read", QString("Чтение: %1 МБ/с, %2 оп/с")
+                .arg(disk.readBytesPerSec / 1024 / 1024, 0, 'f', 2)
+                .arg(disk.readOpsPerSec, 0, 'f', 0), diskKey);
+            _diskInfoPanel.setItem(diskKey + "/write", QString("Запись: %1 МБ/с, %2 оп/с")
+                .arg(disk.writeBytesPerSec / 1024 / 1024, 0, 'f', 2)
+                .arg(disk.writeOpsPerSec, 0, 'f', 0), diskKey);
+            _diskInfoPanel.setItem(diskKey + "/latency", QString("Среднее время отклика: %1 мс").arg(disk.averageServiceTimeMs, 0, 'f', 2), diskKey);
+            _diskInfoPanel.setItem(diskKey + "/queue", QString("Длина очереди: %1").arg(disk.queueLength, 0, 'f', 2), diskKey);
+            _diskInfoPanel.setItem(diskKey + "/busy", QString("Активность: %1%").arg(disk.busyPercent, 0, 'f', 1), diskKey);
+        }
+        _diskInfoPanel.endUpdate();
+    }
 
     // Обновляем данные сети 
    
-    // Обновляем график сети
-    static int networkX = 0;
-    double selectedRecv = 0, selectedSent = 0;
+    // Обновляем историю графика сети
     QString selectedAdapter = _networkAdapterCombo->currentData().toString();
-    if (networkX != 0) 
+    double selectedRecv = 0, selectedSent = 0;
+    if (_networkRecvHistory.totalCount() != 0)
     {
         // Статистика для выбранного адаптера
         for (const auto& net : networkInfo) 
@@ -650,74 +1127,221 @@ void WinTaskManager::updatePerformanceTab(const SystemInfo& info, const DisksInf
             }
         }
     }
-
-    _networkSeriesRecv->append(networkX, selectedRecv / 1024 / 128); // в МБит/с
-    _networkSeriesSent->append(networkX, selectedSent / 1024 / 128);
-    networkX++;
-    if (_networkSeriesRecv->count() > 100) 
+    _networkRecvHistory.append(selectedRecv / 1024 / 128); // в МБит/с
+    _networkSentHistory.append(selectedSent / 1024 / 128);
+
+    // Без частых замеров (другая страница, первая секунда) пик совпадает со средней.
+    // Секунды сводки и такта сбора не совпадают, поэтому пик не бывает ниже средней такта
+    bool hasNetworkBurst = _networkBurstAge <= NETWORK_BURST_MAX_AGE;
+    _networkBurstAge = std::min(_networkBurstAge + 1, NETWORK_BURST_MAX_AGE + 1);
+    double peakRecv = selectedRecv, peakSent = selectedSent;
+    if (hasNetworkBurst)
     {
-        _networkSeriesRecv->removePoints(0, 1);
-        _networkSeriesSent->removePoints(0, 1);
+        peakRecv = std::max(peakRecv, _lastNetworkBurst.receiveMaxBytesPerSec);
+        peakSent = std::max(peakSent, _lastNetworkBurst.sendMaxBytesPerSec);
     }
-    _networkAxisX->setRange(networkX - 100, networkX);
+    _networkRecvPeakHistory.append(peakRecv / 1024 / 128);
+    _networkSentPeakHistory.append(peakSent / 1024 / 128);
 
     // Обновляем информацию о сети
-    _networkInfoTree->clear();
-    auto* networkGroup = new QTreeWidgetItem(_networkInfoTree);
-    networkGroup->setText(0, "Сетевые адаптеры");
-    networkGroup->setExpanded(true);
-    for (const auto& net : networkInfo) 
     {
-        if (net.name == selectedAdapter)
+        SELF_PROFILE_SCOPE("info.network");
+        _networkInfoPanel.beginUpdate();
+        _networkInfoPanel.setItem("adapters", "Сетевые адаптеры", QString(), true);
+        for (const auto& net : networkInfo) 
         {
-            auto* adapterGroup = new QTreeWidgetItem(networkGroup);
-            adapterGroup->setText(0, net.description);
+            if (net.name == selectedAdapter)
+            {
+                QString adapterKey = "adapters/" + net.name;
+                _networkInfoPanel.setItem(adapterKey, net.description, "adapters");
+                _networkInfoPanel.setItem(adapterKey + "/recv", QString("Приём: %1 МБит/с")
+                    .arg(net.receiveBytesPerSec / 1024 / 128, 0, 'f', 2), adapterKey);
+                _networkInfoPanel.setItem(adapterKey + "/sent", QString("Отправка: %1 МБит/с")
+                    .arg(net.sendBytesPerSec / 1024 / 128, 0, 'f', 2), adapterKey);
+                if (hasNetworkBurst)
+                {
+                    QString burstKey = adapterKey + "/burst";
+                    _networkInfoPanel.setItem(burstKey, QString("За секунду, %1 замеров (мин / ср / макс, МБит/с)")
+                        .arg(_lastNetworkBurst.samplesCount), adapterKey);
+                    _networkInfoPanel.setItem(burstKey + "/recv", QString("Приём: %1 / %2 / %3")
+                        .arg(_lastNetworkBurst.receiveMinBytesPerSec / 1024 / 128, 0, 'f', 2)
+                        .arg(_lastNetworkBurst.receiveAvgBytesPerSec / 1024 / 128, 0, 'f', 2)
+                        .arg(_lastNetworkBurst.receiveMaxBytesPerSec / 1024 / 128, 0, 'f', 2), burstKey);
+                    _networkInfoPanel.setItem(burstKey + "/sent", QString("Отправка: %1 / %2 / %3")
+                        .arg(_lastNetworkBurst.sendMinBytesPerSec / 1024 / 128, 0, 'f', 2)
+                        .arg(_lastNetworkBurst.sendAvgBytesPerSec / 1024 / 128, 0, 'f', 2)
+                        .arg(_lastNetworkBurst.sendMaxBytesPerSec / 1024 / 128, 0, 'f', 2), burstKey);
+                }
+            }
+        }
+        _networkInfoPanel.endUpdate();
+    }
 
-            auto* recvItem = new QTreeWidgetItem(adapterGroup);
-            recvItem->setText(0, QString("Приём: %1 МБит/с")
-                .arg(net.receiveBytesPerSec / 1024 / 128, 0, 'f', 2));
+    // Без подписки на GPU данные не собирались: графики и панель оставляем как есть
+    if (dataClasses & dcGPU)
+    {
+        // Обновляем историю графиков GPU
+        QSet<QString> currentGpuNames;
+        for (const auto& gpu : gpuInfo) 
+        {
+            QString gpuName = gpu.name;
+            currentGpuNames.insert(gpuName);
 
-            auto* sentItem = new QTreeWidgetItem(adapterGroup);
-            sentItem->setText(0, QString("Отправка: %1 МБит/с")
-                .arg(net.sendBytesPerSec / 1024 / 128, 0, 'f', 2));
+            if (!_gpuSeriesMap.contains(gpuName)) 
+            {
+                // Создаём новый график
+                auto* series = new QLineSeries();
+                series->setName(gpuName); // подпись в легенде
+                _gpuChart->addSeries(series);
+                series->attachAxis(_gpuAxisX);
+                series->attachAxis(_gpuAxisY);
+                _gpuSeriesMap[gpuName] = series;
+                _gpuHistoryMap[gpuName].startAt(_gpuSampleCount);
+            }
+            _gpuHistoryMap[gpuName].append(gpu.usage);
+        }
+        _gpuSampleCount++;
+
+        // Удаляем лишние графики, если видеокарты исчезли
+        for (auto it = _gpuSeriesMap.begin(); it != _gpuSeriesMap.end();) 
+        {
+            if (!currentGpuNames.contains(it.key()))
+            {
+                _gpuChart->removeSeries(it.value());
+                delete it.value();
+                _gpuHistoryMap.remove(it.key());
+                it = _gpuSeriesMap.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        // Обновляем информацию о GPU
+        {
+            SELF_PROFILE_SCOPE("info.gpu");
+            _gpuInfoPanel.beginUpdate();
+            _gpuInfoPanel.setItem("gpus", "Видеокарты", QString(), true);
+            for (const auto& gpu : gpuInfo) 
+            {
+                QString gpuKey = "gpus/" + gpu.name;
+                _gpuInfoPanel.setItem(gpuKey, gpu.name, "gpus");
+                _gpuInfoPanel.setItem(gpuKey + "/usage", QString("Загрузка: %1%").arg(gpu.usage), gpuKey);
+                _gpuInfoPanel.setItem(gpuKey + "/memory", QString("Память: %1 ГБ / %2 ГБ")
+                    .arg(gpu.usedMemoryBytes / 1024.0 / 1024.0 / 1024.0, 0, 'f', 2)
+                    .arg(gpu.totalMemoryBytes / 1024.0 / 1024.0 / 1024.0, 0, 'f', 2), gpuKey);
+                _gpuInfoPanel.setItem(gpuKey + "/power", QString("Потребление: %1 Вт").arg(gpu.powerUsage), gpuKey);
+                _gpuInfoPanel.setItem(gpuKey + "/temperature", QString("Температура: %1 °C").arg(gpu.temperatureCelsius, 0, 'f', 1), gpuKey);
+                _gpuInfoPanel.setItem(gpuKey + "/vendor", QString("Производитель: %1").arg(gpu.vendor), gpuKey);
+            }
+            _gpuInfoPanel.endUpdate();
         }
     }
 
-    // Обновляем график GPU
-    static int gpuX = 0;
-    double maxLoad = 0;
-    for (const auto& gpu : gpuInfo) 
-    {
-        QString gpuName = gpu.name;
+    // Обновляем историю графика CPU
+    _cpuHistory.append(info.cpuUsage);
 
-        if (!_gpuSeriesMap.contains(gpuName)) 
+    if (dataClasses & dcCpuCores)
+    {
+        // Буферы по ядрам той же длины, что и общий: мини-графики показывают то же окно, что и большие графики
+        if (_cpuCoreHistories.size() != static_cast<size_t>(info.cpuCoreUsage.size()))
         {
-            // Создаём новый график
-            auto* series = new QLineSeries();
-            series->setName(gpuName); // подпись в легенде
-            _gpuChart->addSeries(series);
-            series->attachAxis(_gpuAxisX);
-            series->attachAxis(_gpuAxisY);
-            _gpuSeriesMap[gpuName] = series;
-        }
-        auto* series = _gpuSeriesMap[gpuName];
-        series->append(gpuX, gpu.usage);
+            _cpuCoreHistories.assign(info.cpuCoreUsage.size(), ChartHistory());
+            _cpuCoreGrid->setHistories(&_cpuCoreHistories);
+        }
+        for (int i = 0; i < info.cpuCoreUsage.size(); i++)
+        {
+            _cpuCoreHistories[i].append(info.cpuCoreUsage[i]);
+        }
+    }
+
+    // Обновляем информацию о CPU
+    {
+        SELF_PROFILE_SCOPE("info.cpu");
+        _cpuInfoPanel.beginUpdate();
+        _cpuInfoPanel.setItem("cpu", "Центральный процессор", QString(), true);
+        _cpuInfoPanel.setItem("cpu/usage", QString("Загрузка ЦП: %1%").arg(info.cpuUsage, 0, 'f', 2), "cpu");
+        _cpuInfoPanel.setItem("cpu/baseSpeed", QString("Базовая частота: %1 ГГц").arg(info.baseSpeedGHz, 0, 'f', 2), "cpu");
+        _cpuInfoPanel.setItem("cpu/processes", QString("Число процессов: %1").arg(info.processCount), "cpu");
+        _cpuInfoPanel.setItem("cpu/threads", QString("Число потоков: %1").arg(info.threadCount), "cpu");
+        _cpuInfoPanel.setItem("cpu/cores", QString("Число ядер: %1").arg(info.coreCount), "cpu");
+        _cpuInfoPanel.setItem("cpu/logical", QString("Логические процессоры: %1").arg(info.logicalProcessorCount), "cpu");
+        _cpuInfoPanel.setItem("cpu/cache", "Кэш-память", "cpu");
+        _cpuInfoPanel.setItem("cpu/cache/L1", QString("L1: %1 КБ").arg(info.cacheL1KB), "cpu/cache");
+        _cpuInfoPanel.setItem("cpu/cache/L2", QString("L2: %1 МБ").arg(info.cacheL2KB / 1024), "cpu/cache");
+        _cpuInfoPanel.setItem("cpu/cache/L3", QString("L3: %1 МБ").arg(info.cacheL3KB / 1024), "cpu/cache");
+        _cpuInfoPanel.endUpdate();
+    }
+
+    // Обновляем историю графика Памяти
+    _memoryHistory.append((double)info.usedMemory / (double)info.totalMemory * 100.0);
+
+    // Обновляем информацию о Памяти
+    {
+        SELF_PROFILE_SCOPE("info.memory");
+        _memoryInfoPanel.beginUpdate();
+        _memoryInfoPanel.setItem("memory", "Оперативная память", QString(), true);
+        _memoryInfoPanel.setItem("memory/used", QString("Использовано: %1 ГБ / %2 ГБ (%3%)")
+            .arg(info.usedMemory / 1024.0 / 1024.0 / 1024.0, 0, 'f', 2)
+            .arg(info.totalMemory / 1024.0 / 1024.0 / 1024.0, 0, 'f', 2)
+            .arg((double)info.usedMemory / info.totalMemory * 100.0, 0, 'f', 2), "memory");
+        _memoryInfoPanel.endUpdate();
     }
-    gpuX++;
+   
+    renderPerformanceCharts();
+}
 
-    // Удаляем лишние графики, если видеокарты исчезли
-    QStringList currentNames;
-    for (const auto& gpu : gpuInfo) 
+void WinTaskManager::updatePhysicalDiskCharts(const QList<PhysicalDiskInfo>& physicalDisks)
+{
+    QSet<QString> currentDisks;
+    bool layoutChanged = false;
+    for (const auto& disk : physicalDisks)
     {
-        currentNames.append(gpu.name);
+        currentDisks.insert(disk.name);
+
+        auto it = _physicalDiskCharts.find(disk.name);
+        if (it == _physicalDiskCharts.end())
+        {
+            // Создаём график для нового диска
+            PhysicalDiskChart diskChart;
+            auto* chart = new QChart();
+            chart->setTitle(QString("Диск %1").arg(disk.name));
+            chart->legend()->hide();
+
+            diskChart.series = new QLineSeries();
+            diskChart.series->setName("Активность");
+            chart->addSeries(diskChart.series);
+
+            diskChart.axisX = new QValueAxis;
+            auto* axisY = new QValueAxis;
+            diskChart.axisX->setRange(0, 100);
+            axisY->setRange(0, 100);
+            axisY->setTitleText("Активность, %");
+            chart->addAxis(diskChart.axisX, Qt::AlignBottom);
+            chart->addAxis(axisY, Qt::AlignLeft);
+            diskChart.series->attachAxis(diskChart.axisX);
+            diskChart.series->attachAxis(axisY);
+
+            diskChart.view = new ProfiledChartView(chart, "paint.physicalDiskChart");
+            diskChart.view->setRenderHint(QPainter::Antialiasing);
+            diskChart.view->setMinimumHeight(150);
+
+            it = _physicalDiskCharts.insert(disk.name, diskChart);
+            layoutChanged = true;
+        }
+        it->history.append(disk.busyPercent);
     }
-    for (auto it = _gpuSeriesMap.begin(); it != _gpuSeriesMap.end();) 
+
+    // Удаляем графики исчезнувших дисков (график удаляется вместе с представлением)
+    for (auto it = _physicalDiskCharts.begin(); it != _physicalDiskCharts.end();)
     {
-        if (!currentNames.contains(it.key()))
+        if (!currentDisks.contains(it.key()))
         {
-            _gpuChart->removeSeries(it.value());
-            delete it.value();
-            it = _gpuSeriesMap.erase(it);
+            _physicalDiskChartsLayout->removeWidget(it->view);
+            delete it->view;
+            it = _physicalDiskCharts.erase(it);
+            layoutChanged = true;
         }
         else
         {
@@ -725,126 +1349,84 @@ void WinTaskManager::updatePerformanceTab(const SystemInfo& info, const DisksInf
         }
     }
 
-    gpuX++;
-    // Удаляем старые точки, если нужно
-    for (auto* series : _gpuSeriesMap)
+    if (layoutChanged)
     {
-        if (series->count() > 100) 
+        int index = 0;
+        for (auto it = _physicalDiskCharts.cbegin(); it != _physicalDiskCharts.cend(); ++it, ++index)
         {
-            series->removePoints(0, 1);
+            _physicalDiskChartsLayout->removeWidget(it->view);
+            _physicalDiskChartsLayout->addWidget(it->view, index / 2, index % 2);
         }
     }
-    _gpuAxisX->setRange(gpuX - 100, gpuX);
-
-    // Обновляем информацию о GPU
-    _gpuInfoTree->clear();
-    auto* gpuGroup = new QTreeWidgetItem(_gpuInfoTree);
-    gpuGroup->setText(0, "Видеокарты");
-    gpuGroup->setExpanded(true);
-    for (const auto& gpu : gpuInfo) 
-    {
-        auto* gpuAdapterGroup = new QTreeWidgetItem(gpuGroup);
-        gpuAdapterGroup->setText(0, gpu.name);
+}
 
-        auto* usageItem = new QTreeWidgetItem(gpuAdapterGroup);
-        usageItem->setText(0, QString("Загрузка: %1%").arg(gpu.usage));
+bool WinTaskManager::isPerformancePageVisible(QWidget* page) const
+{
+    return !isMinimized() && _tabWidget->currentWidget() == _performanceTab && _performanceStack->currentWidget() == page;
+}
 
-        auto* memoryItem = new QTreeWidgetItem(gpuAdapterGroup);
-        memoryItem->setText(0, QString("Память: %1 ГБ / %2 ГБ")
-            .arg(gpu.usedMemoryBytes / 1024.0 / 1024.0 / 1024.0, 0, 'f', 2)
-            .arg(gpu.totalMemoryBytes / 1024.0 / 1024.0 / 1024.0, 0, 'f', 2));
+static void renderChartAxisX(QValueAxis* axisX, const ChartHistory& history, int window)
+{
+    qreal end = static_cast<qreal>(history.totalCount());
+    axisX->setRange(end - window, end);
+}
 
-        auto* powerItem = new QTreeWidgetItem(gpuAdapterGroup);
-        powerItem->setText(0, QString("Потребление: %1 Вт").arg(gpu.powerUsage));
+static int chartColumns(QChart* chart)
+{
+    return static_cast<int>(chart->plotArea().width());
+}
 
-        auto* tempItem = new QTreeWidgetItem(gpuAdapterGroup);
-        tempItem->setText(0, QString("Температура: %1 °C").arg(gpu.temperatureCelsius, 0, 'f', 1));
+void WinTaskManager::renderPerformanceCharts()
+{
+    // Графики скрытых страниц не перерисовываются: история копится в ChartHistory,
+    // а точки попадают в серии одним replace() при показе страницы
+    if (isPerformancePageVisible(_diskPerformancePage))
+    {
+        SELF_PROFILE_SCOPE("chart.disk");
+        int columns = chartColumns(_diskChart);
+        _diskReadHistory.renderTo(_diskSeriesRead, _chartWindow, columns);
+        _diskWriteHistory.renderTo(_diskSeriesWrite, _chartWindow, columns);
+        renderChartAxisX(_diskAxisX, _diskReadHistory, _chartWindow);
 
-        auto* vendorItem = new QTreeWidgetItem(gpuAdapterGroup);
-        vendorItem->setText(0, QString("Производитель: %1").arg(gpu.vendor));
+        for (auto it = _physicalDiskCharts.cbegin(); it != _physicalDiskCharts.cend(); ++it)
+        {
+            it->history.renderTo(it->series, _chartWindow, chartColumns(it->view->chart()));
+            renderChartAxisX(it->axisX, it->history, _chartWindow);
+        }
     }
-
-    // Обновляем график CPU
-    static int cpuX = 0;
-    _cpuSeries->append(cpuX, info.cpuUsage);
-    cpuX++;
-    if (_cpuSeries->count() > 100) 
+    else if (isPerformancePageVisible(_networkPerformancePage))
     {
-        _cpuSeries->removePoints(0, 1);
+        SELF_PROFILE_SCOPE("chart.network");
+        int columns = chartColumns(_networkChart);
+        _networkRecvHistory.renderTo(_networkSeriesRecv, _chartWindow, columns);
+        _networkSentHistory.renderTo(_networkSeriesSent, _chartWindow, columns);
+        _networkRecvPeakHistory.renderTo(_networkSeriesRecvPeak, _chartWindow, columns);
+        _networkSentPeakHistory.renderTo(_networkSeriesSentPeak, _chartWindow, columns);
+        renderChartAxisX(_networkAxisX, _networkRecvHistory, _chartWindow);
     }
-    _cpuAxisX->setRange(cpuX - 100, cpuX);
-
-    _cpuInfoTree->clear();
-    auto* cpuGroup = new QTreeWidgetItem(_cpuInfoTree);
-    cpuGroup->setText(0, "Центральный процессор");
-    cpuGroup->setExpanded(true);
-
-    auto* usageItem = new QTreeWidgetItem(cpuGroup);
-    usageItem->setText(0, QString("Загрузка ЦП: %1%").arg(info.cpuUsage, 0, 'f', 2));
-
-    auto* baseSpeedItem = new QTreeWidgetItem(cpuGroup);
-    baseSpeedItem->setText(0, QString("Базовая частота: %1 ГГц").arg(info.baseSpeedGHz, 0, 'f', 2));
-
-    auto* procCountItem = new QTreeWidgetItem(cpuGroup);
-    procCountItem->setText(0, QString("Число процессов: %1").arg(info.processCount));
-
-    auto* threadCountItem = new QTreeWidgetItem(cpuGroup);
-    threadCountItem->setText(0, QString("Число потоков: %1").arg(info.threadCount));
-
-    auto* coreCountItem = new QTreeWidgetItem(cpuGroup);
-    coreCountItem->setText(0, QString("Число ядер: %1").arg(info.coreCount));
-
-    auto* logicalCountItem = new QTreeWidgetItem(cpuGroup);
-    logicalCountItem->setText(0, QString("Логические процессоры: %1").arg(info.logicalProcessorCount));
-
-    auto* cacheGroup = new QTreeWidgetItem(cpuGroup);
-    cacheGroup->setText(0, "Кэш-память");
-
-    auto* cacheL1Item = new QTreeWidgetItem(cacheGroup);
-    cacheL1Item->setText(0, QString("L1: %1 КБ").arg(info.cacheL1KB));
-
-    auto* cacheL2Item = new QTreeWidgetItem(cacheGroup);
-    cacheL2Item->setText(0, QString("L2: %1 МБ").arg(info.cacheL2KB / 1024));
-
-    auto* cacheL3Item = new QTreeWidgetItem(cacheGroup);
-    cacheL3Item->setText(0, QString("L3: %1 МБ").arg(info.cacheL3KB / 1024));
-
-    // Загрузка ядер
-    auto* coresGroup = new QTreeWidgetItem(cpuGroup);
-    coresGroup->setText(0, "Загрузка ядер");
-    for (int i = 0; i < info.cpuCoreUsage.size(); i++) 
+    else if (isPerformancePageVisible(_gpuPerformancePage))
     {
-        auto* coreItem = new QTreeWidgetItem(coresGroup);
-        coreItem->setText(0, QString("Ядро %1: %2%").arg(i + 1).arg(info.cpuCoreUsage[i], 0, 'f', 2));
+        SELF_PROFILE_SCOPE("chart.gpu");
+        int columns = chartColumns(_gpuChart);
+        for (auto it = _gpuSeriesMap.begin(); it != _gpuSeriesMap.end(); ++it)
+        {
+            _gpuHistoryMap[it.key()].renderTo(it.value(), _chartWindow, columns);
+        }
+        _gpuAxisX->setRange(static_cast<qreal>(_gpuSampleCount) - _chartWindow, static_cast<qreal>(_gpuSampleCount));
     }
-
-    // Обновляем данные Памяти
-    static int memoryX = 0;
-    _memorySeriesUsed->append(memoryX, (double)info.usedMemory / (double)info.totalMemory * 100.0);
-    memoryX++;
-    if (_memorySeriesUsed->count() > 100)
+    else if (isPerformancePageVisible(_cpuPerformancePage))
     {
-        _memorySeriesUsed->removePoints(0, 1);
+        SELF_PROFILE_SCOPE("chart.cpu");
+        _cpuHistory.renderTo(_cpuSeries, _chartWindow, chartColumns(_cpuChart));
+        renderChartAxisX(_cpuAxisX, _cpuHistory, _chartWindow);
+        _cpuCoreGrid->refresh();
+    }
+    else if (isPerformancePageVisible(_memoryPerformancePage))
+    {
+        SELF_PROFILE_SCOPE("chart.memory");
+        _memoryHistory.renderTo(_memorySeriesUsed, _chartWindow, chartColumns(_memoryChart));
+        renderChartAxisX(_memoryAxisX, _memoryHistory, _chartWindow);
     }
-    _memoryAxisX->setRange(memoryX - 100, memoryX);
-
-    // Обновляем информацию о Памяти
-    _memoryInfoTree->clear();
-    auto* memoryGroup = new QTreeWidgetItem(_memoryInfoTree);
-    memoryGroup->setText(0, "Оперативная память");
-    memoryGroup->setExpanded(true);
-
-    auto* memoryItem = new QTreeWidgetItem(memoryGroup);
-    memoryItem->setText(0, QString("Использовано: %1 ГБ / %2 ГБ (%3%)")
-        .arg(info.usedMemory / 1024.0 / 1024.0 / 1024.0, 0, 'f', 2)
-        .arg(info.totalMemory / 1024.0 / 1024.0 / 1024.0, 0, 'f', 2)
-        .arg((double)info.usedMemory / info.totalMemory * 100.0, 0, 'f', 2));
-   
-    setExpandedItems(_diskInfoTree, diskExpanded);
-    setExpandedItems(_networkInfoTree, networkExpanded);
-    setExpandedItems(_gpuInfoTree, gpuExpanded);
-    setExpandedItems(_cpuInfoTree, cpuExpanded);
-    setExpandedItems(_memoryInfoTree, memoryExpanded);
 }
 
 void WinTaskManager::killSelectedProcesses()
@@ -907,14 +1489,29 @@ void WinTaskManager::onServiceContextMenu(const QPoint& pos)
     {
         return;
     }
-    QModelIndex sourceIndex = _servicesProxyModel->mapToSource(proxyIndex);
-    // Получаем имя службы из модели
-    _selectedServiceName = _servicesModel->data(sourceIndex.siblingAtColumn(0), Qt::DisplayRole).toString(); // колонка "Имя"
+    // Щелчок по невыделенной строке относится только к ней, иначе - ко всем выделенным службам
+    if (!_servicesTableView->selectionModel()->isRowSelected(proxyIndex.row(), proxyIndex.parent()))
+    {
+        _servicesTableView->selectRow(proxyIndex.row());
+    }
 
-    if (_selectedServiceName.isEmpty()) 
+    // Получаем имена служб из модели, пропуская те, над которыми уже идёт операция
+    _selectedServiceNames.clear();
+    for (const QModelIndex& index : _servicesTableView->selectionModel()->selectedRows(0))
+    {
+        QModelIndex sourceIndex = _servicesProxyModel->mapToSource(index);
+        QString serviceName = _servicesModel->data(sourceIndex, Qt::DisplayRole).toString(); // колонка "Имя"
+        if (!serviceName.isEmpty() && !_serviceOperations->isBusy(serviceName))
+        {
+            _selectedServiceNames.append(serviceName);
+        }
+    }
+
+    if (_selectedServiceNames.isEmpty()) 
     {
         return;
     }
+    _goToServiceProcessAction->setEnabled(_selectedServiceNames.size() == 1 && _serviceGraph.processId(_selectedServiceNames.first()) != 0);
 
     // Показываем меню
     _serviceContextMenu->exec(_servicesTableView->viewport()->mapToGlobal(pos));
@@ -922,88 +1519,120 @@ void WinTaskManager::onServiceContextMenu(const QPoint& pos)
 
 void WinTaskManager::onDataReady(const UpdateData& data)
 {
+    // Задержка доставки сигнала из потока сбора в поток GUI
+    static const int signalStageId = SelfProfiler::instance().registerStage("signal.dataReady");
+    quint64 receivedAtNs = SpanTracer::nowNs();
+    quint64 deliveryNs = receivedAtNs > data.emittedAtNs ? receivedAtNs - data.emittedAtNs : 0;
+    SelfProfiler::instance().record(signalStageId, deliveryNs / 1000, 0);
+    if (SpanTracer::isEnabled() && data.traceFlowId != 0)
+    {
+        SpanTracer::instance().recordSpan("signal.dataReady", data.emittedAtNs, deliveryNs);
+        TRACE_FLOW_END("dataReady", data.traceFlowId);
+    }
+
+    SELF_PROFILE_SCOPE("ui.onDataReady");
+
     QWidget* currentWidget = _tabWidget->currentWidget();
-    _lastProcesses = data.processes;
-    _lastServices = data.services;
+    // Неподписанные классы в этом такте не собирались, сохраняем последние полученные данные
+    bool hasProcesses = data.dataClasses & dcProcessList;
+    bool hasServices = data.dataClasses & dcServices;
+    if (hasProcesses)
+    {
+        _lastProcesses = data.processes;
+    }
+    if (hasServices)
+    {
+        _lastServices = data.services;
+        SELF_PROFILE_SCOPE("model.serviceGraph");
+        _serviceGraph.update(data.services);
+    }
     _lastNetworkInterfaces = data.networkInterfaces;
-    if (_processModel && (currentWidget == _processesTab))
+    if (_networkAdapterListDirty)
     {
+        // Первый такт после смены фильтра адаптеров
+        _networkAdapterListDirty = false;
+        updateNetworkAdapterList(_lastNetworkInterfaces);
+    }
+    _selfCpuUsage = data.selfCpuUsage;
+    if (_processModel && hasProcesses && (currentWidget == _processesTab))
+    {
+        SELF_PROFILE_SCOPE("model.processTable");
         _processModel->updateDataPartial(data.processes);
     }
 
-    if (_processTreeModel && (currentWidget == _treeTab)) 
+    if (_processTreeModel && hasProcesses && (currentWidget == _treeTab)) 
     {
+        SELF_PROFILE_SCOPE("model.processTree");
         _processTreeModel->updateData(data.processes);
     }
 
-    if (_servicesModel && (currentWidget == _servicesTab))
+    if (_servicesModel && hasServices && (currentWidget == _servicesTab))
     {
+        SELF_PROFILE_SCOPE("model.services");
         _servicesModel->updateData(data.services);
     }
 
-    updatePerformanceTab(data.systemInfo, data.disks, data.networkInterfaces, data.gpus);
-}
+    // Изменения соединений применяются всегда, когда пришли: следующий такт считается от этого состояния
+    if (_connectionsModel && (data.dataClasses & dcConnections))
+    {
+        SELF_PROFILE_SCOPE("model.connections");
+        _connectionsModel->applyChanges(data.connectionChanges);
+        updateConnectionsSummary();
+    }
 
-QStringList WinTaskManager::getExpandedItems(QTreeWidget* tree) 
-{
-    QStringList expanded;
-    std::function<void(QTreeWidgetItem*)> traverse;
-    traverse = [&](QTreeWidgetItem* item) 
-        {
-        if (item->isExpanded()) 
-        {
-            // Сохраняем путь к элементу (например, "Группа/Подгруппа/Элемент")
-            QStringList path;
-            QTreeWidgetItem* current = item;
-            while (current) 
-            {
-                path.prepend(current->text(0));
-                current = current->parent();
-            }
-            expanded.append(path.join("/"));
-        }
-        for (int i = 0; i < item->childCount(); ++i) 
-        {
-            traverse(item->child(i));
-        }
-    };
+    {
+        SELF_PROFILE_SCOPE("ui.performanceTab");
+        updatePerformanceTab(data.systemInfo, data.disks, data.networkInterfaces, data.gpus, data.dataClasses);
+    }
 
-    for (int i = 0; i < tree->topLevelItemCount(); ++i)
+    if (_performanceStack->currentWidget() == _selfPerformancePage)
     {
-        traverse(tree->topLevelItem(i));
+        updateSelfPerformancePage();
     }
-    return expanded;
 }
 
-void WinTaskManager::setExpandedItems(QTreeWidget* tree, const QStringList& items) 
+void WinTaskManager::onBackgroundHistoryReady(const QList<BackgroundSample>& samples)
 {
-    std::function<void(QTreeWidgetItem*, const QStringList&)> traverse;
-    traverse = [&](QTreeWidgetItem* item, const QStringList& paths)
-        {
-        QStringList path;
-        QTreeWidgetItem* current = item;
-        while (current) 
-        {
-            path.prepend(current->text(0));
-            current = current->parent();
-        }
-        QString currentPath = path.join("/");
+    SELF_PROFILE_SCOPE("ui.backgroundHistory");
 
-        if (paths.contains(currentPath)) 
+    QString selectedAdapter = _networkAdapterCombo->currentData().toString();
+    double selfCpuWeighted = 0.0;
+    qint64 totalDurationMs = 0;
+    for (const auto& sample : samples)
+    {
+        double selectedRecv = 0, selectedSent = 0;
+        for (const auto& net : sample.networkInterfaces)
         {
-            item->setExpanded(true);
+            if (net.name == selectedAdapter)
+            {
+                selectedRecv = net.receiveBytesPerSec;
+                selectedSent = net.sendBytesPerSec;
+                break;
+            }
         }
+        double memoryUsage = sample.totalMemory > 0 ? (double)sample.usedMemory / (double)sample.totalMemory * 100.0 : 0.0;
 
-        for (int i = 0; i < item->childCount(); ++i) 
+        // Графики ведутся по секундным точкам, а фоновый сэмпл покрывает несколько секунд: повторяем его на весь интервал
+        int ticks = qMax(1, qRound(sample.durationMs / 1000.0));
+        for (int i = 0; i < ticks; i++)
         {
-            traverse(item->child(i), paths);
+            _cpuHistory.append(sample.cpuUsage);
+            _memoryHistory.append(memoryUsage);
+            _diskReadHistory.append(sample.diskReadBytesPerSec / 1024 / 1024);
+            _diskWriteHistory.append(sample.diskWriteBytesPerSec / 1024 / 1024);
+            _networkRecvHistory.append(selectedRecv / 1024 / 128);
+            _networkSentHistory.append(selectedSent / 1024 / 128);
+            _networkRecvPeakHistory.append(selectedRecv / 1024 / 128);
+            _networkSentPeakHistory.append(selectedSent / 1024 / 128);
         }
-    };
 
-    for (int i = 0; i < tree->topLevelItemCount(); ++i) 
-    {
-        traverse(tree->topLevelItem(i), items);
+        selfCpuWeighted += sample.selfCpuUsage * sample.durationMs;
+        totalDurationMs += sample.durationMs;
     }
+
+    _backgroundSelfCpuUsage = totalDurationMs > 0 ? selfCpuWeighted / totalDurationMs : 0.0;
+
+    renderPerformanceCharts();
 }
 
 void WinTaskManager::setupStyles() 
@@ -11,23 +11,25 @@
 #include <QGroupBox>
 #include <QFormLayout>
 #include <QSortFilterProxyModel>
-#include <QApplication.h>
+#include <QApplication>
 #include <QMessageBox>
 #include <QTreeView>
 #include <QComboBox>
 #include <QHash>
 #include <QHeaderView>
 #include <QThread>
+#include <QSystemTrayIcon>
+#include <QGridLayout>
 
 #include <QtCharts/QChartView>
 #include <QtCharts/QLineSeries>
 #include <QtCharts/QValueAxis>
 
 #include "ui_WinTop.h"
-#include <QTimer.h>
 #include <memory>
 #include <ISystemMonitor.h>
 #include "ProcessTableModel.h"
+#include "ConnectionTableModel.h"
 #include <IProcessControl.h>
 #include "IProcessTreeBuilder.h"
 #include "ProcessTreeModel.h"
@@ -38,8 +40,12 @@
 #include <INetworkMonitor.h>
 #include <IGPUMonitor.h>
 #include "ServiceTableModel.h"
-#include "IServiceControl.h"
+#include "ServiceOperationQueue.h"
+#include "ServiceDependencyGraph.h"
 #include <DataUpdater.h>
+#include "ChartHistory.h"
+#include "CpuCoreGridWidget.h"
+#include "InfoPanel.h"
 
 class WinTaskManager : public QMainWindow
 {
@@ -49,6 +55,9 @@ public:
     WinTaskManager(QWidget *parent = nullptr);
     ~WinTaskManager();
 
+protected:
+    void changeEvent(QEvent* event) override;
+
 private slots:
     void onProcessContextMenu(const QPoint& pos);
     void onFilterLineEditTextChanged(const QString &text);
@@ -57,16 +66,19 @@ private slots:
     void showProcessDetails();
     void onServiceContextMenu(const QPoint& pos);
     void onDataReady(const UpdateData& data);
+    void onBackgroundHistoryReady(const QList<BackgroundSample>& samples);
+    void onNetworkBurstReady(const NetworkBurstSample& sample);
 
 private:
     void setupUI();
 
-    std::unique_ptr<IServiceControl> _serviceControl;
+    ServiceOperationQueue* _serviceOperations;
     std::unique_ptr<IProcessControl> _processControl;
     std::unique_ptr<IProcessTreeBuilder> _treeBuilder;
     QList<ProcessInfo> _lastProcesses;
     QList<NetworkInterfaceInfo> _lastNetworkInterfaces;
     QList<ServiceInfo> _lastServices;
+    ServiceDependencyGraph _serviceGraph;
 
     QTabWidget* _tabWidget;
     QWidget* _overviewTab;
@@ -87,6 +99,12 @@ private:
     QAction* _killProcessAction;
     QAction* _showDetailsAction;
 
+    // Меню заголовка таблицы процессов: включение дополнительных колонок
+    QMenu* _processColumnsMenu;
+    // Маска ProcessDetailField для видимых дополнительных колонок, передаётся в DataUpdater
+    quint32 _processDetailFields = 0;
+    void updateProcessDetailFields();
+
     // Дерево процессов
     QWidget* _treeTab;
     QTreeView* _processTreeView;
@@ -108,17 +126,35 @@ private:
     QValueAxis* _diskAxisY;
     QWidget* _diskInfoWidget; // информация о диске внизу
 
+    // Графики активности по физическим дискам, создаются при появлении диска
+    struct PhysicalDiskChart
+    {
+        QChartView* view = nullptr;
+        QLineSeries* series = nullptr;
+        QValueAxis* axisX = nullptr;
+        ChartHistory history;
+    };
+    QGridLayout* _physicalDiskChartsLayout;
+    QMap<QString, PhysicalDiskChart> _physicalDiskCharts;
+    void updatePhysicalDiskCharts(const QList<PhysicalDiskInfo>& physicalDisks);
+
     // Сеть
     QWidget* _networkPerformancePage; // страница сети
     QChartView* _networkChartView; // график сети
     QChart* _networkChart;
     QLineSeries* _networkSeriesRecv;
     QLineSeries* _networkSeriesSent;
+    // Максимум скорости за секунду по замерам каждые 100 мс: короткие всплески, которые средняя сглаживает
+    QLineSeries* _networkSeriesRecvPeak;
+    QLineSeries* _networkSeriesSentPeak;
     QValueAxis* _networkAxisX;
     QValueAxis* _networkAxisY;
     QWidget* _networkInfoWidget; // информация о сети внизу
     // Выпадающий список для выбора адаптера
     QComboBox* _networkAdapterCombo;
+    // Маска NetworkAdapterType, передаётся в DataUpdater
+    quint32 _networkAdapterFilter = DEFAULT_NETWORK_ADAPTER_FILTER;
+    bool _networkAdapterListDirty = false;
 
     // Производительность GPU
     QWidget* _gpuPerformancePage; // страница GPU
@@ -137,6 +173,7 @@ private:
     QValueAxis* _cpuAxisX;
     QValueAxis* _cpuAxisY;
     QWidget* _cpuInfoWidget; // информация о CPU внизу
+    CpuCoreGridWidget* _cpuCoreGrid; // мини-графики логических процессоров
 
     // ОЗУ
     QWidget* _memoryPerformancePage; // страница Памяти
@@ -147,32 +184,76 @@ private:
     QValueAxis* _memoryAxisY;
     QWidget* _memoryInfoWidget;
 
+    // История графиков (хранится вне серий, в серии выводится только видимая страница)
+    ChartHistory _diskReadHistory;
+    ChartHistory _diskWriteHistory;
+    ChartHistory _networkRecvHistory;
+    ChartHistory _networkSentHistory;
+    ChartHistory _networkRecvPeakHistory;
+    ChartHistory _networkSentPeakHistory;
+    // Последняя секундная сводка частых замеров и число тактов сбора после неё: сводка старше
+    // одного такта (замеры остановлены или сменился адаптер) на график не идёт
+    static constexpr int NETWORK_BURST_MAX_AGE = 1;
+    NetworkBurstSample _lastNetworkBurst;
+    int _networkBurstAge = NETWORK_BURST_MAX_AGE + 1;
+    QHash<QString, ChartHistory> _gpuHistoryMap;
+    // Общий счётчик тактов с данными GPU: видеокарта, появившаяся позже, начинает историю с него
+    quint64 _gpuSampleCount = 0;
+    ChartHistory _cpuHistory;
+    std::vector<ChartHistory> _cpuCoreHistories;
+    ChartHistory _memoryHistory;
+    QComboBox* _chartWindowCombo;
+    int _chartWindow = 100;
+
+    // Самоизмерение (скрытая страница "Self")
+    QTreeWidgetItem* _selfItem;
+    QWidget* _selfPerformancePage;
+    QTreeWidget* _selfStatsTree;
+    QLabel* _selfCpuLabel;
+    double _selfCpuUsage = 0.0;
+    double _backgroundSelfCpuUsage = 0.0;
+
     // вкладка "Службы"
     QWidget* _servicesTab;
     QTableView* _servicesTableView;
     ServiceTableModel* _servicesModel;
     QSortFilterProxyModel* _servicesProxyModel;
 
+    // вкладка "Соединения"
+    QWidget* _connectionsTab;
+    QTableView* _connectionsTableView;
+    ConnectionTableModel* _connectionsModel;
+    QSortFilterProxyModel* _connectionsProxyModel;
+    QLabel* _connectionsSummaryLabel;
+
     // Меню управления службой
     QMenu* _serviceContextMenu;
     QAction* _startServiceAction;
     QAction* _stopServiceAction;
+    QAction* _goToServiceProcessAction;
 
-    // Выбранная служба
-    QString _selectedServiceName;
+    // Выбранные службы
+    QStringList _selectedServiceNames;
 
     void setUpProcessInfoContextMenu();
     void setUpProcessTree();
     void setUpPerformanceTab();
     void setUpServicesTab();
+    void setUpConnectionsTab();
+    void updateConnectionsSummary();
     void showProcessDetailsDialog(quint32 pid);
     void setUpNetworkPerformanceTab();
     void setUpGPUPerformanceTab();
     void setUpCPUPerformanceTab();
     void setUpMemoryPerformanceTab();
+    void setUpSelfPerformanceTab();
+    void updateSelfPerformancePage();
     void updateNetworkAdapterList(const QList<NetworkInterfaceInfo> & networkInfo);
-    void updatePerformanceTab(const SystemInfo& systemInfo, const DisksInfo& diskInfo, const QList<NetworkInterfaceInfo> & networkInfo, const QList<GPUInfo> & gpuInfo);
+    void resetNetworkChart();
+    void updatePerformanceTab(const SystemInfo& systemInfo, const DisksInfo& diskInfo, const QList<NetworkInterfaceInfo> & networkInfo, const QList<GPUInfo> & gpuInfo, quint32 dataClasses);
     quint32 getPIDFromTreeIndex(const QModelIndex& index);
+    void renderPerformanceCharts();
+    bool isPerformancePageVisible(QWidget* page) const;
 
     // поля для информации под графиками
     // Диск
@@ -195,12 +276,25 @@ private:
     QTreeWidget* _memoryInfoTree; 
     QScrollArea* _memoryInfoScroll;
 
-    // Методы для сохранения/восстановления состояния дерева
-    QStringList getExpandedItems(QTreeWidget* tree);
-    void setExpandedItems(QTreeWidget* tree, const QStringList& items);
+    // Обновление панелей по ключам (раскрытие элементов хранит само дерево)
+    InfoPanel _diskInfoPanel;
+    InfoPanel _networkInfoPanel;
+    InfoPanel _gpuInfoPanel;
+    InfoPanel _cpuInfoPanel;
+    InfoPanel _memoryInfoPanel;
 
     void setupStyles();
 
     QThread* _dataThread;
     DataUpdater* _dataUpdater;
+
+    // Подписки окна на классы данных DataUpdater, зависят от видимой вкладки и свёрнутости окна
+    quint32 _dataSubscriptions = 0;
+    void updateDataSubscriptions();
+
+    // Значок в трее: свёрнутое окно прячется туда, а DataUpdater переходит в фоновый режим
+    QSystemTrayIcon* _trayIcon = nullptr;
+    QMenu* _trayMenu = nullptr;
+    void setUpTrayIcon();
+    void restoreFromTray();
 };
\ No newline at end of file
@@ -0,0 +1,162 @@
+﻿#include "WindowsConnectionMonitor.h"
+#include "SelfProfiler.h"
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+#include <iphlpapi.h>
+#include <cstring>
+
+// MIB_TCP_STATE_CLOSED (1) ... MIB_TCP_STATE_DELETE_TCB (12)
+static ConnectionState tcpState(DWORD state)
+{
+    static const ConnectionState STATES[] = { csNone, csClosed, csListen, csSynSent, csSynReceived, csEstablished,
+        csFinWait1, csFinWait2, csCloseWait, csClosing, csLastAck, csTimeWait, csClosed };
+    return state < sizeof(STATES) / sizeof(STATES[0]) ? STATES[state] : csNone;
+}
+
+// Порт хранится в младших 16 битах DWORD в сетевом порядке байтов
+static quint16 portFromTable(DWORD port)
+{
+    return ntohs(static_cast<u_short>(port));
+}
+
+ConnectionChanges WindowsConnectionMonitor::getConnectionChanges()
+{
+    _tracker.beginSample();
+    {
+        TRACE_SCOPE("collect.connections.tcp");
+        collectTcp4();
+        collectTcp6();
+    }
+    {
+        TRACE_SCOPE("collect.connections.udp");
+        collectUdp4();
+        collectUdp6();
+    }
+    return _tracker.endSample();
+}
+
+bool WindowsConnectionMonitor::readTcpTable(int family)
+{
+    DWORD size = static_cast<DWORD>(_tableBuffer.size());
+    DWORD result = GetExtendedTcpTable(_tableBuffer.empty() ? nullptr : _tableBuffer.data(), &size, FALSE, family, TCP_TABLE_OWNER_PID_ALL, 0);
+    if (result == ERROR_INSUFFICIENT_BUFFER)
+    {
+        // Запас на соединения, открытые между двумя вызовами
+        _tableBuffer.resize(size + size / 4);
+        size = static_cast<DWORD>(_tableBuffer.size());
+        result = GetExtendedTcpTable(_tableBuffer.data(), &size, FALSE, family, TCP_TABLE_OWNER_PID_ALL, 0);
+    }
+    return result == NO_ERROR;
+}
+
+bool WindowsConnectionMonitor::readUdpTable(int family)
+{
+    DWORD size = static_cast<DWORD>(_tableBuffer.size());
+    DWORD result = GetExtendedUdpTable(_tableBuffer.empty() ? nullptr : _tableBuffer.data(), &size, FALSE, family, UDP_TABLE_OWNER_PID, 0);
+    if (result == ERROR_INSUFFICIENT_BUFFER)
+    {
+        _tableBuffer.resize(size + size / 4);
+        size = static_cast<DWORD>(_tableBuffer.size());
+        result = GetExtendedUdpTable(_tableBuffer.data(), &size, FALSE, family, UDP_TABLE_OWNER_PID, 0);
+    }
+    return result == NO_ERROR;
+}
+
+void WindowsConnectionMonitor::collectTcp4()
+{
+    if (!readTcpTable(AF_INET))
+    {
+        // Соединения непрочитанной таблицы не считаются закрытыми
+        _tracker.skipFamily(cpTcp, false);
+        return;
+    }
+
+    auto table = reinterpret_cast<const MIB_TCPTABLE_OWNER_PID*>(_tableBuffer.data());
+    for (DWORD i = 0; i < table->dwNumEntries; i++)
+    {
+        const MIB_TCPROW_OWNER_PID& row = table->table[i];
+
+        ConnectionInfo connection;
+        connection.protocol = cpTcp;
+        memcpy(connection.localAddress.data(), &row.dwLocalAddr, sizeof(row.dwLocalAddr));
+        memcpy(connection.remoteAddress.data(), &row.dwRemoteAddr, sizeof(row.dwRemoteAddr));
+        connection.localPort = portFromTable(row.dwLocalPort);
+        connection.remotePort = portFromTable(row.dwRemotePort);
+        connection.state = tcpState(row.dwState);
+        connection.pid = row.dwOwningPid;
+        _tracker.update(connection);
+    }
+}
+
+void WindowsConnectionMonitor::collectTcp6()
+{
+    if (!readTcpTable(AF_INET6))
+    {
+        _tracker.skipFamily(cpTcp, true);
+        return;
+    }
+
+    auto table = reinterpret_cast<const MIB_TCP6TABLE_OWNER_PID*>(_tableBuffer.data());
+    for (DWORD i = 0; i < table->dwNumEntries; i++)
+    {
+        const MIB_TCP6ROW_OWNER_PID& row = table->table[i];
+
+        ConnectionInfo connection;
+        connection.protocol = cpTcp;
+        connection.isIPv6 = true;
+        memcpy(connection.localAddress.data(), row.ucLocalAddr, sizeof(row.ucLocalAddr));
+        memcpy(connection.remoteAddress.data(), row.ucRemoteAddr, sizeof(row.ucRemoteAddr));
+        connection.localPort = portFromTable(row.dwLocalPort);
+        connection.remotePort = portFromTable(row.dwRemotePort);
+        connection.state = tcpState(row.dwState);
+        connection.pid = row.dwOwningPid;
+        _tracker.update(connection);
+    }
+}
+
+void WindowsConnectionMonitor::collectUdp4()
+{
+    if (!readUdpTable(AF_INET))
+    {
+        _tracker.skipFamily(cpUdp, false);
+        return;
+    }
+
+    // У UDP-сокета есть только локальная сторона
+    auto table = reinterpret_cast<const MIB_UDPTABLE_OWNER_PID*>(_tableBuffer.data());
+    for (DWORD i = 0; i < table->dwNumEntries; i++)
+    {
+        const MIB_UDPROW_OWNER_PID& row = table->table[i];
+
+        ConnectionInfo connection;
+        connection.protocol = cpUdp;
+        memcpy(connection.localAddress.data(), &row.dwLocalAddr, sizeof(row.dwLocalAddr));
+        connection.localPort = portFromTable(row.dwLocalPort);
+        connection.pid = row.dwOwningPid;
+        _tracker.update(connection);
+    }
+}
+
+void WindowsConnectionMonitor::collectUdp6()
+{
+    if (!readUdpTable(AF_INET6))
+    {
+        _tracker.skipFamily(cpUdp, true);
+        return;
+    }
+
+    auto table = reinterpret_cast<const MIB_UDP6TABLE_OWNER_PID*>(_tableBuffer.data());
+    for (DWORD i = 0; i < table->dwNumEntries; i++)
+    {
+        const MIB_UDP6ROW_OWNER_PID& row = table->table[i];
+
+        ConnectionInfo connection;
+        connection.protocol = cpUdp;
+        connection.isIPv6 = true;
+        memcpy(connection.localAddress.data(), row.ucLocalAddr, sizeof(row.ucLocalAddr));
+        connection.localPort = portFromTable(row.dwLocalPort);
+        connection.pid = row.dwOwningPid;
+        _tracker.update(connection);
+    }
+}
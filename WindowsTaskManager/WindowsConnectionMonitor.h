@@ -0,0 +1,25 @@
+﻿#pragma once
+
+#include "IConnectionMonitor.h"
+#include "ConnectionTracker.h"
+#include <vector>
+
+class WindowsConnectionMonitor : public IConnectionMonitor
+{
+public:
+    WindowsConnectionMonitor() = default;
+    ~WindowsConnectionMonitor() override = default;
+    ConnectionChanges getConnectionChanges() override;
+
+private:
+    ConnectionTracker _tracker;
+    // Таблицы GetExtendedTcpTable/GetExtendedUdpTable читаются в один буфер, который только растёт
+    std::vector<quint8> _tableBuffer;
+
+    bool readTcpTable(int family);
+    bool readUdpTable(int family);
+    void collectTcp4();
+    void collectTcp6();
+    void collectUdp4();
+    void collectUdp6();
+};
@@ -43,12 +43,31 @@ bool WindowsDiskMonitor::initDiskCounters()
         _diskCountersWrite["_Total"] = counterWrite;
     }
 
+    const wchar_t* physicalDiskPaths[PHYSICAL_DISK_COUNTERS_COUNT] =
+    {
+        L"\\PhysicalDisk(*)\\Disk Read Bytes/sec",
+        L"\\PhysicalDisk(*)\\Disk Write Bytes/sec",
+        L"\\PhysicalDisk(*)\\Disk Reads/sec",
+        L"\\PhysicalDisk(*)\\Disk Writes/sec",
+        L"\\PhysicalDisk(*)\\Avg. Disk sec/Transfer",
+        L"\\PhysicalDisk(*)\\Avg. Disk Queue Length",
+        L"\\PhysicalDisk(*)\\% Idle Time"
+    };
+
+    for (int i = 0; i < PHYSICAL_DISK_COUNTERS_COUNT; i++)
+    {
+        if (PdhAddEnglishCounterW(_diskQuery, physicalDiskPaths[i], 0, &_physicalDiskCounters[i]) != ERROR_SUCCESS)
+        {
+            _physicalDiskCounters[i] = nullptr;
+        }
+    }
+
     PdhCollectQueryData(_diskQuery);
 
     return true;
 }
 
-DisksInfo WindowsDiskMonitor::getDisksInfo() 
+DisksInfo WindowsDiskMonitor::getDiskRates() 
 {
     DisksInfo disksInfo;
     qint64 currentTime = QDateTime::currentMSecsSinceEpoch();
@@ -81,6 +100,95 @@ DisksInfo WindowsDiskMonitor::getDisksInfo()
 
     disksInfo.ioBytesPerSec = disksInfo.readBytesPerSec + disksInfo.writeBytesPerSec;
 
+    // Запрос уже собран выше, здесь только разбираем значения по экземплярам
+    disksInfo.physicalDisks = getPhysicalDisks();
+
+    return disksInfo;
+}
+
+DWORD WindowsDiskMonitor::readCounterArray(PDH_HCOUNTER counter)
+{
+    // Буфер переиспользуется между тактами и растёт только при появлении новых дисков
+    DWORD bufferSize = static_cast<DWORD>(_counterArrayBuffer.size());
+    DWORD itemCount = 0;
+    auto* items = reinterpret_cast<PDH_FMT_COUNTERVALUE_ITEM_W*>(_counterArrayBuffer.data());
+    PDH_STATUS status = PdhGetFormattedCounterArrayW(counter, PDH_FMT_DOUBLE | PDH_FMT_NOCAP100, &bufferSize, &itemCount, items);
+    if (status == PDH_MORE_DATA)
+    {
+        _counterArrayBuffer.resize(bufferSize);
+        items = reinterpret_cast<PDH_FMT_COUNTERVALUE_ITEM_W*>(_counterArrayBuffer.data());
+        status = PdhGetFormattedCounterArrayW(counter, PDH_FMT_DOUBLE | PDH_FMT_NOCAP100, &bufferSize, &itemCount, items);
+    }
+
+    return status == ERROR_SUCCESS ? itemCount : 0;
+}
+
+QList<PhysicalDiskInfo> WindowsDiskMonitor::getPhysicalDisks()
+{
+    // Экземпляры называются "0 C:", "1 D: E:" и т.д., QMap сохраняет порядок по номеру диска
+    QMap<QString, PhysicalDiskInfo> disks;
+
+    for (int i = 0; i < PHYSICAL_DISK_COUNTERS_COUNT; i++)
+    {
+        if (!_physicalDiskCounters[i])
+        {
+            continue;
+        }
+
+        DWORD itemCount = readCounterArray(_physicalDiskCounters[i]);
+        const auto* items = reinterpret_cast<const PDH_FMT_COUNTERVALUE_ITEM_W*>(_counterArrayBuffer.data());
+        for (DWORD j = 0; j < itemCount; j++)
+        {
+            QString name = QString::fromWCharArray(items[j].szName);
+            if (name == "_Total")
+            {
+                continue;
+            }
+
+            PhysicalDiskInfo& disk = disks[name];
+            disk.name = name;
+
+            if (items[j].FmtValue.CStatus != PDH_CSTATUS_VALID_DATA && items[j].FmtValue.CStatus != PDH_CSTATUS_NEW_DATA)
+            {
+                continue;
+            }
+
+            double value = items[j].FmtValue.doubleValue;
+            switch (i)
+            {
+            case pdcReadBytes:
+                disk.readBytesPerSec = value;
+                break;
+            case pdcWriteBytes:
+                disk.writeBytesPerSec = value;
+                break;
+            case pdcReads:
+                disk.readOpsPerSec = value;
+                break;
+            case pdcWrites:
+                disk.writeOpsPerSec = value;
+                break;
+            case pdcSecPerTransfer:
+                disk.averageServiceTimeMs = value * 1000.0;
+                break;
+            case pdcQueueLength:
+                disk.queueLength = value;
+                break;
+            case pdcIdleTime:
+                // "% Disk Time" может превышать 100, поэтому занятость считаем через время простоя
+                disk.busyPercent = 100.0 - qBound(0.0, value, 100.0);
+                break;
+            }
+        }
+    }
+
+    return disks.values();
+}
+
+DisksInfo WindowsDiskMonitor::getDisksInfo() 
+{
+    DisksInfo disksInfo = getDiskRates();
+
     // Также добавим информацию по отдельным дискам
     for (const QString& drive : getLogicalDriveStrings()) 
     {
@@ -98,10 +206,6 @@ QMap<quint32, ProcessDiskInfo> WindowsDiskMonitor::getProcessDiskInfo()
 {
     QMap<quint32, ProcessDiskInfo> processDiskMap;
 
-    qint64 currentTime = QDateTime::currentMSecsSinceEpoch();
-    double elapsedSec = (currentTime - _lastProcessUpdateTime) / 1000.0;
-    _lastProcessUpdateTime = currentTime;
-
     HANDLE h_snap = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
     if (h_snap == INVALID_HANDLE_VALUE) 
     {
@@ -111,6 +215,8 @@ QMap<quint32, ProcessDiskInfo> WindowsDiskMonitor::getProcessDiskInfo()
     PROCESSENTRY32 entry;
     entry.dwSize = sizeof(entry);
 
+    _processIoRates.beginSample();
+
     if (Process32First(h_snap, &entry)) 
     {
         do 
@@ -118,11 +224,13 @@ QMap<quint32, ProcessDiskInfo> WindowsDiskMonitor::getProcessDiskInfo()
             quint32 pid = entry.th32ProcessID;
             if (pid == 0 || pid == 4) continue;
 
-            HANDLE h_proc = OpenProcess(PROCESS_QUERY_INFORMATION, FALSE, pid);
+            // Ограниченного доступа достаточно и для счётчиков ввода-вывода, и для времени запуска
+            HANDLE h_proc = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
             if (h_proc) 
             {
                 IO_COUNTERS io_counters = { 0 };
-                if (GetProcessIoCounters(h_proc, &io_counters)) 
+                FILETIME creation_time, exit_time, kernel_time, user_time;
+                if (GetProcessIoCounters(h_proc, &io_counters) && GetProcessTimes(h_proc, &creation_time, &exit_time, &kernel_time, &user_time)) 
                 {
                     ProcessDiskInfo proc_disk;
                     proc_disk.pid = pid;
@@ -132,15 +240,14 @@ QMap<quint32, ProcessDiskInfo> WindowsDiskMonitor::getProcessDiskInfo()
                     proc_disk.writeOperations = io_counters.WriteOperationCount;
 
                     // Вычисляем скорость
-                    quint64 lastRead = _lastProcessReadBytes.value(pid, 0);
-                    quint64 lastWrite = _lastProcessWriteBytes.value(pid, 0);
+                    ULARGE_INTEGER start_time;
+                    start_time.LowPart = creation_time.dwLowDateTime;
+                    start_time.HighPart = creation_time.dwHighDateTime;
 
-                    proc_disk.bytesRead = (io_counters.ReadTransferCount - lastRead) / (elapsedSec > 0 ? elapsedSec : 1);
-                    proc_disk.bytesWritten = (io_counters.WriteTransferCount - lastWrite) / (elapsedSec > 0 ? elapsedSec : 1);
-
-                    // Обновляем кэш
-                    _lastProcessReadBytes[pid] = io_counters.ReadTransferCount;
-                    _lastProcessWriteBytes[pid] = io_counters.WriteTransferCount;
+                    RateTracker<2>::Rates rates;
+                    _processIoRates.update(pid, start_time.QuadPart, { io_counters.ReadTransferCount, io_counters.WriteTransferCount }, rates);
+                    proc_disk.readBytesPerSec = rates[0];
+                    proc_disk.writeBytesPerSec = rates[1];
 
                     processDiskMap[pid] = proc_disk;
                 }
@@ -151,6 +258,8 @@ QMap<quint32, ProcessDiskInfo> WindowsDiskMonitor::getProcessDiskInfo()
 
     CloseHandle(h_snap);
 
+    _processIoRates.endSample();
+
     return processDiskMap;
 }
 
@@ -5,12 +5,15 @@
 #include <Windows.h>
 #include <QList>
 #include <QMap>
+#include <vector>
+#include "RateTracker.h"
 
 class WindowsDiskMonitor : public IDiskMonitor {
 public:
     WindowsDiskMonitor();
     ~WindowsDiskMonitor();
     DisksInfo getDisksInfo() override;
+    DisksInfo getDiskRates() override;
     QMap<quint32, ProcessDiskInfo> getProcessDiskInfo() override;
 
 private:
@@ -22,10 +25,15 @@ private:
     QMap<QString, quint64> _lastDiskWriteBytes;
     qint64 _lastDiskUpdateTime = 0;
 
-    //   
-    QMap<quint32, quint64> _lastProcessReadBytes;
-    QMap<quint32, quint64> _lastProcessWriteBytes;
-    qint64 _lastProcessUpdateTime = 0;
+    //    :  PhysicalDisk(*)    ,    
+    enum PhysicalDiskCounter { pdcReadBytes, pdcWriteBytes, pdcReads, pdcWrites, pdcSecPerTransfer, pdcQueueLength, pdcIdleTime, PHYSICAL_DISK_COUNTERS_COUNT };
+    PDH_HCOUNTER _physicalDiskCounters[PHYSICAL_DISK_COUNTERS_COUNT] = {};
+    std::vector<BYTE> _counterArrayBuffer;
+    DWORD readCounterArray(PDH_HCOUNTER counter);
+    QList<PhysicalDiskInfo> getPhysicalDisks();
+
+    //   :    
+    RateTracker<2> _processIoRates;
 
     // 
     QList<QString> getLogicalDriveStrings();
@@ -1,247 +0,0 @@
-﻿#include "WindowsGPUMonitor.h"
-
-QList<GPUInfo> WindowsGPUMonitor::getGPUInfo()
-{
-    QList<GPUInfo> gpus;
-
-    // Получаем информацию от NVIDIA через NVML
-    gpus = getNvidiaGPUInfo();
-
-    // Получаем информацию от AMD через ADL
-    gpus += getAMDGPUInfo();
-    return gpus;
-}
-
-QMap<quint32, ProcessGPUInfo> WindowsGPUMonitor::getProcessGPUInfo()
-{
-    QMap<quint32, ProcessGPUInfo> gpusPerProcessInfo;
-    
-    unsigned int deviceCount = 0;
-    nvmlReturn_t result = nvmlDeviceGetCount(&deviceCount);
-    if (result != NVML_SUCCESS || deviceCount == 0) 
-    {
-        nvmlShutdown();
-        return gpusPerProcessInfo;
-    }
-
-    for (unsigned int i = 0; i < deviceCount; i++) 
-    {
-        nvmlDevice_t device;
-        result = nvmlDeviceGetHandleByIndex(i, &device);
-        if (result == NVML_SUCCESS) 
-        {
-            ProcessGPUInfo gpuProcessInfo;
-
-            nvmlProcessUtilizationSample_t* utilization;
-            quint64 lastSeenTimeStamp;
-            quint32 processSamplesCount;
-
-            result = nvmlDeviceGetProcessUtilization(device, NULL, &processSamplesCount, 0);
-            utilization = new nvmlProcessUtilizationSample_t[processSamplesCount];
-            result = nvmlDeviceGetProcessUtilization(device, utilization, &processSamplesCount, 0);
-            for (int i = 0; i < processSamplesCount; i++)
-            {
-                gpuProcessInfo.pid = utilization[i].pid;
-                gpuProcessInfo.gpuUtilization = utilization[i].smUtil;
-                gpusPerProcessInfo[gpuProcessInfo.pid] = gpuProcessInfo;
-            }
-            delete[] utilization;
-        }
-    }
-    
-    return gpusPerProcessInfo;
-}
-
-QList<GPUInfo> WindowsGPUMonitor::getNvidiaGPUInfo() 
-{
-    QList<GPUInfo> gpusInfo;
-
-    unsigned int deviceCount = 0;
-    nvmlReturn_t result = nvmlDeviceGetCount(&deviceCount);
-    if (result != NVML_SUCCESS || deviceCount == 0) 
-    {
-        nvmlShutdown();
-        return gpusInfo;
-    }
-
-    for (unsigned int i = 0; i < deviceCount; i++) 
-    {
-        nvmlDevice_t device;
-        result = nvmlDeviceGetHandleByIndex(i, &device);
-        if (result == NVML_SUCCESS) 
-        {
-            GPUInfo gpu;
-            gpu.vendor = "NVIDIA";
-
-            // Получаем имя устройства
-            char name[NVML_DEVICE_NAME_V2_BUFFER_SIZE];
-            if (nvmlDeviceGetName(device, name, sizeof(name)) == NVML_SUCCESS) 
-            {
-                gpu.name = name;
-            }
-
-            // Использование GPU
-            nvmlUtilization_t utilization;
-            if (nvmlDeviceGetUtilizationRates(device, &utilization) == NVML_SUCCESS) 
-            {
-                gpu.usage = utilization.gpu;
-            }
-
-            // Информация о памяти
-            nvmlMemory_t memory;
-            if (nvmlDeviceGetMemoryInfo(device, &memory) == NVML_SUCCESS) 
-            {
-                gpu.totalMemoryBytes = memory.total;
-                gpu.usedMemoryBytes = memory.used;
-            }
-
-            // Температура
-            unsigned int temp;
-            if (nvmlDeviceGetTemperature(device, NVML_TEMPERATURE_GPU, &temp) == NVML_SUCCESS) 
-            {
-                gpu.temperatureCelsius = temp;
-            }
-
-            // Использование мощности
-            unsigned int power;
-            if (nvmlDeviceGetPowerUsage(device, &power) == NVML_SUCCESS) 
-            {
-                gpu.powerUsage = power / 1000; // В ватты
-            }
-
-            // Версия драйвера
-            char driver[80];
-            if (nvmlSystemGetDriverVersion(driver, sizeof(driver)) == NVML_SUCCESS) 
-            {
-                gpu.driverVersion = driver;
-            }
-
-            gpusInfo.push_back(gpu);
-        }
-    }
-
-    return gpusInfo;
-}
-
-void* __stdcall ADL_Main_Memory_Alloc(int iSize)
-{
-    void* lpBuffer = malloc(iSize);
-    return lpBuffer;
-}
-
-void __stdcall ADL_Main_Memory_Free(void* lpBuffer)
-{
-    if (NULL != lpBuffer)
-    {
-        free(lpBuffer);
-        lpBuffer = NULL;
-    }
-}
-
-bool WindowsGPUMonitor::initializeADL() 
-{
-    HINSTANCE hDLL;		
-    hDLL = LoadLibrary(L"atiadlxx.dll");
-    if (hDLL == nullptr)
-    {
-        return false;
-    }
-
-    ADL2_Adapter_NumberOfAdapters_Get = (ADL2_ADAPTER_NUMBEROFADAPTERS_GET)GetProcAddress(hDLL, "ADL2_Adapter_NumberOfAdapters_Get");
-    ADL2_Main_Control_Create = (ADL2_MAIN_CONTROL_CREATE)GetProcAddress(hDLL, "ADL2_Main_Control_Create");
-    ADL2_Main_Control_Destroy = (ADL2_MAIN_CONTROL_DESTROY)GetProcAddress(hDLL, "ADL2_Main_Control_Destroy");
-    ADL2_Display_Modes_Get = (ADL2_DISPLAY_MODES_GET)GetProcAddress(hDLL, "ADL2_Display_Modes_Get");
-    ADL2_Adapter_Active_Get = (ADL2_ADAPTER_ACTIVE_GET)GetProcAddress(hDLL, "ADL2_Adapter_Active_Get");
-    ADL2_Graphics_VersionsX2_Get = (ADL2_GRAPHICS_VERSIONSX2_GET)GetProcAddress(hDLL, "ADL2_Graphics_VersionsX2_Get");
-    ADL2_Adapter_AdapterInfo_Get = (ADL2_ADAPTER_ADAPTERINFO_GET)GetProcAddress(hDLL, "ADL2_Adapter_AdapterInfoX2_Get");
-    ADL2_Overdrive5_CurrentActivity_Get = (ADL2_OVERDRIVE5_CURRENTACTIVITY_GET)GetProcAddress(hDLL, "ADL2_Overdrive5_CurrentActivity_Get");
-    ADL2_New_QueryPMLogDataGet = (ADL2_NEW_QUERYPMLOGDATA_GET)GetProcAddress(hDLL, "ADL2_New_QueryPMLogData_Get");
-    ADL2_Adapter_MemoryInfo_Get = (ADL2_ADAPTER_MEMORYINFO_GET)GetProcAddress(hDLL, "ADL2_Adapter_MemoryInfo2_Get");
-    ADL2_Adapter_VRAMUsage_Get = (ADL2_ADAPTER_VRAMUSAGE_GET)GetProcAddress(hDLL, "ADL2_Adapter_DedicatedVRAMUsage_Get");
-
-    if (ADL_OK != ADL2_Main_Control_Create(ADL_Main_Memory_Alloc, 1, &context))
-    {
-        return false;
-    }
-
-    return true;
-}
-
-bool WindowsGPUMonitor::initializeNVML()
-{
-    nvmlReturn_t result = nvmlInit();
-    return result == NVML_SUCCESS;
-}
-
-int WindowsGPUMonitor::GetAdapterActiveStatus(int adapterId, int& active) const
-{
-    active = 0;
-
-    int result = ADL2_Adapter_Active_Get(context, adapterId, &active);
-
-    return result;
-}
-
-//#pragma runtime_checks("s", off)
-int WindowsGPUMonitor::GetUsedMemory(int adapterId) const
-{
-    int* vramUsage = new int;
-    int result = ADL2_Adapter_VRAMUsage_Get(context, adapterId, vramUsage);
-    return *vramUsage;
-}
-//#pragma runtime_checks("s", on)
-
-QList<GPUInfo> WindowsGPUMonitor::getAMDGPUInfo() 
-{
-    QList<GPUInfo> gpus;
-
-    int  numberAdapters;
-
-    if (ADL_OK != ADL2_Adapter_NumberOfAdapters_Get(context, &numberAdapters))
-    {
-        return gpus;
-    }
-
-    int active = 0;
-
-    for (int i = 0; i < numberAdapters; i++) 
-    {
-        if (ADL_OK == GetAdapterActiveStatus(i, active))
-        {
-            GPUInfo gpuInfo;
-            if (active)
-            {
-                int numModes;
-                ADLMode* adlMode;
-                // Комбинация параметров вывода видеоадаптера на данный дисплей. Проверяется для того, чтобы исключить виртуальные адаптеры и не выводить информацию о них
-                if (ADL_OK == ADL2_Display_Modes_Get(context, i, -1, &numModes, &adlMode))
-                {
-                    if (numModes != 0)
-                    {
-                        AdapterInfo** info = new AdapterInfo * ();
-                        // Получение статической информации об адаптере (для получения имени)
-                        int result = ADL2_Adapter_AdapterInfo_Get(context, info);
-                        ADLPMLogDataOutput* pmData = new ADLPMLogDataOutput();
-                        // Получение информации от датчиков производительности (динамические параметры)
-                        result = ADL2_New_QueryPMLogDataGet(context, i, pmData);
-                        ADLMemoryInfo2* meminfo = new ADLMemoryInfo2;
-                        // Возвращает структуру, хранящую объем памяти видеоадаптера
-                        result = ADL2_Adapter_MemoryInfo_Get(context, i, meminfo);
-                       
-                        gpuInfo.name = (*info)->strAdapterName;
-                        gpuInfo.totalMemoryBytes = meminfo->iMemorySize;
-                        gpuInfo.usage = pmData->sensors[ADL_PMLOG_GFX_CURRENT].value;
-                        gpuInfo.usedMemoryBytes = GetUsedMemory(i) * 1024 * 1024;
-                        gpuInfo.temperatureCelsius = pmData->sensors[ADL_PMLOG_TEMPERATURE_GFX].value;
-                        gpuInfo.powerUsage = pmData->sensors[ADL_PMLOG_GFX_POWER].value;
-                        gpuInfo.vendor = "AMD";
-                        gpus.append(gpuInfo);
-                        ADL_Main_Memory_Free(adlMode);
-                    }
-                }
-            }
-        }
-    }
-
-    return gpus;
-}
\ No newline at end of file
@@ -1,9 +1,12 @@
 ﻿#include "WindowsNetworkMonitor.h"
-#include <QDateTime>
 #include <QDebug>
 #include <QString>
+#include <QHash>
+#include <winsock2.h>
+#include <ws2tcpip.h>
 #include <windows.h>
 #include <iphlpapi.h>
+#include <tcpestats.h>
 
 WindowsNetworkMonitor::WindowsNetworkMonitor() 
 {
@@ -16,85 +19,264 @@ WindowsNetworkMonitor::~WindowsNetworkMonitor()
 
 bool WindowsNetworkMonitor::initNetworkCounters() 
 {
-    _lastUpdateTime = QDateTime::currentMSecsSinceEpoch();
+    _interfaceRates.clear();
     return true;
 }
 
+void WindowsNetworkMonitor::setAdapterFilter(quint32 adapterTypes)
+{
+    _adapterFilter = adapterTypes;
+}
+
+static NetworkAdapterType adapterType(const MIB_IF_ROW2& row)
+{
+    switch (row.Type)
+    {
+    case IF_TYPE_SOFTWARE_LOOPBACK:
+        return natLoopback;
+    case IF_TYPE_TUNNEL:
+    case IF_TYPE_PPP:
+        return natTunnel;
+    case IF_TYPE_ETHERNET_CSMACD:
+    case IF_TYPE_IEEE80211:
+        // vEthernet Hyper-V, адаптеры VPN и NIC Teaming видны как Ethernet без физического устройства
+        if (!row.InterfaceAndOperStatusFlags.HardwareInterface)
+        {
+            return natVirtual;
+        }
+        return row.Type == IF_TYPE_IEEE80211 ? natWireless : natEthernet;
+    default:
+        return natOther;
+    }
+}
+
 QList<NetworkInterfaceInfo> WindowsNetworkMonitor::getNetworkInfo() 
 {
     QList<NetworkInterfaceInfo> interfaces;
 
-    qint64 currentTime = QDateTime::currentMSecsSinceEpoch();
-    double elapsedSec = (currentTime - _lastUpdateTime) / 1000.0;
-    _lastUpdateTime = currentTime;
+    // Таблица интерфейсов с 64-битными счётчиками: 32-битные dwInOctets из GetIfTable
+    // на 10 Гбит/с переполняются за несколько секунд
+    MIB_IF_TABLE2* table = nullptr;
+    if (GetIfTable2(&table) != NO_ERROR)
+    {
+        return interfaces;
+    }
 
-    // Получаем таблицу интерфейсов (из Management Information Base)
-    MIB_IFTABLE* pIfTable = nullptr;
-    ULONG dwSize = 0;
-    DWORD dwRetVal = 0;
+    _interfaceRates.beginSample();
 
-    dwRetVal = GetIfTable(pIfTable, &dwSize, FALSE);
-    if (dwRetVal == ERROR_INSUFFICIENT_BUFFER) 
+    for (ULONG i = 0; i < table->NumEntries; i++)
     {
-        pIfTable = (MIB_IFTABLE*)malloc(dwSize);
-        if (!pIfTable) 
+        const MIB_IF_ROW2& row = table->Table[i];
+
+        // Фильтры NDIS (WFP, QoS) дублируют строку адаптера, под которым установлены
+        if (row.InterfaceAndOperStatusFlags.FilterInterface)
+        {
+            continue;
+        }
+
+        NetworkAdapterType type = adapterType(row);
+        bool isUp = row.OperStatus == IfOperStatusUp;
+        if (!(_adapterFilter & type))
         {
-            return interfaces;
+            continue;
         }
 
-        dwRetVal = GetIfTable(pIfTable, &dwSize, FALSE);
+        // Неактивные программные адаптеры (WAN Miniport, отключённые VPN) только засоряют список
+        if (!isUp && type != natEthernet && type != natWireless)
+        {
+            continue;
+        }
+
+        NetworkInterfaceInfo info;
+        info.name = QString::fromWCharArray(row.Alias);
+        info.description = QString::fromWCharArray(row.Description);
+        info.type = type;
+        info.isUp = isUp;
+        info.bytesReceived = row.InOctets;
+        info.bytesSent = row.OutOctets;
+        info.packetsReceived = row.InUcastPkts;
+        info.packetsSent = row.OutUcastPkts;
+
+        // LUID не меняется при переподключении адаптера, в отличие от индекса
+        RateTracker<2>::Rates rates;
+        _interfaceRates.update(row.InterfaceLuid.Value, 0, { info.bytesReceived, info.bytesSent }, rates);
+        info.receiveBytesPerSec = rates[0];
+        info.sendBytesPerSec = rates[1];
+
+        interfaces.append(info);
     }
 
-    if (dwRetVal == NO_ERROR) {
-        for (DWORD i = 0; i < pIfTable->dwNumEntries; i++) 
+    FreeMibTable(table);
+
+    _interfaceRates.endSample();
+    return interfaces;
+}
+
+bool WindowsNetworkMonitor::readInterfaceCounters(const QString& name, quint64& bytesReceived, quint64& bytesSent)
+{
+    if (name != _counterInterfaceName)
+    {
+        NET_LUID luid;
+        if (ConvertInterfaceAliasToLuid(reinterpret_cast<const wchar_t*>(name.utf16()), &luid) != NO_ERROR)
         {
-            MIB_IFROW& row = pIfTable->table[i];
+            return false;
+        }
+        _counterInterfaceName = name;
+        _counterInterfaceLuid = luid.Value;
+    }
 
-            // Пропускаем loopback
-            if (row.dwType == IF_TYPE_SOFTWARE_LOOPBACK) 
-            {
-                continue;
-            }
+    // GetIfEntry2 читает одну строку по LUID, без выделения всей таблицы, как GetIfTable2
+    MIB_IF_ROW2 row = {};
+    row.InterfaceLuid.Value = _counterInterfaceLuid;
+    if (GetIfEntry2(&row) != NO_ERROR)
+    {
+        // Адаптер мог быть удалён и добавлен заново с другим LUID
+        _counterInterfaceName.clear();
+        return false;
+    }
 
-            // Фильтруем только Ethernet и Wi-Fi адаптеры
-            bool isEthernet = (row.dwType == IF_TYPE_ETHERNET_CSMACD);
-            bool isWireless = (row.dwType == IF_TYPE_IEEE80211);
+    bytesReceived = row.InOctets;
+    bytesSent = row.OutOctets;
+    return true;
+}
 
-            if (!isEthernet && !isWireless) 
-            {
-                continue;
-            }
+QMap<quint32, ProcessNetworkInfo> WindowsNetworkMonitor::getProcessNetworkInfo()
+{
+    QMap<quint32, ProcessNetworkInfo> processes;
 
-            NetworkInterfaceInfo info;
-            info.name = QString::fromWCharArray((wchar_t*)row.wszName);
-            info.description = QString::fromLocal8Bit((char*)row.bDescr, row.dwDescrLen);
-            info.bytesReceived = row.dwInOctets;
-            info.bytesSent = row.dwOutOctets;
-            info.packetsReceived = row.dwInUcastPkts;
-            info.packetsSent = row.dwOutUcastPkts;
+    // Сбор ESTATS включается для каждого соединения отдельно и требует прав администратора
+    if (!_estatsAvailable)
+    {
+        return processes;
+    }
 
-            // Вычисляем скорость
-            QString key = QString::number(row.dwIndex);
-            quint64 lastReceived = _lastBytesReceived.value(key, 0);
-            quint64 lastSent = _lastBytesSent.value(key, 0);
+    _connectionRates.beginSample();
+    _estatsEnabledNow.clear();
 
-            if (elapsedSec > 0) 
+    collectTcp4Connections(processes);
+    collectTcp6Connections(processes);
+
+    // Закрытые соединения забываем, чтобы не держать их ключи
+    _estatsEnabled.swap(_estatsEnabledNow);
+    _connectionRates.endSample();
+
+    return processes;
+}
+
+bool WindowsNetworkMonitor::readExtendedTcpTable(int family)
+{
+    // Буфер переиспользуется между тактами и растёт только при нехватке места
+    DWORD size = static_cast<DWORD>(_tcpTableBuffer.size());
+    DWORD result = GetExtendedTcpTable(_tcpTableBuffer.empty() ? nullptr : _tcpTableBuffer.data(), &size, FALSE, family, TCP_TABLE_OWNER_PID_CONNECTIONS, 0);
+    if (result == ERROR_INSUFFICIENT_BUFFER)
+    {
+        _tcpTableBuffer.resize(size + size / 4);
+        size = static_cast<DWORD>(_tcpTableBuffer.size());
+        result = GetExtendedTcpTable(_tcpTableBuffer.data(), &size, FALSE, family, TCP_TABLE_OWNER_PID_CONNECTIONS, 0);
+    }
+    return result == NO_ERROR;
+}
+
+void WindowsNetworkMonitor::addConnection(QMap<quint32, ProcessNetworkInfo>& processes, quint64 key, quint32 pid, quint64 bytesIn, quint64 bytesOut)
+{
+    // Новое соединение даёт скорость со следующего такта, накопленное до этого в скорость не попадает
+    RateTracker<2>::Rates rates;
+    _connectionRates.update(key, pid, { bytesIn, bytesOut }, rates);
+
+    ProcessNetworkInfo& info = processes[pid];
+    info.pid = pid;
+    info.connectionCount++;
+    info.bytesReceived += bytesIn;
+    info.bytesSent += bytesOut;
+    info.receiveBytesPerSec += rates[0];
+    info.sendBytesPerSec += rates[1];
+}
+
+void WindowsNetworkMonitor::collectTcp4Connections(QMap<quint32, ProcessNetworkInfo>& processes)
+{
+    if (!readExtendedTcpTable(AF_INET))
+    {
+        return;
+    }
+
+    auto table = reinterpret_cast<MIB_TCPTABLE_OWNER_PID*>(_tcpTableBuffer.data());
+    for (DWORD i = 0; i < table->dwNumEntries && _estatsAvailable; i++)
+    {
+        const MIB_TCPROW_OWNER_PID& ownerRow = table->table[i];
+
+        MIB_TCPROW row = {};
+        row.dwState = ownerRow.dwState;
+        row.dwLocalAddr = ownerRow.dwLocalAddr;
+        row.dwLocalPort = ownerRow.dwLocalPort;
+        row.dwRemoteAddr = ownerRow.dwRemoteAddr;
+        row.dwRemotePort = ownerRow.dwRemotePort;
+
+        quint64 key = qHashMulti(4, ownerRow.dwLocalAddr, ownerRow.dwLocalPort, ownerRow.dwRemoteAddr, ownerRow.dwRemotePort);
+        if (!_estatsEnabled.contains(key))
+        {
+            TCP_ESTATS_DATA_RW_v0 rw = { TRUE };
+            ULONG status = SetPerTcpConnectionEStats(&row, TcpConnectionEstatsData, reinterpret_cast<PUCHAR>(&rw), 0, sizeof(rw), 0);
+            if (status != NO_ERROR)
             {
-                info.receiveBytesPerSec = (info.bytesReceived - lastReceived) / elapsedSec;
-                info.sendBytesPerSec = (info.bytesSent - lastSent) / elapsedSec;
+                if (status == ERROR_ACCESS_DENIED)
+                {
+                    _estatsAvailable = false;
+                }
+                continue;
             }
+        }
+        _estatsEnabledNow.insert(key);
 
-            _lastBytesReceived[key] = info.bytesReceived;
-            _lastBytesSent[key] = info.bytesSent;
-
-            interfaces.append(info);
+        TCP_ESTATS_DATA_ROD_v0 rod = {};
+        if (GetPerTcpConnectionEStats(&row, TcpConnectionEstatsData, nullptr, 0, 0, nullptr, 0, 0, reinterpret_cast<PUCHAR>(&rod), 0, sizeof(rod)) == NO_ERROR)
+        {
+            addConnection(processes, key, ownerRow.dwOwningPid, rod.DataBytesIn, rod.DataBytesOut);
         }
     }
+}
 
-    if (pIfTable) 
+void WindowsNetworkMonitor::collectTcp6Connections(QMap<quint32, ProcessNetworkInfo>& processes)
+{
+    if (!_estatsAvailable || !readExtendedTcpTable(AF_INET6))
     {
-        free(pIfTable);
+        return;
     }
 
-    return interfaces;
-}
\ No newline at end of file
+    auto table = reinterpret_cast<MIB_TCP6TABLE_OWNER_PID*>(_tcpTableBuffer.data());
+    for (DWORD i = 0; i < table->dwNumEntries && _estatsAvailable; i++)
+    {
+        const MIB_TCP6ROW_OWNER_PID& ownerRow = table->table[i];
+
+        MIB_TCP6ROW row = {};
+        row.State = static_cast<MIB_TCP_STATE>(ownerRow.dwState);
+        memcpy(&row.LocalAddr, ownerRow.ucLocalAddr, sizeof(row.LocalAddr));
+        row.dwLocalScopeId = ownerRow.dwLocalScopeId;
+        row.dwLocalPort = ownerRow.dwLocalPort;
+        memcpy(&row.RemoteAddr, ownerRow.ucRemoteAddr, sizeof(row.RemoteAddr));
+        row.dwRemoteScopeId = ownerRow.dwRemoteScopeId;
+        row.dwRemotePort = ownerRow.dwRemotePort;
+
+        quint64 key = qHashMulti(6, QByteArrayView(ownerRow.ucLocalAddr, sizeof(ownerRow.ucLocalAddr)), ownerRow.dwLocalPort,
+            QByteArrayView(ownerRow.ucRemoteAddr, sizeof(ownerRow.ucRemoteAddr)), ownerRow.dwRemotePort);
+        if (!_estatsEnabled.contains(key))
+        {
+            TCP_ESTATS_DATA_RW_v0 rw = { TRUE };
+            ULONG status = SetPerTcp6ConnectionEStats(&row, TcpConnectionEstatsData, reinterpret_cast<PUCHAR>(&rw), 0, sizeof(rw), 0);
+            if (status != NO_ERROR)
+            {
+                if (status == ERROR_ACCESS_DENIED)
+                {
+                    _estatsAvailable = false;
+                }
+                continue;
+            }
+        }
+        _estatsEnabledNow.insert(key);
+
+        TCP_ESTATS_DATA_ROD_v0 rod = {};
+        if (GetPerTcp6ConnectionEStats(&row, TcpConnectionEstatsData, nullptr, 0, 0, nullptr, 0, 0, reinterpret_cast<PUCHAR>(&rod), 0, sizeof(rod)) == NO_ERROR)
+        {
+            addConnection(processes, key, ownerRow.dwOwningPid, rod.DataBytesIn, rod.DataBytesOut);
+        }
+    }
+}
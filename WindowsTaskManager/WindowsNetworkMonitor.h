@@ -3,6 +3,9 @@
 #include "INetworkMonitor.h"
 #include "WindowsNetworkMonitor.h"
 #include "DataStructs.h"
+#include "RateTracker.h"
+#include <QSet>
+#include <vector>
 
 class WindowsNetworkMonitor : public INetworkMonitor 
 {
@@ -10,11 +13,29 @@ public:
     WindowsNetworkMonitor();
     ~WindowsNetworkMonitor();
     QList<NetworkInterfaceInfo> getNetworkInfo() override;
+    void setAdapterFilter(quint32 adapterTypes) override;
+    QMap<quint32, ProcessNetworkInfo> getProcessNetworkInfo() override;
+    bool readInterfaceCounters(const QString& name, quint64& bytesReceived, quint64& bytesSent) override;
 
 private:
-    QMap<QString, quint64> _lastBytesReceived;
-    QMap<QString, quint64> _lastBytesSent;
-    qint64 _lastUpdateTime = 0;
+    // Принято/отправлено байт по LUID интерфейса
+    RateTracker<2> _interfaceRates;
+    quint32 _adapterFilter = DEFAULT_NETWORK_ADAPTER_FILTER;
+
+    // Адаптер частых замеров: LUID ищется по псевдониму один раз при смене адаптера
+    QString _counterInterfaceName;
+    quint64 _counterInterfaceLuid = 0;
+
+    // Для процессов: счётчики TCP ESTATS по соединениям, ключ - хэш адресов и портов, экземпляр - PID
+    RateTracker<2> _connectionRates;
+    QSet<quint64> _estatsEnabled;
+    QSet<quint64> _estatsEnabledNow;
+    bool _estatsAvailable = true;
+    std::vector<quint8> _tcpTableBuffer;
 
     bool initNetworkCounters();
+    void collectTcp4Connections(QMap<quint32, ProcessNetworkInfo>& processes);
+    void collectTcp6Connections(QMap<quint32, ProcessNetworkInfo>& processes);
+    bool readExtendedTcpTable(int family);
+    void addConnection(QMap<quint32, ProcessNetworkInfo>& processes, quint64 key, quint32 pid, quint64 bytesIn, quint64 bytesOut);
 };
\ No newline at end of file
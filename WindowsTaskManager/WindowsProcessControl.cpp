@@ -1,14 +1,18 @@
 ﻿#include "WindowsProcessControl.h"
+#include "AccountNameResolver.h"
 #include <TlHelp32.h>
 #include <winternl.h>
 #include <windows.h>
+#include <QSemaphore>
+#include <QThread>
+#include <vector>
 
 const quint32 GRACEFUL_KILL_PROCESS_TIMEOUT = 3000;
 
 QString WindowsProcessControl::getProcessPath(quint32 pid) 
 {
     QString path = "";
-    HANDLE h_proc = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, pid);
+    HANDLE h_proc = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
     if (h_proc) 
     {
         wchar_t buffer[MAX_PATH];
@@ -22,63 +26,215 @@ QString WindowsProcessControl::getProcessPath(quint32 pid)
     return path;
 }
 
-quint32 WindowsProcessControl::getParentPID(quint32 pid) 
+WindowsProcessControl::WindowsProcessControl()
 {
-    HANDLE h_snap = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+    _detailsPool.setMaxThreadCount(qBound(1, QThread::idealThreadCount(), MAX_PARALLEL_WORKERS));
+}
+
+WindowsProcessControl::~WindowsProcessControl()
+{
+    _detailsPool.waitForDone();
+}
+
+std::shared_ptr<const WindowsProcessControl::ProcessSnapshot> WindowsProcessControl::takeProcessSnapshot()
+{
+    auto snapshot = std::make_shared<ProcessSnapshot>();
+
+    // Процессы и потоки одним снимком: обход потоков по всей системе нужен только раз на такт, а не на каждый процесс
+    HANDLE h_snap = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS | TH32CS_SNAPTHREAD, 0);
     if (h_snap == INVALID_HANDLE_VALUE) 
     {
-        return 0;
+        return snapshot;
     }
 
     PROCESSENTRY32 entry;
     entry.dwSize = sizeof(entry);
-
     if (Process32First(h_snap, &entry)) 
     {
         do 
         {
-            if (entry.th32ProcessID == pid) 
-            {
-                quint32 ppid = entry.th32ParentProcessID;
-                CloseHandle(h_snap);
-                return ppid;
-            }
+            snapshot->parentPIDs.insert(entry.th32ProcessID, entry.th32ParentProcessID);
         } while (Process32Next(h_snap, &entry));
     }
 
+    THREADENTRY32 te = { 0 };
+    te.dwSize = sizeof(te);
+    if (Thread32First(h_snap, &te)) 
+    {
+        do 
+        {
+            snapshot->threadCounts[te.th32OwnerProcessID]++;
+        } while (Thread32Next(h_snap, &te));
+    }
+
     CloseHandle(h_snap);
-    return 0;
+    return snapshot;
+}
+
+std::shared_ptr<const WindowsProcessControl::ProcessSnapshot> WindowsProcessControl::processSnapshot()
+{
+    QMutexLocker locker(&_snapshotMutex);
+    if (!_snapshot || _snapshotAge.hasExpired(SNAPSHOT_MAX_AGE_MS))
+    {
+        _snapshot = takeProcessSnapshot();
+        _snapshotAge.start();
+    }
+    return _snapshot;
+}
+
+static QDateTime dateTimeFromFileTime(const FILETIME& fileTime)
+{
+    ULARGE_INTEGER uli;
+    uli.LowPart = fileTime.dwLowDateTime;
+    uli.HighPart = fileTime.dwHighDateTime;
+    // FILETIME - время в 100-наносекундных интервалах с 1601-01-01 (UTC)
+    // QDateTime ожидает миллисекунды с 1970-01-01 (Unix epoch)
+    qint64 epoch_offset = 11644473600LL * 10000000LL; // разница между 1601 и 1970 в 100ns
+    qint64 unix_time_100ns = uli.QuadPart - epoch_offset; // приводим к времени с 1970
+    qint64 unix_time_ms = unix_time_100ns / 10000; // в милисекунды
+    return QDateTime::fromMSecsSinceEpoch(unix_time_ms);
+}
+
+void WindowsProcessControl::fillProcessDetails(ProcessDetails& details, quint32 fields)
+{
+    if (fields & pdfUserName)
+    {
+        details.userName = "Не определен";
+    }
+    details.priorityClass = ProcessPriorityString[ppUnknown];
+
+    // Одного дескриптора с ограниченными правами хватает на все поля, и его дают и для многих чужих процессов
+    HANDLE h_proc = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, details.pid);
+    if (!h_proc) 
+    {
+        return;
+    }
+
+    if (fields & pdfPath)
+    {
+        wchar_t buffer[MAX_PATH];
+        DWORD size = MAX_PATH;
+        if (QueryFullProcessImageNameW(h_proc, 0, buffer, &size)) 
+        {
+            details.path = QString::fromWCharArray(buffer, size);
+        }
+    }
+
+    // Время запуска нужно всегда: по нему кэшируются неизменяемые поля
+    FILETIME creation_time, exit_time, kernel_time, user_time;
+    if (GetProcessTimes(h_proc, &creation_time, &exit_time, &kernel_time, &user_time)) 
+    {
+        details.startTime = dateTimeFromFileTime(creation_time);
+    }
+
+    if (fields & pdfHandleCount)
+    {
+        DWORD handle_count = 0;
+        if (GetProcessHandleCount(h_proc, &handle_count)) 
+        {
+            details.handleCount = handle_count;
+        }
+    }
+
+    if (fields & pdfPriority)
+    {
+        details.priority = getProcessPriority(GetPriorityClass(h_proc));
+        details.priorityClass = ProcessPriorityString[details.priority];
+    }
+    if (fields & pdfUserName)
+    {
+        // Имя по SID ищется в фоне: пока поиск не завершён, вместо имени строковый SID
+        details.accountId = getProcessAccountId(h_proc);
+        if (!details.accountId.isEmpty())
+        {
+            details.userName = AccountNameResolver::instance().accountName(details.accountId);
+        }
+    }
+    if (fields & pdfCommandLine)
+    {
+        details.commandLine = getProcessCommandLine(h_proc);
+    }
+
+    CloseHandle(h_proc);
 }
 
 ProcessDetails WindowsProcessControl::getProcessDetails(quint32 pid, const QList<ProcessInfo> processes) 
 {
-    ProcessDetails details;
-    ProcessInfo info;
-    for (auto& processInfo : processes) 
+    return getProcessDetails(QList<quint32>{ pid }, processes, PROCESS_DETAIL_ALL_FIELDS).value(0);
+}
+
+QList<ProcessDetails> WindowsProcessControl::getProcessDetails(const QList<quint32>& pids, const QList<ProcessInfo>& processes, quint32 fields)
+{
+    // Без числа потоков снимок нужен только для процессов, которых нет в списке
+    std::shared_ptr<const ProcessSnapshot> snapshot = (fields & pdfThreadCount) || processes.isEmpty()
+        ? processSnapshot() : std::make_shared<const ProcessSnapshot>();
+
+    // Индексы по PID строятся один раз на пакет вместо прохода по списку для каждого процесса
+    QHash<quint32, const ProcessInfo*> infoByPid;
+    QHash<quint32, quint32> childCounts;
+    infoByPid.reserve(processes.size());
+    for (const auto& processInfo : processes) 
+    {
+        infoByPid.insert(processInfo.pid, &processInfo);
+        childCounts[processInfo.parentPID]++;
+    }
+
+    QList<ProcessDetails> result(pids.size());
+    for (qsizetype i = 0; i < pids.size(); i++) 
+    {
+        ProcessDetails& details = result[i];
+        quint32 pid = pids[i];
+        details.pid = pid;
+        details.parentPID = snapshot->parentPIDs.value(pid);
+        details.threadCount = snapshot->threadCounts.value(pid);
+        details.childProcessesCount = childCounts.value(pid);
+
+        const ProcessInfo* info = infoByPid.value(pid, nullptr);
+        if (info) 
+        {
+            details.name = info->name;
+            details.cpuUsage = info->cpuUsage;
+            details.memoryUsage = info->memoryUsage;
+            details.workingSetSize = info->workingSetSize;
+            if (!snapshot->parentPIDs.contains(pid))
+            {
+                details.parentPID = info->parentPID;
+            }
+        }
+    }
+
+    // Системные вызовы по каждому процессу независимы: большой пакет делится на части для пула потоков
+    if (result.size() < PARALLEL_BATCH_THRESHOLD || _detailsPool.maxThreadCount() < 2)
     {
-        if (processInfo.pid == pid) 
+        for (auto& details : result) 
         {
-            info = processInfo;
+            fillProcessDetails(details, fields);
         }
+        return result;
     }
 
-    details.pid = pid;
-    details.path = getProcessPath(pid);
-    details.cpuUsage = info.cpuUsage;
-    details.memoryUsage = info.memoryUsage;
-    details.workingSetSize = info.workingSetSize;
-    details.name = info.name;
-    details.parentPID = getParentPID(pid);
-    details.threadCount = getThreadCount(pid);
-    details.startTime = getStartTime(pid);
-    details.childProcessesCount = getChildProcessCount(pid, processes);
-    details.userName = getProcessUserName(pid);
-    details.priorityClass = getProcessPriorityClass(pid);
-    
-
-    details.handleCount = getHandleCount(pid);
-
-    return details;
+    const qsizetype chunkCount = qMin<qsizetype>(_detailsPool.maxThreadCount(), result.size() / (PARALLEL_BATCH_THRESHOLD / 2));
+    const qsizetype chunkSize = (result.size() + chunkCount - 1) / chunkCount;
+    ProcessDetails* data = result.data();
+    QSemaphore done;
+    int started = 0;
+    for (qsizetype begin = 0; begin < result.size(); begin += chunkSize) 
+    {
+        qsizetype end = qMin(begin + chunkSize, result.size());
+        _detailsPool.start([data, begin, end, fields, &done]()
+            {
+            for (qsizetype i = begin; i < end; i++) 
+            {
+                fillProcessDetails(data[i], fields);
+            }
+            done.release();
+        });
+        started++;
+    }
+    // Ждём только свои части: пакеты из разных потоков могут делить пул
+    done.acquire(started);
+
+    return result;
 }
 
 bool WindowsProcessControl::killProcess(quint32 pId) 
@@ -251,158 +407,69 @@ bool WindowsProcessControl::killProcessGracefully(quint32 pId)
     return false;
 }
 
-quint32 WindowsProcessControl::getThreadCount(quint32 pid) 
+QByteArray WindowsProcessControl::getProcessAccountId(HANDLE hProc) 
 {
-    quint32 count = 0;
-    HANDLE h_snap = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
-    if (h_snap != INVALID_HANDLE_VALUE) 
+    QByteArray accountId;
+    HANDLE h_token = nullptr;
+    if (OpenProcessToken(hProc, TOKEN_QUERY, &h_token)) 
     {
-        THREADENTRY32 te = { 0 };
-        te.dwSize = sizeof(te);
-        if (Thread32First(h_snap, &te)) 
+        // TOKEN_USER с SID максимальной длины помещается в буфер на стеке, второй вызов для размера не нужен
+        alignas(TOKEN_USER) BYTE buffer[sizeof(TOKEN_USER) + SECURITY_MAX_SID_SIZE];
+        DWORD size = 0;
+        if (GetTokenInformation(h_token, TokenUser, buffer, sizeof(buffer), &size)) 
         {
-            do {
-                if (te.th32OwnerProcessID == pid) 
-                {
-                    count++;
-                }
-            } while (Thread32Next(h_snap, &te));
+            accountId = AccountNameResolver::accountId(reinterpret_cast<TOKEN_USER*>(buffer)->User.Sid);
         }
-        CloseHandle(h_snap);
+        CloseHandle(h_token);
     }
-    return count;
+    return accountId;
 }
 
-QDateTime WindowsProcessControl::getStartTime(quint32 pid) 
+QString WindowsProcessControl::getProcessCommandLine(HANDLE hProc) 
 {
-    QDateTime dt;
-    HANDLE h_proc = OpenProcess(PROCESS_QUERY_INFORMATION, FALSE, pid);
-    if (h_proc) 
+    // ProcessCommandLineInformation (60) читает командную строку без PROCESS_VM_READ, в отличие от разбора PEB
+    using NtQueryInformationProcessFn = NTSTATUS(NTAPI*)(HANDLE, PROCESSINFOCLASS, PVOID, ULONG, PULONG);
+    static const auto queryInformation = reinterpret_cast<NtQueryInformationProcessFn>(
+        GetProcAddress(GetModuleHandleW(L"ntdll.dll"), "NtQueryInformationProcess"));
+    const auto ProcessCommandLineInformation = static_cast<PROCESSINFOCLASS>(60);
+    if (!queryInformation) 
     {
-        FILETIME creation_time, exit_time, kernel_time, user_time;
-        if (GetProcessTimes(h_proc, &creation_time, &exit_time, &kernel_time, &user_time)) 
-        {
-            // Преобразуем FILETIME в QDateTime
-            ULARGE_INTEGER uli;
-            uli.LowPart = creation_time.dwLowDateTime;
-            uli.HighPart = creation_time.dwHighDateTime;
-            // FILETIME - время в 100-наносекундных интервалах с 1601-01-01 (UTC)
-            // QDateTime ожидает миллисекунды с 1970-01-01 (Unix epoch)
-            qint64 epoch_offset = 11644473600LL * 10000000LL; // разница между 1601 и 1970 в 100ns
-            qint64 unix_time_100ns = uli.QuadPart - epoch_offset; // приводим к времени с 1970
-            qint64 unix_time_ms = unix_time_100ns / 10000; // в милисекунды
-            dt = QDateTime::fromMSecsSinceEpoch(unix_time_ms);
-        }
-        CloseHandle(h_proc);
+        return QString();
     }
-    return dt;
-}
 
-quint32 WindowsProcessControl::getChildProcessCount(quint32 pid, const QList<ProcessInfo>& allProcesses) 
-{
-    quint32 count = 0;
-    for (const auto& proc : allProcesses) 
+    ULONG size = 0;
+    queryInformation(hProc, ProcessCommandLineInformation, nullptr, 0, &size);
+    if (size < sizeof(UNICODE_STRING)) 
     {
-        if (proc.parentPID == pid) 
-        {
-            count++;
-        }
+        return QString();
     }
-    return count;
-}
 
-quint32 WindowsProcessControl::getHandleCount(quint32 pid) 
-{
-    quint32 count = 0;
-    HANDLE h_proc = OpenProcess(PROCESS_QUERY_INFORMATION, FALSE, pid);
-    if (h_proc) 
+    std::vector<BYTE> buffer(size);
+    if (queryInformation(hProc, ProcessCommandLineInformation, buffer.data(), size, &size) < 0) 
     {
-        DWORD handle_count = 0;
-        if (GetProcessHandleCount(h_proc, &handle_count)) 
-        {
-            count = handle_count;
-        }
-        CloseHandle(h_proc);
-    }
-    return count;
-}
-
-int WindowsProcessControl::getPriority(quint32 pid) 
-{
-    int priority = 0;
-    HANDLE h_proc = OpenProcess(PROCESS_QUERY_INFORMATION, FALSE, pid);
-    if (h_proc) 
-    {
-        int priority_class = GetPriorityClass(h_proc);
-        priority = priority_class;
-        CloseHandle(h_proc);
-    }
-    return priority;
-}
-
-QString WindowsProcessControl::getProcessUserName(quint32 pid) 
-{
-    QString userName = "Не определен";
-    HANDLE h_proc = OpenProcess(PROCESS_QUERY_INFORMATION, FALSE, pid);
-    if (h_proc) 
-    {
-        HANDLE h_token = nullptr;
-        if (OpenProcessToken(h_proc, TOKEN_QUERY, &h_token)) 
-        {
-            DWORD size = 0;
-            // Извлекает указанный тип сведений о маркере доступа
-            GetTokenInformation(h_token, TokenUser, nullptr, 0, &size);
-            if (size > 0) 
-            {
-                auto* buffer = (PTOKEN_USER)malloc(size);
-                if (buffer) 
-                {
-                    if (GetTokenInformation(h_token, TokenUser, buffer, size, &size)) 
-                    {
-                        SID_NAME_USE sid_use;
-                        wchar_t name[256];
-                        wchar_t domain[256];
-                        DWORD name_len = 256;
-                        DWORD domain_len = 256;
-                        // Пытается по sid получить "человеческое" имя пользователя
-                        if (LookupAccountSidW(nullptr, buffer->User.Sid, name, &name_len, domain, &domain_len, &sid_use)) {  // SID (Security Identifier) — уникальный двоичный идентификатор субъекта безопасности в Windows: пользователя, группы, компьютера, логон-сессии и т. п.
-                            userName = QString::fromWCharArray(name);
-                        }
-                    }
-                    free(buffer);
-                }
-            }
-            CloseHandle(h_token);
-        }
-        CloseHandle(h_proc);
+        return QString();
     }
-    return userName;
+    auto* commandLine = reinterpret_cast<UNICODE_STRING*>(buffer.data());
+    return QString::fromWCharArray(commandLine->Buffer, commandLine->Length / sizeof(wchar_t));
 }
 
-QString WindowsProcessControl::getProcessPriorityClass(quint32 pid) 
+ProcessPriority WindowsProcessControl::getProcessPriority(DWORD priorityClass) 
 {
-    QString priority = "Не определен";
-    HANDLE h_proc = OpenProcess(PROCESS_QUERY_INFORMATION, FALSE, pid);
-    if (h_proc) 
+    switch (priorityClass) 
     {
-        DWORD priority_class = GetPriorityClass(h_proc);
-        if (priority_class == NORMAL_PRIORITY_CLASS) 
-        {
-            priority = "Обычный";
-        }
-        else if (priority_class == HIGH_PRIORITY_CLASS) 
-        {
-            priority = "Высокий";
-        }
-        else if (priority_class == IDLE_PRIORITY_CLASS) 
-        {
-            priority = "Низкий";
-        }
-        else if (priority_class == REALTIME_PRIORITY_CLASS) 
-        {
-            priority = "Реального времени";
-        }
-        CloseHandle(h_proc);
+    case IDLE_PRIORITY_CLASS:
+        return ppIdle;
+    case BELOW_NORMAL_PRIORITY_CLASS:
+        return ppBelowNormal;
+    case NORMAL_PRIORITY_CLASS:
+        return ppNormal;
+    case ABOVE_NORMAL_PRIORITY_CLASS:
+        return ppAboveNormal;
+    case HIGH_PRIORITY_CLASS:
+        return ppHigh;
+    case REALTIME_PRIORITY_CLASS:
+        return ppRealtime;
+    default:
+        return ppUnknown;
     }
-    return priority;
 }
\ No newline at end of file
@@ -2,24 +2,49 @@
 
 #include "IProcessControl.h"
 #include <Windows.h>
+#include <QHash>
+#include <QMutex>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <memory>
 
 class WindowsProcessControl : public IProcessControl 
 {
 public:
+    WindowsProcessControl();
+    ~WindowsProcessControl() override;
+
     ProcessDetails getProcessDetails(quint32 pid, const QList<ProcessInfo> processes) override;
+    QList<ProcessDetails> getProcessDetails(const QList<quint32>& pids, const QList<ProcessInfo>& processes, quint32 fields) override;
     bool killProcess(quint32 pId) override;
     QIcon getProcessIcon(quint32 pId);
 
 private:
+    // Снимок Toolhelp живёт один такт сбора данных и общий для всех запросов за это время
+    static constexpr qint64 SNAPSHOT_MAX_AGE_MS = 1000;
+    // Пакеты меньше этого размера обрабатываются в вызывающем потоке
+    static constexpr int PARALLEL_BATCH_THRESHOLD = 32;
+    static constexpr int MAX_PARALLEL_WORKERS = 8;
+
+    struct ProcessSnapshot
+    {
+        QHash<quint32, quint32> parentPIDs;
+        // Потоки из того же снимка, сгруппированные по PID владельца
+        QHash<quint32, quint32> threadCounts;
+    };
+
+    std::shared_ptr<const ProcessSnapshot> processSnapshot();
+    static std::shared_ptr<const ProcessSnapshot> takeProcessSnapshot();
+    static void fillProcessDetails(ProcessDetails& details, quint32 fields);
+
     QString getProcessPath(quint32 pId);
-    quint32 getParentPID(quint32 pId);
     bool killProcessGracefully(quint32 pId);
-    quint32 getThreadCount(quint32 pid);
-    QDateTime getStartTime(quint32 pid);
-    quint32 getChildProcessCount(quint32 pid, const QList<ProcessInfo>& allProcesses);
-    quint32 getHandleCount(quint32 pid);
-    int getPriority(quint32 pid);
-    QString getProcessUserName(quint32 pid);
-    QString getProcessPriorityClass(quint32 pid);
-};
+    static QByteArray getProcessAccountId(HANDLE hProc);
+    static QString getProcessCommandLine(HANDLE hProc);
+    static ProcessPriority getProcessPriority(DWORD priorityClass);
 
+    QMutex _snapshotMutex;
+    std::shared_ptr<const ProcessSnapshot> _snapshot;
+    QElapsedTimer _snapshotAge;
+    QThreadPool _detailsPool;
+};
@@ -1,4 +1,5 @@
 #include "WindowsServiceControl.h"
+#include "WIndowsServiceMonitor.h"
 
 WindowsServiceControl::WindowsServiceControl()
 {
@@ -52,5 +53,34 @@ bool WindowsServiceControl::stopService(const QString& serviceName)
     CloseServiceHandle(hSvc);
     CloseServiceHandle(hSCM);
 
+    return success;
+}
+
+bool WindowsServiceControl::queryStatus(const QString& serviceName, ServiceStatus& status)
+{
+    SC_HANDLE hSCM = OpenSCManager(NULL, NULL, SC_MANAGER_CONNECT);
+    if (!hSCM)
+    {
+        return false;
+    }
+
+    SC_HANDLE hSvc = OpenServiceW(hSCM, reinterpret_cast<LPCWSTR>(serviceName.utf16()), SERVICE_QUERY_STATUS);
+    if (!hSvc)
+    {
+        CloseServiceHandle(hSCM);
+        return false;
+    }
+
+    SERVICE_STATUS_PROCESS serviceStatus;
+    DWORD bytesNeeded = 0;
+    bool success = QueryServiceStatusEx(hSvc, SC_STATUS_PROCESS_INFO, reinterpret_cast<LPBYTE>(&serviceStatus), sizeof(serviceStatus), &bytesNeeded);
+    if (success)
+    {
+        status = WindowsServiceMonitor::getStatusString(serviceStatus.dwCurrentState);
+    }
+
+    CloseServiceHandle(hSvc);
+    CloseServiceHandle(hSCM);
+
     return success;
 }
\ No newline at end of file
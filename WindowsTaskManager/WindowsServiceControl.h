@@ -10,4 +10,5 @@ public:
 	~WindowsServiceControl() override;
 	bool startService(const QString& serviceName);
 	bool stopService(const QString& serviceName);
+	bool queryStatus(const QString& serviceName, ServiceStatus& status) override;
 };
\ No newline at end of file
@@ -2,7 +2,7 @@
 #include <tlhelp32.h>
 #include <psapi.h>
 #include <QDebug>
-#include <QDateTime>
+#include "SpanTracer.h"
 
 WindowsSystemMonitor::WindowsSystemMonitor(IDiskMonitor* diskMonitor, INetworkMonitor* networkMonitor, IGPUMonitor* gpuMonitor)
 {
@@ -61,7 +61,7 @@ bool WindowsSystemMonitor::calculateCpuUsage(double& cpuUsage)
     return true;
 }
 
-bool WindowsSystemMonitor::calculateProcessCpuUsage(HANDLE hProc, ProcessTimeInfo& time_info, quint32 pid)
+bool WindowsSystemMonitor::calculateProcessCpuUsage(HANDLE hProc, quint32 pid, double& cpuUsage, QDateTime& startTime)
 {
     FILETIME creation_time, exit_time, kernel_time, user_time;
     if (!GetProcessTimes(hProc, &creation_time, &exit_time, &kernel_time, &user_time))
@@ -69,46 +69,49 @@ bool WindowsSystemMonitor::calculateProcessCpuUsage(HANDLE hProc, ProcessTimeInf
         return false;
     }
 
-    time_info.creation_time.LowPart = creation_time.dwLowDateTime;
-    time_info.creation_time.HighPart = creation_time.dwHighDateTime;
-    time_info.exit_time.LowPart = exit_time.dwLowDateTime;
-    time_info.exit_time.HighPart = exit_time.dwHighDateTime;
-    time_info.kernel_time.LowPart = kernel_time.dwLowDateTime;
-    time_info.kernel_time.HighPart = kernel_time.dwHighDateTime;
-    time_info.user_time.LowPart = user_time.dwLowDateTime;
-    time_info.user_time.HighPart = user_time.dwHighDateTime;
+    ULARGE_INTEGER creation, kernel, user;
+    creation.LowPart = creation_time.dwLowDateTime;
+    creation.HighPart = creation_time.dwHighDateTime;
+    kernel.LowPart = kernel_time.dwLowDateTime;
+    kernel.HighPart = kernel_time.dwHighDateTime;
+    user.LowPart = user_time.dwLowDateTime;
+    user.HighPart = user_time.dwHighDateTime;
 
-    // Общее время в 100-наносекундных интервалах
-    ULARGE_INTEGER total;
-    total.QuadPart = time_info.kernel_time.QuadPart + time_info.user_time.QuadPart;
+    // Общее время в 100-наносекундных интервалах, время создания отличает новый процесс с тем же PID
+    RateTracker<1>::Rates rates;
+    _processCpuRates.update(pid, creation.QuadPart, { kernel.QuadPart + user.QuadPart }, rates);
 
-    // Преобразуем в миллисекунды
-    time_info.last_total_time = total.QuadPart / 10000;
+    // 10^7 интервалов по 100нс в секунду = 100% одного ядра
+    cpuUsage = rates[0] / 100000.0;
 
+    // Отсчёт FILETIME идёт с 1601 года, между ним и 1970 - 11644473600 секунд
+    startTime = QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(creation.QuadPart / 10000) - 11644473600LL * 1000);
     return true;
 }
 
-double WindowsSystemMonitor::computeCpuPercentage(const ProcessTimeInfo& old, const ProcessTimeInfo& current, qint64 elapsed_ms) 
+SystemInfo WindowsSystemMonitor::getSystemLoad()
 {
-    if (elapsed_ms == 0) return 0.0;
+    SystemInfo info = {};
 
-    qint64 old_total = old.last_total_time;
-    qint64 new_total = current.last_total_time;
-    qint64 total_time_diff = new_total - old_total;
+    // CPU
+    calculateCpuUsage(info.cpuUsage);
 
-    if (total_time_diff <= 0) return 0.0;
+    // Memory
+    MEMORYSTATUSEX mem_status;
+    mem_status.dwLength = sizeof(mem_status);
+    if (GlobalMemoryStatusEx(&mem_status)) 
+    {
+        info.totalMemory = mem_status.ullTotalPhys;
+        info.availableMemory = mem_status.ullAvailPhys;
+        info.usedMemory = info.totalMemory - info.availableMemory;
+    }
 
-    // Процент от времени ЦП (elapsed_ms в миллисекундах, умножаем на 10 для перевода в 100ns)
-    double cpu_usage = (total_time_diff * 100.0) / (elapsed_ms * 10.0);
-    return cpu_usage;
+    return info;
 }
 
 SystemInfo WindowsSystemMonitor::getSystemInfo()
 {
-    SystemInfo info = {};
-
-    // CPU
-    calculateCpuUsage(info.cpuUsage);
+    SystemInfo info = getSystemLoad();
 
     info.baseSpeedGHz = getBaseCpuSpeedGHz();
     info.coreCount = getCoreCount();
@@ -118,32 +121,37 @@ SystemInfo WindowsSystemMonitor::getSystemInfo()
     info.cacheL3KB = getCacheSizeKB(3);
     info.processCount = getProcessCount();
     info.threadCount = getThreadCount();
-    info.cpuCoreUsage = getCpuCoreUsage();
-
-    // Memory
-    MEMORYSTATUSEX mem_status;
-    mem_status.dwLength = sizeof(mem_status);
-    if (GlobalMemoryStatusEx(&mem_status)) 
-    {
-        info.totalMemory = mem_status.ullTotalPhys;
-        info.availableMemory = mem_status.ullAvailPhys;
-        info.usedMemory = info.totalMemory - info.availableMemory;
-    }
 
     return info;
 }
 
-QList<ProcessInfo> WindowsSystemMonitor::getProcesses()
+QList<ProcessInfo> WindowsSystemMonitor::getProcesses(bool withDiskInfo, bool withGPUInfo, bool withNetworkInfo)
 {
     QList<ProcessInfo> processes;
 
-    qint64 current_time = QDateTime::currentMSecsSinceEpoch();
-
     // Получаем статистику диска
-    auto processDiskInfo = _diskMonitor->getProcessDiskInfo();
+    QMap<quint32, ProcessDiskInfo> processDiskInfo;
+    if (withDiskInfo)
+    {
+        TRACE_SCOPE("collect.processes.disk");
+        processDiskInfo = _diskMonitor->getProcessDiskInfo();
+    }
 
     // Получаем статистику GPU
-    auto processGPUInfo = _gpuMonitor->getProcessGPUInfo();
+    QMap<quint32, ProcessGPUInfo> processGPUInfo;
+    if (withGPUInfo)
+    {
+        TRACE_SCOPE("collect.processes.gpu");
+        processGPUInfo = _gpuMonitor->getProcessGPUInfo();
+    }
+
+    // Получаем сетевой трафик
+    QMap<quint32, ProcessNetworkInfo> processNetworkInfo;
+    if (withNetworkInfo)
+    {
+        TRACE_SCOPE("collect.processes.network");
+        processNetworkInfo = _networkMonitor->getProcessNetworkInfo();
+    }
 
     HANDLE h_snap = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
     if (h_snap == INVALID_HANDLE_VALUE) 
@@ -160,7 +168,7 @@ QList<ProcessInfo> WindowsSystemMonitor::getProcesses()
         return processes;
     }
 
-    std::map<quint32, ProcessTimeInfo> current_process_times;
+    _processCpuRates.beginSample();
 
     do {
         quint32 pid = entry.th32ProcessID;
@@ -181,19 +189,7 @@ QList<ProcessInfo> WindowsSystemMonitor::getProcesses()
             }
 
             // CPU Time
-            ProcessTimeInfo time_info = {};
-            if (calculateProcessCpuUsage(h_proc, time_info, pid)) 
-            {
-                current_process_times[pid] = time_info;
-
-                // Если есть предыдущие данные, вычисляем загрузку
-                auto it = _processTimes.find(pid);
-                if (it != _processTimes.end() && _lastUpdateTime != 0) 
-                {
-                    qint64 elapsed = current_time - _lastUpdateTime;
-                    info.cpuUsage = computeCpuPercentage(it->second, time_info, elapsed);
-                }
-            }
+            calculateProcessCpuUsage(h_proc, pid, info.cpuUsage, info.startTime);
 
             CloseHandle(h_proc);
         }
@@ -201,14 +197,23 @@ QList<ProcessInfo> WindowsSystemMonitor::getProcesses()
         if (processDiskInfo.contains(pid)) 
         {
             const auto& diskInfo = processDiskInfo[pid];
-            info.diskReadBytes = diskInfo.bytesRead;
-            info.diskWriteBytes = diskInfo.bytesWritten;
+            info.diskReadBytes = static_cast<quint64>(diskInfo.readBytesPerSec);
+            info.diskWriteBytes = static_cast<quint64>(diskInfo.writeBytesPerSec);
         }
 
         if (processGPUInfo.contains(pid))
         {
             const auto& gpuInfo = processGPUInfo[pid];
             info.gpuUsage = gpuInfo.gpuUtilization;
+            info.gpuMemoryBytes = gpuInfo.gpuMemoryBytes;
+            info.gpuDevices = gpuInfo.devices;
+        }
+
+        auto network = processNetworkInfo.constFind(pid);
+        if (network != processNetworkInfo.constEnd())
+        {
+            info.networkReceiveBytesPerSec = network->receiveBytesPerSec;
+            info.networkSendBytesPerSec = network->sendBytesPerSec;
         }
 
         processes.append(info);
@@ -216,9 +221,8 @@ QList<ProcessInfo> WindowsSystemMonitor::getProcesses()
 
     CloseHandle(h_snap);
 
-    // Обновляем время и сохраняем текущие значения
-    _lastUpdateTime = current_time;
-    _processTimes = std::move(current_process_times);
+    // Завершившиеся процессы удаляются из истории счётчиков
+    _processCpuRates.endSample();
 
     return processes;
 }
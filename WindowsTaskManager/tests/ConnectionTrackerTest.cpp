@@ -0,0 +1,129 @@
+﻿#include <QTest>
+
+#include "ConnectionTracker.h"
+
+// Такты задаются вручную: каждый тест перечисляет таблицы соединений подряд и проверяет разницу между ними
+class ConnectionTrackerTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static ConnectionInfo connection(ConnectionProtocol protocol, bool isIPv6, quint16 localPort, quint16 remotePort,
+        ConnectionState state, quint32 pid)
+    {
+        ConnectionInfo info;
+        info.protocol = protocol;
+        info.isIPv6 = isIPv6;
+        info.localAddress = { 127, 0, 0, 1 };
+        info.remoteAddress = { 10, 0, 0, 2 };
+        info.localPort = localPort;
+        info.remotePort = remotePort;
+        info.state = state;
+        info.pid = pid;
+        return info;
+    }
+
+    static ConnectionChanges sample(ConnectionTracker& tracker, QList<ConnectionInfo> connections)
+    {
+        tracker.beginSample();
+        for (auto& info : connections)
+        {
+            tracker.update(info);
+        }
+        return tracker.endSample();
+    }
+
+private slots:
+    void reportsOpened()
+    {
+        ConnectionTracker tracker;
+        ConnectionInfo web = connection(cpTcp, false, 50000, 443, csEstablished, 100);
+        ConnectionInfo dns = connection(cpUdp, false, 50001, 53, csNone, 200);
+
+        ConnectionChanges changes = sample(tracker, { web, dns });
+        QCOMPARE(changes.opened.size(), 2);
+        QVERIFY(changes.changed.isEmpty());
+        QVERIFY(changes.closed.isEmpty());
+        QCOMPARE(changes.opened[0].key, ConnectionTracker::connectionKey(web));
+        QCOMPARE(tracker.size(), 2);
+
+        // Без изменений следующий такт пуст
+        changes = sample(tracker, { web, dns });
+        QVERIFY(changes.opened.isEmpty());
+        QVERIFY(changes.changed.isEmpty());
+        QVERIFY(changes.closed.isEmpty());
+    }
+
+    void reportsStateAndOwnerChanges()
+    {
+        ConnectionTracker tracker;
+        ConnectionInfo web = connection(cpTcp, false, 50000, 443, csEstablished, 100);
+        sample(tracker, { web });
+
+        web.state = csCloseWait;
+        ConnectionChanges changes = sample(tracker, { web });
+        QCOMPARE(changes.changed.size(), 1);
+        QCOMPARE(changes.changed[0].state, csCloseWait);
+        QVERIFY(changes.opened.isEmpty());
+
+        // Сокет унаследовал другой процесс
+        web.pid = 101;
+        changes = sample(tracker, { web });
+        QCOMPARE(changes.changed.size(), 1);
+        QCOMPARE(changes.changed[0].pid, 101u);
+    }
+
+    void duplicateInSampleCountsOnce()
+    {
+        ConnectionTracker tracker;
+        ConnectionInfo web = connection(cpTcp, false, 50000, 443, csEstablished, 100);
+        sample(tracker, { web });
+
+        // Та же пара адресов дважды за такт: второе вхождение не считается сменой состояния
+        ConnectionInfo timeWait = web;
+        timeWait.state = csTimeWait;
+        ConnectionChanges changes = sample(tracker, { web, timeWait });
+        QVERIFY(changes.changed.isEmpty());
+        QCOMPARE(tracker.size(), 1);
+    }
+
+    void reportsClosed()
+    {
+        ConnectionTracker tracker;
+        ConnectionInfo web = connection(cpTcp, false, 50000, 443, csEstablished, 100);
+        ConnectionInfo dns = connection(cpUdp, false, 50001, 53, csNone, 200);
+        sample(tracker, { web, dns });
+
+        ConnectionChanges changes = sample(tracker, { dns });
+        QCOMPARE(changes.closed.size(), 1);
+        QCOMPARE(changes.closed[0], ConnectionTracker::connectionKey(web));
+        QCOMPARE(tracker.size(), 1);
+    }
+
+    void skippedFamilyKeepsRows()
+    {
+        ConnectionTracker tracker;
+        ConnectionInfo tcp4 = connection(cpTcp, false, 50000, 443, csEstablished, 100);
+        ConnectionInfo tcp6 = connection(cpTcp, true, 50000, 443, csEstablished, 100);
+        ConnectionInfo udp4 = connection(cpUdp, false, 50001, 53, csNone, 200);
+        sample(tracker, { tcp4, tcp6, udp4 });
+
+        // Таблица TCP/IPv4 не прочиталась: её соединения остаются, а пропавшие из прочитанных таблиц закрываются
+        tracker.beginSample();
+        tracker.skipFamily(cpTcp, false);
+        tracker.update(tcp6);
+        ConnectionChanges changes = tracker.endSample();
+        QCOMPARE(changes.closed.size(), 1);
+        QCOMPARE(changes.closed[0], ConnectionTracker::connectionKey(udp4));
+        QCOMPARE(tracker.size(), 2);
+
+        // В следующем такте таблица прочиталась, и соединение не считается новым
+        changes = sample(tracker, { tcp4, tcp6 });
+        QVERIFY(changes.opened.isEmpty());
+        QVERIFY(changes.closed.isEmpty());
+        QCOMPARE(tracker.size(), 2);
+    }
+};
+
+QTEST_APPLESS_MAIN(ConnectionTrackerTest)
+#include "ConnectionTrackerTest.moc"
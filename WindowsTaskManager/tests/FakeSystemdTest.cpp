@@ -0,0 +1,99 @@
+﻿#include <QTest>
+#include <QStandardPaths>
+
+#include "LinuxServiceMonitor.h"
+#include "LinuxServiceControl.h"
+
+// Монитор и управление службами против подставного systemd (WINTOP_FAKE_SYSTEMD) на своём dbus-daemon.
+// Из 12 служб dbus.service и nginx.service работают, ssh.service остановлена, fake-10.service замаскирована.
+// Синхронные вызовы идут из потока теста, а подставная служба отвечает и меняет состояния в своём потоке
+class FakeSystemdTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static constexpr int UNIT_COUNT = 12;
+
+    LinuxServiceMonitor* _monitor = nullptr;
+    LinuxServiceControl _control;
+
+    ServiceInfo service(const QString& name)
+    {
+        const QList<ServiceInfo> services = _monitor->getServices();
+        for (const auto& info : services)
+        {
+            if (info.name == name)
+            {
+                return info;
+            }
+        }
+        return ServiceInfo();
+    }
+
+    ServiceStatus queriedStatus(const QString& name)
+    {
+        ServiceStatus status = ssUnknown;
+        return _control.queryStatus(name, status) ? status : ssUnknown;
+    }
+
+private slots:
+    void initTestCase()
+    {
+        if (QStandardPaths::findExecutable("dbus-daemon").isEmpty())
+        {
+            QSKIP("dbus-daemon is not installed");
+        }
+        // Подключение к шине создаётся один раз при первом обращении, поэтому переменные задаются до него
+        qunsetenv("WINTOP_SYSTEMD_BUS");
+        qputenv("WINTOP_FAKE_SYSTEMD", QByteArray::number(UNIT_COUNT));
+        _monitor = new LinuxServiceMonitor(this);
+    }
+
+    void listsUnits()
+    {
+        QCOMPARE(_monitor->getServices().size(), UNIT_COUNT);
+        QCOMPARE(service("dbus.service").status, ssRunning);
+        QCOMPARE(service("ssh.service").status, ssStopped);
+
+        // PID, тип запуска и зависимости дочитываются асинхронно после ListUnits
+        QTRY_VERIFY(service("dbus.service").processId != 0);
+        QTRY_COMPARE(service("ssh.service").startType, systemdStartType("static"));
+        QTRY_COMPARE(service("nginx.service").dependencies, QStringList{ "dbus.service" });
+        QCOMPARE(service("dbus.service").binaryPath, QString("/usr/sbin/dbus"));
+    }
+
+    void startsService()
+    {
+        QCOMPARE(queriedStatus("ssh.service"), ssStopped);
+        QVERIFY(_control.startService("ssh.service"));
+
+        // Ответ приходит сразу, служба проходит через запуск и переходит в работу по таймеру подставного systemd
+        QTRY_COMPARE(queriedStatus("ssh.service"), ssRunning);
+        QTRY_COMPARE(service("ssh.service").status, ssRunning);
+        QTRY_VERIFY(service("ssh.service").processId != 0);
+    }
+
+    void stopsService()
+    {
+        QVERIFY(_control.stopService("nginx.service"));
+        QTRY_COMPARE(queriedStatus("nginx.service"), ssStopped);
+        QTRY_COMPARE(service("nginx.service").status, ssStopped);
+        QTRY_COMPARE(service("nginx.service").processId, 0u);
+    }
+
+    void maskedServiceDoesNotStart()
+    {
+        QVERIFY(!_control.startService("fake-10.service"));
+        QCOMPARE(queriedStatus("fake-10.service"), ssStopped);
+    }
+
+    void unknownServiceFails()
+    {
+        QVERIFY(!_control.startService("missing.service"));
+        ServiceStatus status = ssUnknown;
+        QVERIFY(!_control.queryStatus("missing.service", status));
+    }
+};
+
+QTEST_GUILESS_MAIN(FakeSystemdTest)
+#include "FakeSystemdTest.moc"
@@ -0,0 +1,142 @@
+﻿#include <QTest>
+
+#include "LinuxDrmGPUBackend.h"
+
+// Разбор снятой копии /proc и /sys из fixtures/drm (то же, что WINTOP_GPU_FIXTURE_ROOT при запуске программы):
+// card0 - amdgpu с gpu_busy_percent и hwmon, card1 - i915 без них, card0-DP-1 - разъём, а не карта.
+// Клиенты DRM: 1234 - старый формат amdgpu (drm-memory-*) через два дескриптора одного клиента,
+// 2345 - amdgpu с drm-memory-* и drm-total-*, 5678 - i915 только с системной памятью
+class LinuxDrmGPUBackendTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static constexpr quint64 MIB = 1024 * 1024;
+
+    QString _root;
+
+    static const ProcessGPUDeviceUsage* deviceUsage(const QMap<quint32, ProcessGPUInfo>& processes, quint32 pid, int device)
+    {
+        auto it = processes.constFind(pid);
+        if (it == processes.constEnd())
+        {
+            return nullptr;
+        }
+        for (const auto& usage : it->devices)
+        {
+            if (usage.device == device)
+            {
+                return &usage;
+            }
+        }
+        return nullptr;
+    }
+
+private slots:
+    void initTestCase()
+    {
+        // ctest передаёт корень копии так же, как его получает программа; без переменной копия ищется рядом с тестом
+        _root = qEnvironmentVariable("WINTOP_GPU_FIXTURE_ROOT");
+        if (_root.isEmpty())
+        {
+            _root = QFINDTESTDATA("fixtures/drm");
+        }
+        QVERIFY(!_root.isEmpty());
+    }
+
+    void enumeratesCardsOnly()
+    {
+        LinuxDrmGPUBackend backend(_root);
+        QList<GPUInfo> devices = backend.enumerateDevices();
+        QCOMPARE(devices.size(), 2);
+
+        QCOMPARE(devices[0].vendor, QString("AMD"));
+        QCOMPARE(devices[0].name, QString("AMD Radeon RX 6800 XT"));
+        QCOMPARE(devices[0].driverVersion, QString("amdgpu 6.8.0-fixture"));
+        QCOMPARE(devices[0].totalMemoryBytes, 17163091968ULL);
+
+        // У i915 нет product_name: имя собирается из производителя, PCI_ID и карты
+        QCOMPARE(devices[1].vendor, QString("Intel"));
+        QCOMPARE(devices[1].name, QString("Intel 8086:A780 (card1)"));
+        QCOMPARE(devices[1].driverVersion, QString("i915 6.8.0-fixture"));
+        QCOMPARE(devices[1].totalMemoryBytes, 0ULL);
+    }
+
+    void samplesAmdgpuFromSysfs()
+    {
+        LinuxDrmGPUBackend backend(_root);
+        backend.enumerateDevices();
+
+        GPUInfo info;
+        QVERIFY(backend.sampleDevice(0, info));
+        QCOMPARE(info.usage, 37u);
+        QCOMPARE(info.usedMemoryBytes, 2048 * MIB);
+        QCOMPARE(info.temperatureCelsius, 54.0);
+        QCOMPARE(info.powerUsage, 45u);
+        QCOMPARE(info.fanSpeed, 20u);
+
+        QVERIFY(!backend.sampleDevice(2, info));
+    }
+
+    void samplesI915FromClients()
+    {
+        LinuxDrmGPUBackend backend(_root);
+        backend.enumerateDevices();
+
+        // Без gpu_busy_percent загрузка берётся из fdinfo клиентов; в первом такте скоростей ещё нет
+        GPUInfo info;
+        info.usage = 100;
+        QVERIFY(backend.sampleDevice(1, info));
+        QCOMPARE(info.usage, 0u);
+        QCOMPARE(info.usedMemoryBytes, 0ULL);
+        QCOMPARE(info.fanSpeed, 0u);
+    }
+
+    void parsesClientMemory()
+    {
+        LinuxDrmGPUBackend backend(_root);
+        backend.enumerateDevices();
+
+        const int firstDevice = 3;
+        QMap<quint32, ProcessGPUInfo> processes;
+        backend.sampleProcesses(firstDevice, processes);
+        QCOMPARE(processes.size(), 3);
+
+        // drm-memory-vram, клиент 7 открыт через fd 5 и 6 и учитывается один раз
+        const ProcessGPUDeviceUsage* usage = deviceUsage(processes, 1234, firstDevice);
+        QVERIFY(usage);
+        QCOMPARE(usage->memoryBytes, 512 * MIB);
+        QCOMPARE(processes[1234].devices.size(), 1);
+
+        // При наличии обоих форматов берётся drm-total-vram, gtt не считается видеопамятью
+        usage = deviceUsage(processes, 2345, firstDevice);
+        QVERIFY(usage);
+        QCOMPARE(usage->memoryBytes, 200 * MIB);
+
+        // Интегрированная карта: system0 и stolen-system0 не видеопамять
+        usage = deviceUsage(processes, 5678, firstDevice + 1);
+        QVERIFY(usage);
+        QCOMPARE(usage->memoryBytes, 0ULL);
+    }
+
+    void secondSampleKeepsClients()
+    {
+        LinuxDrmGPUBackend backend(_root);
+        backend.enumerateDevices();
+
+        QMap<quint32, ProcessGPUInfo> first, second;
+        backend.sampleProcesses(0, first);
+        backend.sampleProcesses(0, second);
+
+        // Счётчики копии не меняются, поэтому загрузка нулевая, а память та же
+        QCOMPARE(second.size(), first.size());
+        const ProcessGPUDeviceUsage* usage = deviceUsage(second, 1234, 0);
+        QVERIFY(usage);
+        QCOMPARE(usage->memoryBytes, 512 * MIB);
+        QCOMPARE(usage->smUtilization, 0.0);
+    }
+};
+
+QTEST_GUILESS_MAIN(LinuxDrmGPUBackendTest)
+
+#include "LinuxDrmGPUBackendTest.moc"
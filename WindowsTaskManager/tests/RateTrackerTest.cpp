@@ -0,0 +1,128 @@
+﻿#include <QTest>
+
+#include "RateTracker.h"
+
+// Такты задаются явными метками времени, поэтому скорости считаются точно и не зависят от машины
+class RateTrackerTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static constexpr qint64 SECOND_NS = 1000000000;
+
+private slots:
+    void firstSampleHasNoRate()
+    {
+        RateTracker<2> tracker;
+        RateTracker<2>::Rates rates;
+
+        tracker.beginSample(0);
+        QVERIFY(!tracker.update(1, 100, { 5000, 700 }, rates));
+        QCOMPARE(rates[0], 0.0);
+        QCOMPARE(rates[1], 0.0);
+        tracker.endSample();
+
+        tracker.beginSample(2 * SECOND_NS);
+        QVERIFY(tracker.update(1, 100, { 7000, 1100 }, rates));
+        QCOMPARE(rates[0], 1000.0);
+        QCOMPARE(rates[1], 200.0);
+    }
+
+    void repeatedUpdateInSameSampleHasNoRate()
+    {
+        RateTracker<1> tracker;
+        RateTracker<1>::Rates rates;
+
+        tracker.beginSample(0);
+        tracker.update(1, 100, { 10 }, rates);
+        tracker.beginSample(SECOND_NS);
+        QVERIFY(tracker.update(1, 100, { 20 }, rates));
+        QVERIFY(!tracker.update(1, 100, { 30 }, rates));
+        QCOMPARE(rates[0], 0.0);
+    }
+
+    void reusedIdStartsOver()
+    {
+        RateTracker<1> tracker;
+        RateTracker<1>::Rates rates;
+
+        tracker.beginSample(0);
+        tracker.update(42, 100, { 1000000 }, rates);
+        tracker.endSample();
+
+        // Тот же PID, но другое время запуска: прошлый счётчик к новому процессу не относится
+        tracker.beginSample(SECOND_NS);
+        QVERIFY(!tracker.update(42, 200, { 50 }, rates));
+        QCOMPARE(rates[0], 0.0);
+        tracker.endSample();
+
+        tracker.beginSample(2 * SECOND_NS);
+        QVERIFY(tracker.update(42, 200, { 150 }, rates));
+        QCOMPARE(rates[0], 100.0);
+    }
+
+    void endSampleRemovesStaleEntries()
+    {
+        RateTracker<1> tracker;
+        RateTracker<1>::Rates rates;
+
+        tracker.beginSample(0);
+        tracker.update(1, 1, { 10 }, rates);
+        tracker.update(2, 2, { 20 }, rates);
+        tracker.endSample();
+        QCOMPARE(tracker.size(), 2);
+
+        tracker.beginSample(SECOND_NS);
+        tracker.update(1, 1, { 20 }, rates);
+        tracker.endSample();
+        QCOMPARE(tracker.size(), 1);
+
+        // Пропавший на такт объект снова считается новым
+        tracker.beginSample(2 * SECOND_NS);
+        QVERIFY(!tracker.update(2, 2, { 40 }, rates));
+        QVERIFY(tracker.update(1, 1, { 30 }, rates));
+        QCOMPARE(rates[0], 10.0);
+    }
+
+    void counterResetGivesZero()
+    {
+        RateTracker<1> tracker;
+        RateTracker<1>::Rates rates;
+
+        tracker.beginSample(0);
+        tracker.update(1, 1, { 1000 }, rates);
+        tracker.beginSample(SECOND_NS);
+        QVERIFY(tracker.update(1, 1, { 400 }, rates));
+        QCOMPARE(rates[0], 0.0);
+
+        // После сброса скорость считается от нового значения
+        tracker.beginSample(2 * SECOND_NS);
+        QVERIFY(tracker.update(1, 1, { 500 }, rates));
+        QCOMPARE(rates[0], 100.0);
+    }
+
+    void counter32BitWraps()
+    {
+        RateTracker<1> tracker;
+        RateTracker<1>::Rates rates;
+
+        tracker.beginSample(0);
+        tracker.update(1, 1, { 0xFFFFFF00ULL }, rates, 32);
+        tracker.beginSample(SECOND_NS);
+        QVERIFY(tracker.update(1, 1, { 0x100ULL }, rates, 32));
+        QCOMPARE(rates[0], 512.0);
+    }
+
+    void counterDelta()
+    {
+        QCOMPARE(RateTracker<1>::counterDelta(150, 100, 64), 50ULL);
+        QCOMPARE(RateTracker<1>::counterDelta(100, 150, 64), 0ULL);
+        QCOMPARE(RateTracker<1>::counterDelta(5, 0xFFFFFFFBULL, 32), 10ULL);
+        // Прошлое значение не помещается в 32 бита - это не переполнение, а сброс
+        QCOMPARE(RateTracker<1>::counterDelta(5, 0x100000000ULL, 32), 0ULL);
+    }
+};
+
+QTEST_APPLESS_MAIN(RateTrackerTest)
+
+#include "RateTrackerTest.moc"
@@ -0,0 +1,141 @@
+﻿#include <QTest>
+#include <QTemporaryDir>
+#include <QDir>
+#include <QFile>
+#include <unistd.h>
+
+#include "LinuxSocketOwners.h"
+#include "LinuxProcFs.h"
+
+// Разбор ссылок /proc/[pid]/fd из fixtures/sockets: у 100 сокеты 5001 и 5002, /dev/null и канал 7000,
+// у 200 (имя с пробелом) сокет 6001; каталог sys - не процесс.
+// Переиспользование PID, завершение процессов и ограничение полного обхода проверяются на копии /proc
+// во временном каталоге, которая меняется между вызовами update()
+class SocketOwnerIndexTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    QString _root;
+
+    // Процесс во временной копии /proc: stat со временем запуска и ссылки fd на сокеты
+    static bool writeProcess(const QString& root, quint32 pid, quint64 startTime, const QList<quint64>& socketInodes)
+    {
+        QString processDir = QString("%1/proc/%2").arg(root).arg(pid);
+        QDir(processDir).removeRecursively();
+        if (!QDir().mkpath(processDir + "/fd"))
+        {
+            return false;
+        }
+
+        QFile stat(processDir + "/stat");
+        if (!stat.open(QIODevice::WriteOnly))
+        {
+            return false;
+        }
+        stat.write(QString("%1 (proc%1) S 1 %1 %1 0 -1 4194560 100 0 0 0 10 5 0 0 20 0 1 0 %2 1000000 100\n")
+            .arg(pid).arg(startTime).toLatin1());
+        stat.close();
+
+        for (qsizetype fd = 0; fd < socketInodes.size(); fd++)
+        {
+            QByteArray target = "socket:[" + QByteArray::number(socketInodes[fd]) + "]";
+            QByteArray link = QFile::encodeName(processDir + "/fd/" + QString::number(fd + 3));
+            if (symlink(target.constData(), link.constData()) != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private slots:
+    void initTestCase()
+    {
+        _root = QFINDTESTDATA("fixtures/sockets");
+        QVERIFY(!_root.isEmpty());
+    }
+
+    void parsesProcessStat()
+    {
+        ProcessStat stat;
+        QVERIFY(readProcessStat(200, stat, _root + "/proc"));
+        QCOMPARE(stat.name, QString("my server"));
+        QCOMPARE(stat.parentPID, 1u);
+        QCOMPARE(stat.threadCount, 2u);
+        QCOMPARE(stat.startTime, 6000ULL);
+        QCOMPARE(readProcessStartTime(100, _root + "/proc"), 5000ULL);
+        QCOMPARE(readProcessStartTime(300, _root + "/proc"), 0ULL);
+    }
+
+    void resolvesSocketOwners()
+    {
+        SocketOwnerIndex index(_root);
+        index.update({ 5001, 5002, 6001 });
+
+        QCOMPARE(index.owner(5001), 100u);
+        QCOMPARE(index.owner(5002), 100u);
+        QCOMPARE(index.owner(6001), 200u);
+        // Канал и /dev/null - не сокеты
+        QCOMPARE(index.owner(7000), 0u);
+    }
+
+    void unknownSocketHasNoOwner()
+    {
+        SocketOwnerIndex index(_root);
+        index.update({ 5001, 9999 });
+
+        QCOMPARE(index.owner(5001), 100u);
+        QCOMPARE(index.owner(9999), 0u);
+    }
+
+    void followsProcessChanges()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        QString root = dir.path();
+
+        QVERIFY(writeProcess(root, 300, 1000, { 8001 }));
+        SocketOwnerIndex index(root);
+        index.update({ 8001 });
+        QCOMPARE(index.owner(8001), 300u);
+
+        // Тот же PID с другим временем запуска - новый процесс, его дескрипторы читаются заново
+        QVERIFY(writeProcess(root, 300, 2000, { 8002 }));
+        index.update({ 8002 });
+        QCOMPARE(index.owner(8002), 300u);
+        QCOMPARE(index.owner(8001), 0u);
+
+        // Завершившийся процесс забывается вместе с его сокетами
+        QVERIFY(QDir(root + "/proc/300").removeRecursively());
+        QVERIFY(writeProcess(root, 400, 3000, { 8003 }));
+        index.update({ 8003 });
+        QCOMPARE(index.owner(8003), 400u);
+        QCOMPARE(index.owner(8002), 0u);
+    }
+
+    void limitsFullRescans()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        QString root = dir.path();
+
+        QVERIFY(writeProcess(root, 500, 1000, { 9001 }));
+        SocketOwnerIndex index(root);
+        index.update({ 9001 });
+
+        // Новый сокет уже известного процесса находится полным обходом
+        QVERIFY(writeProcess(root, 500, 1000, { 9001, 9002 }));
+        index.update({ 9001, 9002 });
+        QCOMPARE(index.owner(9002), 500u);
+
+        // Следующий полный обход - не раньше чем через FULL_RESCAN_INTERVAL_MS, сокет пока без владельца
+        QVERIFY(writeProcess(root, 500, 1000, { 9001, 9002, 9003 }));
+        index.update({ 9001, 9002, 9003 });
+        QCOMPARE(index.owner(9003), 0u);
+        QCOMPARE(index.owner(9001), 500u);
+    }
+};
+
+QTEST_GUILESS_MAIN(SocketOwnerIndexTest)
+#include "SocketOwnerIndexTest.moc"